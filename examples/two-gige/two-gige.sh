@@ -7,6 +7,11 @@
 oat frameserve gige raw0 -i 0 -c config.toml cam0 &
 oat frameserve gige raw1 -i 1 -c config.toml cam1 &
 
+# Alternatively, serve both cameras from one process so that their sample
+# numbers and timestamps stay aligned, using a [multi] table with a
+# [[multi.camera]] table for each camera:
+# oat frameserve multi raw -c config.toml multi &
+
 # Look at both
 oat view raw0 &
 oat view raw1
@@ -24,12 +24,14 @@
 
 #include <opencv2/core/mat.hpp>
 
+#include "PixelFormat.h"
 #include "Sample.h"
 
 namespace oat {
 
 /**
- * Wrapper class for cv::Mat that contains sample number information.
+ * Wrapper class for cv::Mat that contains sample number and pixel format
+ * information.
  *
  * NOTE 1: cv::Mat does not declare a virtual destructor, so you must not
  * delete oat::Frames through a pointer to cv::Mat.
@@ -87,9 +89,12 @@ public:
         // Nothing
     }
 
-    Frame(int r, int c, int t, void * data, void * samp_ptr) :
-      cv::Mat(r, c, t, data)
+    Frame(int r, int c, int t, void * data, void * samp_ptr,
+          PixelFormat format = PixelFormat::BGR,
+          size_t step = cv::Mat::AUTO_STEP) :
+      cv::Mat(r, c, t, data, step)
     , sample_ptr_(static_cast<Sample *>(samp_ptr))
+    , format_(format)
     {
         // Nothing
     }
@@ -97,18 +102,35 @@ public:
     Frame clone() const {
         Frame f(cv::Mat::clone());
         *(f.sample_ptr_) = *sample_ptr_;
+        f.format_ = format_;
         return f;
     }
 
     void copyTo(Frame &f) const {
         cv::Mat::copyTo(f);
         *(f.sample_ptr_) = *sample_ptr_;
+        f.format_ = format_;
     }
 
     Frame operator()( const cv::Rect &roi ) const {
-        return Frame(*this, roi);
+        Frame f(*this, roi);
+        f.format_ = format_;
+        return f;
+    }
+
+    /**
+     * Pixel format. Bayer mosaics must be marked with set_format(). Other
+     * frames are BGR or GREY according to their number of channels, so that
+     * a frame converted in place by OpenCV keeps a valid format.
+     */
+    PixelFormat format() const {
+        if (channels() == 1)
+            return isBayer(format_) ? format_ : PixelFormat::GREY;
+        return PixelFormat::BGR;
     }
 
+    void set_format(const PixelFormat format) { format_ = format; }
+
 
     // Expose sample information
     oat::Sample & sample() const { return *sample_ptr_; };
@@ -123,6 +145,9 @@ private:
 
     // sample_ptr_ can point to either outside data (shmem) or sample_
     oat::Sample * sample_ptr_;
+
+    // Pixel format. See format().
+    PixelFormat format_ {PixelFormat::BGR};
 };
 
 }      /* namespace oat */
@@ -0,0 +1,101 @@
+//******************************************************************************
+//* File:   PixelFormat.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_PIXELFORMAT_H
+#define	OAT_PIXELFORMAT_H
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+namespace oat {
+
+/**
+ * Layout of the pixels in a frame. The bit depth (8 or 16 bit) is given by
+ * the frame's cv::Mat type.
+ *
+ * Bayer formats are named after the colors of the top-left 2x2 block of the
+ * sensor, which is the convention of camera vendors. OpenCV names its
+ * demosaicing codes after the second and third pixels of the second row, so
+ * e.g. BAYER_RGGB is demosaiced with cv::COLOR_BayerBG2BGR.
+ */
+enum class PixelFormat : int16_t
+{
+    BGR         = 0,    //!< Interleaved blue, green and red
+    GREY        = 1,    //!< Single channel intensity
+    BAYER_RGGB  = 2,    //!< Raw sensor mosaic, single channel
+    BAYER_GRBG  = 3,
+    BAYER_GBRG  = 4,
+    BAYER_BGGR  = 5,
+};
+
+inline bool isBayer(const PixelFormat format) {
+    return format >= PixelFormat::BAYER_RGGB;
+}
+
+/**
+ * @return The format a frame has once it is demosaiced: BGR for Bayer
+ * frames, otherwise the frame's own format.
+ */
+inline PixelFormat demosaiced(const PixelFormat format) {
+    return isBayer(format) ? PixelFormat::BGR : format;
+}
+
+inline std::string pixelFormatName(const PixelFormat format) {
+
+    switch (format) {
+        case PixelFormat::BGR: return "bgr";
+        case PixelFormat::GREY: return "grey";
+        case PixelFormat::BAYER_RGGB: return "bayer_rggb";
+        case PixelFormat::BAYER_GRBG: return "bayer_grbg";
+        case PixelFormat::BAYER_GBRG: return "bayer_gbrg";
+        case PixelFormat::BAYER_BGGR: return "bayer_bggr";
+    }
+
+    return "unknown";
+}
+
+/**
+ * Parse a pixel format name as used in configuration files.
+ * @param name One of bgr, grey (or gray), bayer_rggb, bayer_grbg,
+ * bayer_gbrg or bayer_bggr.
+ * @return Pixel format.
+ */
+inline PixelFormat pixelFormatFromName(const std::string &name) {
+
+    if (name == "bgr")
+        return PixelFormat::BGR;
+    if (name == "grey" || name == "gray")
+        return PixelFormat::GREY;
+    if (name == "bayer_rggb")
+        return PixelFormat::BAYER_RGGB;
+    if (name == "bayer_grbg")
+        return PixelFormat::BAYER_GRBG;
+    if (name == "bayer_gbrg")
+        return PixelFormat::BAYER_GBRG;
+    if (name == "bayer_bggr")
+        return PixelFormat::BAYER_BGGR;
+
+    throw (std::runtime_error("Unknown pixel format '" + name + "'. Use bgr, "
+                              "grey, bayer_rggb, bayer_grbg, bayer_gbrg or "
+                              "bayer_bggr."));
+}
+
+}      /* namespace oat */
+#endif /* OAT_PIXELFORMAT_H */
@@ -20,16 +20,19 @@
 #ifndef OAT_FORWARDSDECL_H
 #define	OAT_FORWARDSDECL_H
 
+#include <chrono>
 #include <boost/interprocess/interprocess_fwd.hpp>
 #include <boost/interprocess/managed_shared_memory.hpp>
 
+#include "Segment.h"
+
 namespace oat {
 
 namespace bip = boost::interprocess;
 
-using shmem_t = bip::managed_shared_memory;
-using handle_t = bip::managed_shared_memory::handle_t;
-using msec_t = boost::posix_time::milliseconds;
+using shmem_t = Segment;
+using handle_t = Segment::handle_t;
+using msec_t = std::chrono::milliseconds;
 
 } // namespace oat
 
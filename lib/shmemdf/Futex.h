@@ -0,0 +1,81 @@
+//******************************************************************************
+//* File:   Futex.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_FUTEX_H
+#define	OAT_FUTEX_H
+
+#ifndef __linux__
+#error "oat shared memory synchronization requires Linux futexes."
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace oat {
+namespace futex {
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+              "std::atomic<uint32_t> cannot be used as a futex word.");
+
+// Futexes are used without FUTEX_PRIVATE_FLAG so that they are keyed by the
+// physical page. Waiters and wakers may then live in different processes
+// that map the same segment at different addresses.
+
+/**
+ * Sleep while *word == expected.
+ * @param timeout Relative timeout, or nullptr to wait indefinitely.
+ */
+inline void wait(std::atomic<uint32_t> &word,
+                 const uint32_t expected,
+                 const struct timespec *timeout) {
+
+    // Returns on wake, timeout, signal, spurious wakeup, or immediately if
+    // the word has already changed; callers always re-check their condition
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word),
+            FUTEX_WAIT, expected, timeout, nullptr, 0);
+}
+
+/**
+ * Wake up to count threads sleeping on word.
+ */
+inline void wake(std::atomic<uint32_t> &word, const int count) {
+
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word),
+            FUTEX_WAKE, count, nullptr, nullptr, 0);
+}
+
+template <typename Rep, typename Period>
+inline struct timespec toTimespec(const std::chrono::duration<Rep, Period> d) {
+
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+
+    struct timespec ts;
+    ts.tv_sec = ns / 1000000000;
+    ts.tv_nsec = ns % 1000000000;
+    return ts;
+}
+
+}       /* namespace futex */
+}       /* namespace oat */
+#endif	/* OAT_FUTEX_H */
@@ -21,13 +21,22 @@
 #define	OAT_NODE_H
 
 #include <iostream>
+#include <stdexcept>
 #include <array>
 #include <atomic>
-#include <bitset>
+#include <cerrno>
+#include <limits>
 #include <string>
-#include <boost/interprocess/sync/interprocess_semaphore.hpp>
+#include <thread>
+#include <signal.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <boost/interprocess/offset_ptr.hpp>
 
 #include "ForwardsDecl.h"
+#include "NodeStats.h"
+#include "Semaphore.h"
+#include "SeqLock.h"
 
 namespace oat {
 
@@ -38,15 +47,56 @@ enum class NodeState {
     ERROR = 2
 };
 
+// Blocked SINKs and SOURCEs are woken directly by posts to the node's
+// semaphores. They wake on this period only to check that their peers are
+// still alive.
+constexpr msec_t LIVENESS_PERIOD {250};
+
+inline bool isProcessAlive(const pid_t pid) {
+    return pid > 0 && (::kill(pid, 0) == 0 || errno == EPERM);
+}
+
+/**
+ * Per-SOURCE synchronization state. An array of these is allocated in the
+ * node segment next to the Node.
+ */
+struct SourceSlot {
+
+    enum State : uint32_t {
+        FREE = 0,   //!< Available to a SOURCE
+        CLAIMED,    //!< Being initialized by the SOURCE acquiring it
+        ACTIVE,     //!< Owned by a SOURCE
+        POSTING,    //!< Owned by a SOURCE and being posted by the SINK
+        LEAVING     //!< Being released by its SOURCE
+    };
+
+    // Read cursor of a SOURCE that has not yet been posted by the SINK
+    static constexpr uint64_t NOT_STARTED {std::numeric_limits<uint64_t>::max()};
+
+    std::atomic<uint32_t> state {FREE};
+    std::atomic<pid_t> pid {0}; //!< Process hosting the SOURCE
+    std::atomic<uint64_t> read_cursor {NOT_STARTED}; //!< Next write to be read
+    std::atomic<uint64_t> posted_through {0}; //!< Writes before this one were posted
+    Semaphore read_barrier {0};
+
+    // Statistics. Read latency is the time from the SINK's post() of a
+    // sample to the SOURCE's post() after reading it.
+    LatencyHistogram read_latency;
+    std::atomic<int64_t> wait_ns {0}; //!< Total time blocked in wait()
+};
+
 class Node {
+
+    friend Node * openNode(shmem_t &, const std::string &, size_t);
+
 public:
 
-    using semaphore = bip::interprocess_semaphore;
+    using semaphore = oat::Semaphore;
 
     Node()
     {
-        source_slots_.reset();
-        source_read_required_.reset();
+        for (auto &p : pending_reads_)
+            p = 0;
     }
 
     // Nodes are not copyable
@@ -54,152 +104,335 @@ public:
     Node & operator=(const Node &) = delete;
 
     // SINK state
-    void set_sink_state(NodeState value) { sink_state_ = value; }
+    void set_sink_state(NodeState value) {
+        if (value == NodeState::SINK_BOUND)
+            sink_pid_ = ::getpid();
+        sink_state_ = value;
+
+        // SOURCEs in SourceMode::LATEST sleep on the write sequence
+        write_sequence.wake();
+    }
     NodeState sink_state(void) const { return sink_state_; }
 
+    /**
+     * Check that the process hosting the bound SINK still exists.
+     * @return False only if a SINK was bound and its process has died.
+     */
+    bool sinkAlive(void) const {
+        return sink_state_ != NodeState::SINK_BOUND || isProcessAlive(sink_pid_);
+    }
+
     // SINK writes (~sample number)
-    // TODO: write_number_ being atomic is redundant because only one sink can
-    //       be bound to a node, right?
     uint64_t write_number() const { return write_number_; }
 
+    void notifySinkWriteStart() { write_sequence.beginWrite(); }
+
+    // Give back the ring slot of a write that was started but not made
+    void notifySinkWriteCancelled() {
+        write_sequence.abortWrite();
+        write_barrier.post();
+    }
+
     void notifySinkWriteComplete() {
 
-        mutex_.wait();
+        const uint64_t w = write_number_;
+
+        // Readers may finish before all of them have been posted, so hold
+        // the ring slot's pending read count above zero until every SOURCE
+        // has been counted
+        auto &pending = pending_reads_[w % ring_size_];
+        pending.store(PENDING_BIAS, std::memory_order_relaxed);
 
-        // Require one read from all connected sources
-        source_read_required_ = source_slots_;
+        stats.recordWrite(w % ring_size_);
 
-        // Tell each source connected to the node that it may read
-        for (size_t i = 0; i < source_slots_.size(); i++)
-            if (source_slots_[i])
-                read_barrier(i).post();
+        // Require one read of this ring slot from each active SOURCE, and
+        // tell each that it may read
+        uint32_t readers = 0;
+        const size_t n = high_water_.load(std::memory_order_acquire);
+        for (size_t i = 0; i < n; i++) {
 
-        mutex_.post();
+            SourceSlot &s = slots_[i];
+            uint32_t expected = SourceSlot::ACTIVE;
+            if (!s.state.compare_exchange_strong(expected, SourceSlot::POSTING,
+                                                 std::memory_order_acquire))
+                continue;
+
+            // New sources start reading at the first write they are posted
+            if (s.read_cursor.load(std::memory_order_relaxed) == SourceSlot::NOT_STARTED)
+                s.read_cursor.store(w, std::memory_order_relaxed);
+            s.posted_through.store(w + 1, std::memory_order_relaxed);
+            readers++;
+
+            s.state.store(SourceSlot::ACTIVE, std::memory_order_release);
+            s.read_barrier.post();
+        }
 
         ++write_number_;
+
+        write_sequence.endWrite();
+
+        // With no readers, or if all have already read, the ring slot is
+        // free as soon as it is written
+        if (pending.fetch_sub(PENDING_BIAS - readers) == PENDING_BIAS - readers)
+            write_barrier.post();
     }
 
     // SOURCE read counting
     bool notifySourceReadComplete(size_t index) {
 
-        mutex_.wait();
-
-        source_read_required_[index] = false;
-        bool reads_finished = source_read_required_.none();
+        SourceSlot &s = slots_[index];
+        const uint64_t c = s.read_cursor.load(std::memory_order_relaxed);
+        s.read_cursor.store(c + 1, std::memory_order_relaxed);
 
-        mutex_.post();
+        s.read_latency.record(statsClock() - stats.write_time(c % ring_size_));
 
-        return reads_finished;
+        return pending_reads_[c % ring_size_].fetch_sub(1) == 1;
     }
 
     // SOURCE slots
-    static constexpr size_t NUM_SLOTS {10};
+    static constexpr size_t DEFAULT_NUM_SLOTS {256};
+    static constexpr size_t MAX_NUM_SLOTS {4096};
+
+    size_t num_slots(void) const { return num_slots_; }
+
+    // Size of a node segment holding a Node and num_slots SOURCE slots
+    static size_t segmentSize(const size_t num_slots) {
+        return 2048 + sizeof(Node) + num_slots * sizeof(SourceSlot);
+    }
 
     int acquireSlot(size_t &index) {
 
-        mutex_.wait();
+        for (index = 0; index < num_slots_; index++) {
+            uint32_t expected = SourceSlot::FREE;
+            if (slots_[index].state.compare_exchange_strong(
+                    expected, SourceSlot::CLAIMED, std::memory_order_acquire))
+                break;
+        }
 
-        if (source_slots_.all()) {
-            mutex_.post();
+        if (index == num_slots_)
             return -1;
-        }
 
-        index = 0;
-        while (source_slots_[index])
-            ++index;
+        SourceSlot &s = slots_[index];
+        s.pid = ::getpid();
+        s.read_cursor.store(SourceSlot::NOT_STARTED, std::memory_order_relaxed);
+        s.posted_through.store(0, std::memory_order_relaxed);
+        s.read_latency.reset();
+        s.wait_ns.store(0, STATS_ORDER);
+
+        // Drain any posts left over by a previous occupant of this slot
+        while (s.read_barrier.try_wait()) { }
 
-        source_slots_[index] = true;
-        source_ref_count_ = source_slots_.count();
+        // Make sure the SINK scans far enough to see this slot
+        size_t hw = high_water_.load();
+        while (hw < index + 1 && !high_water_.compare_exchange_weak(hw, index + 1)) { }
 
-        mutex_.post();
+        ++source_ref_count_;
+        s.state.store(SourceSlot::ACTIVE, std::memory_order_release);
 
         return 0;
     }
 
     int releaseSlot(size_t index) {
 
-        if (index >= source_slots_.size())
+        if (index >= num_slots_)
             return -1;
 
-        mutex_.wait();
-        source_slots_[index] = false;
-        source_ref_count_ = source_slots_.count();
-        mutex_.post();
+        SourceSlot &s = slots_[index];
+
+        // Stop the SINK from posting to this slot. The SINK only holds it for
+        // a few instructions in notifySinkWriteComplete().
+        uint32_t expected = SourceSlot::ACTIVE;
+        while (!s.state.compare_exchange_weak(expected, SourceSlot::LEAVING,
+                                              std::memory_order_acquire)) {
+            if (expected != SourceSlot::ACTIVE && expected != SourceSlot::POSTING)
+                return -1;
+            if (expected == SourceSlot::POSTING)
+                std::this_thread::yield();
+            expected = SourceSlot::ACTIVE;
+        }
+
+        // Reads owed by this source will never happen, so release any ring
+        // slots that were only waiting on it
+        size_t slots_freed = 0;
+        const uint64_t cursor = s.read_cursor.load(std::memory_order_relaxed);
+        const uint64_t through = s.posted_through.load(std::memory_order_relaxed);
+        if (cursor != SourceSlot::NOT_STARTED)
+            for (uint64_t w = cursor; w < through; w++)
+                if (pending_reads_[w % ring_size_].fetch_sub(1) == 1)
+                    slots_freed++;
+
+        s.pid = 0;
+        --source_ref_count_;
+        s.state.store(SourceSlot::FREE, std::memory_order_release);
+
+        for (size_t i = 0; i < slots_freed; i++)
+            write_barrier.post();
 
         return 0;
     }
 
+    /**
+     * Release the slots of SOURCEs whose processes have died without
+     * releasing them, so that the SINK is not blocked forever waiting on
+     * their reads.
+     * @return Number of slots that were released.
+     */
+    size_t releaseDeadSlots(void) {
+
+        size_t released = 0;
+        const size_t n = high_water_.load();
+        for (size_t i = 0; i < n; i++) {
+            if (slots_[i].state == SourceSlot::ACTIVE
+                && !isProcessAlive(slots_[i].pid)
+                && releaseSlot(i) == 0)
+                released++;
+        }
+
+        return released;
+    }
+
+    /**
+     * Wake every bound SOURCE so that it can observe a change in SINK state
+     * without waiting for a write.
+     */
+    void wakeSources(void) {
+
+        const size_t n = high_water_.load();
+        for (size_t i = 0; i < n; i++)
+            if (slots_[i].state == SourceSlot::ACTIVE)
+                slots_[i].read_barrier.post();
+    }
+
     size_t source_ref_count(void) const { return source_ref_count_; }
 
+    // Record a period that a SOURCE spent blocked in wait()
+    void recordSourceWait(size_t index, int64_t ns) {
+        slots_[index].wait_ns.fetch_add(ns, STATS_ORDER);
+    }
+
+    // SOURCE slots that may be in use, for monitoring
+    size_t high_water(void) const { return high_water_; }
+    const SourceSlot & slot(size_t index) const { return slots_[index]; }
+
+    // SOURCE read cursor: number of the next write this source will read
+    uint64_t read_cursor(size_t index) const {
+        const uint64_t c = slots_[index].read_cursor;
+        return c == SourceSlot::NOT_STARTED ? write_number_.load() : c;
+    }
+
+    // Object ring
+    static constexpr size_t MAX_RING_SIZE {32};
+    static_assert(MAX_RING_SIZE <= NodeStats::MAX_RING_SIZE,
+                  "NodeStats must hold a write time per ring slot.");
+
+    /**
+     * Set the number of object slots that the SINK cycles through. The SINK
+     * may run up to ring_size writes ahead of its slowest SOURCE before
+     * wait() blocks. Must be called by the SINK before it first writes.
+     * @param value Number of ring slots, 1 to MAX_RING_SIZE.
+     */
+    void set_ring_size(size_t value) {
+
+        if (value < 1 || value > MAX_RING_SIZE)
+            throw std::runtime_error("Ring size must be between 1 and "
+                                     + std::to_string(MAX_RING_SIZE) + ".");
+
+        // write_barrier counts free ring slots
+        for (size_t i = ring_size_; i < value; i++)
+            write_barrier.post();
+
+        ring_size_ = value;
+    }
+
+    size_t ring_size(void) const { return ring_size_; }
+
+    // Page policy (see Pages.h) that took effect on the SINK's segments.
+    // SOURCEs apply it to their own mappings when they connect. Must be set
+    // by the SINK before it binds.
+    void set_page_policy(uint32_t value) { page_policy_ = value; }
+    uint32_t page_policy(void) const { return page_policy_; }
+
     // Synchronization constructs
     // write _always_ occurs before read. By starting at 1, the writer is not
     // blocked by an initial wait. Readers to do not post to the write_barrier
-    // until a write occurs.
+    // until a write occurs. The SINK adds one count per extra ring slot when
+    // it binds.
     semaphore write_barrier {1};
 
-    // This method is required because an std::array of semaphores requires
-    // each semaphore to be copy-constructed to initialized the array.
-    // Because of their nature, semaphores are NOT copy constructable, so
-    // this approach does not work.
+    // Write counters used by SOURCEs in SourceMode::LATEST, which read the
+    // newest sample without holding a slot or a read barrier
+    SeqLock write_sequence;
+
+    // Runtime statistics for monitoring tools
+    NodeStats stats;
+
     semaphore& read_barrier(size_t index) {
 
-        if (!source_slots_[index])
+        if (index >= num_slots_ || slots_[index].state == SourceSlot::FREE)
             throw std::runtime_error("Requested index refers to a SOURCE "
                                      "that is not bound to this node.");
 
-        switch (index) {
-            case 0:
-                return rb0_;
-                break;
-            case 1:
-                return rb1_;
-                break;
-            case 2:
-                return rb2_;
-                break;
-            case 3:
-                return rb3_;
-                break;
-            case 4:
-                return rb4_;
-                break;
-            case 5:
-                return rb5_;
-                break;
-            case 6:
-                return rb6_;
-                break;
-            case 7:
-                return rb7_;
-                break;
-            case 8:
-                return rb8_;
-                break;
-            case 9:
-                return rb9_;
-                break;
-            default:
-                throw std::runtime_error("Source index out of range.");
-                break;
-        }
+        return slots_[index].read_barrier;
     }
 
 private:
 
+    // Added to a ring slot's pending read count while the SINK is posting
+    static constexpr uint32_t PENDING_BIAS {1u << 30};
+
     std::atomic<NodeState> sink_state_ {oat::NodeState::UNDEFINED}; //!< SINK state
-    std::atomic<size_t> source_read_count_ {0}; //!< Number SOURCE reads that have occured since last sink reset
-    std::bitset<NUM_SLOTS> source_slots_;
-    std::bitset<NUM_SLOTS> source_read_required_;
+    pid_t sink_pid_ {0}; //!< Process hosting the SINK
 
+    bip::offset_ptr<SourceSlot> slots_; //!< SOURCE slots in the node segment
+    size_t num_slots_ {0};
+    std::atomic<size_t> high_water_ {0}; //!< One past the highest slot ever acquired
     std::atomic<size_t> source_ref_count_ {0}; //!< Number of SOURCES sharing this node
-    std::atomic<uint64_t> write_number_ {0}; //!< Number of writes to shmem that have been facilited by this node
 
-    // Unfortunately, must manually maintain the number of rbx_'s to match NUM_SLOTS
-    semaphore mutex_ {1}; //!< mutex governing exclusive acces to the read_barrier_
-    semaphore rb0_ {0}, rb1_ {0}, rb2_ {0}, rb3_ {0}, rb4_ {0},
-              rb5_ {0}, rb6_ {0}, rb7_ {0}, rb8_ {0}, rb9_ {0};
+    std::array<std::atomic<uint32_t>, MAX_RING_SIZE> pending_reads_; //!< Reads owed per ring slot
+    std::atomic<size_t> ring_size_ {1}; //!< Number of object slots written in turn by the SINK
+    std::atomic<uint32_t> page_policy_ {0}; //!< Page policy of the SINK's segments
+    std::atomic<uint64_t> write_number_ {0}; //!< Number of writes to shmem that have been facilited by this node
 };
 
+/**
+ * Open or create a node segment and find or construct the Node within it.
+ * The first SINK or SOURCE to open the node allocates its SOURCE slots.
+ * @param segment Segment to open.
+ * @param segment_name Name of the node segment.
+ * @param num_slots Number of SOURCE slots to allocate if the node does not
+ * exist yet.
+ * @return The node.
+ */
+inline Node * openNode(shmem_t &segment,
+                       const std::string &segment_name,
+                       size_t num_slots) {
+
+    if (num_slots < 1 || num_slots > Node::MAX_NUM_SLOTS)
+        throw std::runtime_error("Number of SOURCE slots must be between 1 and "
+                                 + std::to_string(Node::MAX_NUM_SLOTS) + ".");
+
+    segment = shmem_t(bip::open_or_create,
+                      segment_name.c_str(),
+                      Node::segmentSize(num_slots));
+
+    Node *node = nullptr;
+
+    // Construct the node and its slots as a unit so that no one can see a
+    // node without slots
+    auto construct = [&segment, &node, num_slots] {
+
+        node = segment.find_or_construct<Node>(typeid(Node).name())();
+
+        if (node->slots_ == nullptr) {
+            node->slots_ = segment.construct<SourceSlot>
+                                (typeid(SourceSlot).name())[num_slots]();
+            node->num_slots_ = num_slots;
+        }
+    };
+    segment.atomic_func(construct);
+
+    return node;
+}
+
 }       /* namespace oat */
 #endif	/* OAT_NODE_H */
-
@@ -0,0 +1,144 @@
+//******************************************************************************
+//* File:   NodeStats.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_NODESTATS_H
+#define	OAT_NODESTATS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace oat {
+
+// Statistics are only ever read by monitors, so they are updated with
+// relaxed atomics and never order anything else
+constexpr std::memory_order STATS_ORDER {std::memory_order_relaxed};
+
+/**
+ * @return Nanoseconds on a monotonic clock that is shared by all processes.
+ */
+inline int64_t statsClock(void) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Histogram of latencies with power of two microsecond bins. Bin 0 counts
+ * latencies under 1 us and bin i counts latencies in [2^(i-1), 2^i) us. The
+ * last bin is open ended.
+ */
+struct LatencyHistogram {
+
+    static constexpr size_t NUM_BINS {24};
+
+    LatencyHistogram() { reset(); }
+
+    void record(const int64_t ns) {
+
+        const uint64_t us = ns > 0 ? static_cast<uint64_t>(ns) / 1000 : 0;
+        size_t bin = us == 0 ? 0 : 64 - __builtin_clzll(us);
+        if (bin >= NUM_BINS)
+            bin = NUM_BINS - 1;
+
+        bins[bin].fetch_add(1, STATS_ORDER);
+    }
+
+    void reset(void) {
+        for (auto &b : bins)
+            b.store(0, STATS_ORDER);
+    }
+
+    /**
+     * Upper edge of a bin.
+     * @param bin Bin index.
+     * @return Latency in microseconds.
+     */
+    static uint64_t upperEdge(const size_t bin) { return 1ull << bin; }
+
+    std::array<std::atomic<uint64_t>, NUM_BINS> bins;
+};
+
+/**
+ * Runtime statistics kept by a Node for monitoring tools such as oat-top.
+ * Per-SOURCE statistics are kept in each SourceSlot.
+ */
+class NodeStats {
+
+public:
+
+    static constexpr size_t MAX_RING_SIZE {32};
+
+    NodeStats()
+    {
+        for (auto &t : write_time_)
+            t = 0;
+    }
+
+    /**
+     * Record the completion of a write.
+     * @param ring_index Ring slot that was written.
+     */
+    void recordWrite(const size_t ring_index) {
+
+        const int64_t t = statsClock();
+        write_time_[ring_index].store(t, STATS_ORDER);
+        last_write_time_.store(t, STATS_ORDER);
+    }
+
+    /**
+     * Record a period that the SINK spent blocked in wait().
+     * @param ns Duration in nanoseconds.
+     */
+    void recordSinkWait(const int64_t ns) {
+        sink_wait_ns_.fetch_add(ns, STATS_ORDER);
+        sink_waits_.fetch_add(1, STATS_ORDER);
+    }
+
+    /**
+     * Record how late a paced SINK was for the deadline of a write.
+     * @param ns Lateness in nanoseconds.
+     */
+    void recordLateness(const int64_t ns) {
+        lateness.record(ns);
+    }
+
+    // Time the sample in a ring slot was written (see statsClock())
+    int64_t write_time(const size_t ring_index) const {
+        return write_time_[ring_index].load(STATS_ORDER);
+    }
+
+    int64_t last_write_time(void) const { return last_write_time_.load(STATS_ORDER); }
+    int64_t sink_wait_ns(void) const { return sink_wait_ns_.load(STATS_ORDER); }
+    uint64_t sink_waits(void) const { return sink_waits_.load(STATS_ORDER); }
+
+    // Lateness of a paced SINK's writes relative to its schedule. Empty if
+    // the SINK is not paced.
+    LatencyHistogram lateness;
+
+private:
+
+    std::array<std::atomic<int64_t>, MAX_RING_SIZE> write_time_; //!< Write time of each ring slot
+    std::atomic<int64_t> last_write_time_ {0}; //!< Time of the last write
+    std::atomic<int64_t> sink_wait_ns_ {0}; //!< Total time the SINK has blocked in wait()
+    std::atomic<uint64_t> sink_waits_ {0}; //!< Number of times the SINK has blocked in wait()
+};
+
+}       /* namespace oat */
+#endif	/* OAT_NODESTATS_H */
@@ -0,0 +1,171 @@
+//******************************************************************************
+//* File:   Pages.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_PAGES_H
+#define	OAT_PAGES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace oat {
+
+/**
+ * How the pages of a node's shared memory segments are backed. Flags may be
+ * or'ed together. Each flag falls back silently to ordinary pages when the
+ * system does not allow it, so the flags that took effect should be checked
+ * after bind().
+ *
+ * PAGES_HUGE: Back the segments with transparent huge pages to cut TLB
+ * misses on multi-megapixel frames. Shared memory only gets huge pages if
+ * /dev/shm is mounted with huge=advise (or always or within_size), or if
+ * /sys/kernel/mm/transparent_hugepage/shmem_enabled is "force".
+ *
+ * PAGES_LOCKED: Lock the segments in RAM with mlock(2) so that they are
+ * never paged out. Requires a sufficient RLIMIT_MEMLOCK.
+ *
+ * Nodes that use the in-process transport live on the heap, which gets
+ * huge pages unless /sys/kernel/mm/transparent_hugepage/enabled is "never".
+ *
+ * Either flag also pre-faults the segments when they are mapped, so that no
+ * processing stage takes page faults on the first frames it touches.
+ */
+enum PagePolicy : uint32_t
+{
+    PAGES_DEFAULT   = 0,
+    PAGES_HUGE      = 1u << 0,
+    PAGES_LOCKED    = 1u << 1,
+};
+
+constexpr size_t HUGE_PAGE_SIZE {2 * 1024 * 1024};
+
+/**
+ * Round a segment size up so that, with PAGES_HUGE, its tail is not left on
+ * ordinary pages.
+ * @param bytes Requested segment size.
+ * @param policy Page policy flags.
+ * @return Segment size to allocate.
+ */
+inline size_t pageAlign(const size_t bytes, const uint32_t policy) {
+
+    if (!(policy & PAGES_HUGE))
+        return bytes;
+
+    return (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+}
+
+/**
+ * @return True if the kernel will back POSIX shared memory with transparent
+ * huge pages on request.
+ */
+inline bool shmemHugePagesAvailable(void) {
+
+    // The system wide mode is bracketed, e.g. "always [advise] never". It
+    // only overrides the /dev/shm mount in the "force" and "deny" modes.
+    std::ifstream modes("/sys/kernel/mm/transparent_hugepage/shmem_enabled");
+    std::string mode;
+    while (modes >> mode) {
+        if (mode == "[force]")
+            return true;
+        if (mode == "[deny]")
+            return false;
+    }
+
+    // Otherwise the tmpfs mounted at /dev/shm must have been mounted with
+    // huge=advise, huge=always or huge=within_size. The last entry for
+    // /dev/shm is the mount that is visible.
+    std::ifstream mounts("/proc/mounts");
+    std::string device, mount_point, fs_type, options, rest, shm_options;
+    while (mounts >> device >> mount_point >> fs_type >> options) {
+        std::getline(mounts, rest);
+        if (mount_point == "/dev/shm")
+            shm_options = options + ",";
+    }
+
+    return shm_options.find("huge=advise,") != std::string::npos
+        || shm_options.find("huge=always,") != std::string::npos
+        || shm_options.find("huge=within_size,") != std::string::npos;
+}
+
+/**
+ * @return True if the kernel will back private anonymous memory with
+ * transparent huge pages on request.
+ */
+inline bool anonHugePagesAvailable(void) {
+
+    std::ifstream modes("/sys/kernel/mm/transparent_hugepage/enabled");
+    std::string mode;
+    while (modes >> mode) {
+        if (mode == "[always]" || mode == "[madvise]")
+            return true;
+    }
+
+    return false;
+}
+
+/**
+ * Apply a page policy to a mapped segment.
+ * @param address Start of the mapping.
+ * @param bytes Size of the mapping.
+ * @param policy Requested page policy flags.
+ * @param in_process True if the segment is private memory of this process
+ * rather than POSIX shared memory.
+ * @return Page policy flags that took effect.
+ */
+inline uint32_t applyPagePolicy(void *address, const size_t bytes,
+                                const uint32_t policy,
+                                const bool in_process = false) {
+
+    uint32_t applied = PAGES_DEFAULT;
+    if (policy == PAGES_DEFAULT)
+        return applied;
+
+    // madvise() and mlock() act on whole pages
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const uintptr_t end = reinterpret_cast<uintptr_t>(address) + bytes;
+    const uintptr_t start = reinterpret_cast<uintptr_t>(address) & ~(page - 1);
+    char *begin = reinterpret_cast<char *>(start);
+    const size_t length = end - start;
+
+#ifdef MADV_HUGEPAGE
+    if ((policy & PAGES_HUGE)
+        && (in_process ? anonHugePagesAvailable() : shmemHugePagesAvailable())
+        && madvise(begin, length, MADV_HUGEPAGE) == 0)
+        applied |= PAGES_HUGE;
+#endif
+
+    // mlock() faults in every page it locks
+    if ((policy & PAGES_LOCKED) && mlock(begin, length) == 0) {
+        applied |= PAGES_LOCKED;
+    } else {
+
+        // Reading a byte of each page faults it in without modifying it
+        const volatile char *p = begin;
+        for (size_t i = 0; i < length; i += page)
+            (void)p[i];
+    }
+
+    return applied;
+}
+
+}       /* namespace oat */
+#endif	/* OAT_PAGES_H */
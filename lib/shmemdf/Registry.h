@@ -0,0 +1,264 @@
+//******************************************************************************
+//* File:   Registry.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_REGISTRY_H
+#define	OAT_REGISTRY_H
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <set>
+#include <string>
+#include <boost/core/demangle.hpp>
+
+#include "ForwardsDecl.h"
+#include "Node.h"
+
+namespace oat {
+
+/**
+ * A SINK or SOURCE that is using a node.
+ */
+struct RegistryEntry {
+
+    enum State : uint32_t {
+        FREE = 0,   //!< Available
+        CLAIMED,    //!< Being filled in
+        ACTIVE      //!< Describes a live SINK or SOURCE
+    };
+
+    enum Role : uint32_t {
+        SINK = 0,
+        SOURCE
+    };
+
+    static constexpr size_t MAX_ADDRESS_LENGTH {128};
+    static constexpr size_t MAX_TYPE_LENGTH {64};
+
+    std::atomic<uint32_t> state {FREE};
+    std::atomic<pid_t> pid {0};     //!< Process hosting the SINK or SOURCE
+    std::atomic<uint32_t> role {SINK};
+    std::atomic<uint64_t> node_bytes {0}; //!< Size of the node segment
+    std::atomic<uint64_t> obj_bytes {0};  //!< Size of the object segment, once mapped
+    char address[MAX_ADDRESS_LENGTH] {}; //!< Node address
+    char type[MAX_TYPE_LENGTH] {};       //!< Type of the shared object
+};
+
+/**
+ * Table of the SINKs and SOURCEs using nodes in shared memory, kept in a
+ * segment of its own. Every SINK and SOURCE records itself in the registry
+ * before it opens a node and removes itself when it is destroyed, so tools
+ * can enumerate nodes without scanning /dev/shm. Entries left behind by
+ * processes that died are reclaimed, along with the segments of any node
+ * that no live process was using, the next time a SINK or SOURCE registers.
+ * Nodes using the in-process transport are not registered.
+ */
+class Registry {
+
+public:
+
+    static constexpr size_t MAX_ENTRIES {1024};
+
+    static const char * segmentName(void) { return "oat_registry"; }
+
+    static size_t segmentSize(void) { return 4096 + sizeof(Registry); }
+
+    Registry() = default;
+
+    // Registries are not copyable
+    Registry(const Registry &) = delete;
+    Registry & operator=(const Registry &) = delete;
+
+    /**
+     * Add an entry. Must be called under the registry segment's lock.
+     * @return Index of the entry, or -1 if the registry is full.
+     */
+    int add(const RegistryEntry::Role role,
+            const std::string &address,
+            const std::string &type) {
+
+        for (size_t i = 0; i < MAX_ENTRIES; i++) {
+
+            RegistryEntry &e = entries_[i];
+            uint32_t expected = RegistryEntry::FREE;
+            if (!e.state.compare_exchange_strong(expected, RegistryEntry::CLAIMED,
+                                                 std::memory_order_acquire))
+                continue;
+
+            e.pid = ::getpid();
+            e.role = role;
+            e.node_bytes = 0;
+            e.obj_bytes = 0;
+            std::strncpy(e.address, address.c_str(), sizeof(e.address) - 1);
+            e.address[sizeof(e.address) - 1] = '\0';
+            std::strncpy(e.type, type.c_str(), sizeof(e.type) - 1);
+            e.type[sizeof(e.type) - 1] = '\0';
+
+            e.state.store(RegistryEntry::ACTIVE, std::memory_order_release);
+            return static_cast<int>(i);
+        }
+
+        return -1;
+    }
+
+    void remove(const size_t index) {
+        entries_[index].state.store(RegistryEntry::FREE, std::memory_order_release);
+    }
+
+    RegistryEntry & entry(const size_t index) { return entries_[index]; }
+    const RegistryEntry & entry(const size_t index) const { return entries_[index]; }
+
+    /**
+     * Free the entries of processes that have died, and remove the segments
+     * of nodes that were only used by them. Must be called under the
+     * registry segment's lock.
+     * @return Addresses of the nodes that were removed.
+     */
+    std::set<std::string> reclaim(void) {
+
+        std::set<std::string> live, dead;
+        for (auto &e : entries_) {
+
+            if (e.state != RegistryEntry::ACTIVE)
+                continue;
+
+            if (isProcessAlive(e.pid)) {
+                live.insert(e.address);
+            } else {
+                dead.insert(e.address);
+                e.state.store(RegistryEntry::FREE, std::memory_order_release);
+            }
+        }
+
+        std::set<std::string> removed;
+        for (auto &a : dead) {
+            if (live.count(a) == 0) {
+                shmem_t::remove((a + "_node").c_str());
+                shmem_t::remove((a + "_obj").c_str());
+                removed.insert(a);
+            }
+        }
+
+        return removed;
+    }
+
+    /**
+     * @return Addresses of the nodes with at least one live SINK or SOURCE.
+     */
+    std::set<std::string> addresses(void) const {
+
+        std::set<std::string> a;
+        for (auto &e : entries_)
+            if (e.state == RegistryEntry::ACTIVE && isProcessAlive(e.pid))
+                a.insert(e.address);
+
+        return a;
+    }
+
+private:
+
+    std::array<RegistryEntry, MAX_ENTRIES> entries_;
+};
+
+/**
+ * Open or create the registry segment and find or construct the Registry
+ * within it.
+ * @param segment Segment to open.
+ * @return The registry.
+ */
+inline Registry * openRegistry(shmem_t &segment) {
+
+    segment = shmem_t(bip::open_or_create,
+                      Registry::segmentName(),
+                      Registry::segmentSize());
+
+    Registry *registry = nullptr;
+    auto construct = [&segment, &registry] {
+        registry = segment.find_or_construct<Registry>(typeid(Registry).name())();
+    };
+    segment.atomic_func(construct);
+
+    return registry;
+}
+
+/**
+ * The registry entry of a SINK or SOURCE. Removed when destroyed.
+ */
+class Registration {
+
+public:
+
+    Registration() = default;
+    ~Registration() { release(); }
+
+    // Registrations are not copyable
+    Registration(const Registration &) = delete;
+    Registration & operator=(const Registration &) = delete;
+
+    /**
+     * Reclaim stale registry entries, then record a SINK or SOURCE using the
+     * node at address. Must be called before the node is opened.
+     * @param role Whether a SINK or SOURCE is using the node.
+     * @param address Node address.
+     */
+    template <typename T>
+    void record(const RegistryEntry::Role role, const std::string &address) {
+
+        release();
+
+        if (InProcessRegistry::instance().contains(address + "_node"))
+            return;
+
+        registry_ = openRegistry(segment_);
+
+        // Reclaiming and adding must be atomic so that a node is never
+        // removed after a live SINK or SOURCE has registered to use it
+        const std::string type = boost::core::demangle(typeid(T).name());
+        auto add = [this, role, &address, &type] {
+            registry_->reclaim();
+            index_ = registry_->add(role, address, type);
+        };
+        segment_.atomic_func(add);
+    }
+
+    /**
+     * Record the sizes of the node's segments once they are mapped.
+     */
+    void set_sizes(const size_t node_bytes, const size_t obj_bytes) {
+        if (index_ < 0)
+            return;
+        registry_->entry(index_).node_bytes = node_bytes;
+        registry_->entry(index_).obj_bytes = obj_bytes;
+    }
+
+    void release(void) {
+        if (index_ >= 0)
+            registry_->remove(index_);
+        index_ = -1;
+    }
+
+private:
+
+    shmem_t segment_;
+    Registry *registry_ {nullptr};
+    int index_ {-1};
+};
+
+}       /* namespace oat */
+#endif	/* OAT_REGISTRY_H */
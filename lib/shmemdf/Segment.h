@@ -0,0 +1,263 @@
+//******************************************************************************
+//* File:   Segment.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_SEGMENT_H
+#define	OAT_SEGMENT_H
+
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <boost/interprocess/managed_external_buffer.hpp>
+#include <boost/interprocess/managed_shared_memory.hpp>
+
+namespace oat {
+
+namespace bip = boost::interprocess;
+
+/**
+ * Managed memory for a node or its shared objects that lives on the heap of
+ * this process. Uses the same segment manager as bip::managed_shared_memory,
+ * so objects are allocated, named and found identically.
+ */
+class HeapSegment {
+
+    using buffer_t = bip::basic_managed_external_buffer
+                        <char, bip::rbtree_best_fit<bip::mutex_family>,
+                         bip::iset_index>;
+
+public:
+
+    explicit HeapSegment(const size_t size) :
+      buffer_(allocate(size), &std::free)
+    , memory_(bip::create_only, buffer_.get(), size)
+    {
+        // Nothing
+    }
+
+    buffer_t & memory(void) { return memory_; }
+
+private:
+
+    // Large segments are aligned to huge pages so that they can be backed
+    // by them (see Pages.h)
+    static void * allocate(const size_t size) {
+
+        const size_t alignment = size >= (2 << 20) ? (2 << 20) : 4096;
+        void *buffer = nullptr;
+        if (posix_memalign(&buffer, alignment, size) != 0)
+            throw std::bad_alloc();
+
+        return buffer;
+    }
+
+    std::unique_ptr<void, decltype(&std::free)> buffer_;
+    buffer_t memory_;
+};
+
+/**
+ * Process-wide table of node addresses that use the in-process transport,
+ * and of the heap segments that back them. Segments are named and removed
+ * exactly like POSIX shared memory objects: removing a name does not free
+ * a segment until the last Segment referring to it is destroyed.
+ */
+class InProcessRegistry {
+
+public:
+
+    static InProcessRegistry & instance(void) {
+        static InProcessRegistry registry;
+        return registry;
+    }
+
+    void add(const std::string &address) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        names_.insert(address + "_node");
+        names_.insert(address + "_obj");
+    }
+
+    bool contains(const std::string &segment_name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return names_.count(segment_name) > 0;
+    }
+
+    std::shared_ptr<HeapSegment> open(const std::string &segment_name,
+                                      const size_t size,
+                                      const bool create,
+                                      const bool open) {
+
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        auto it = segments_.find(segment_name);
+        if (it != segments_.end()) {
+            if (!open)
+                throw bip::interprocess_exception(bip::already_exists_error);
+            return it->second;
+        }
+
+        if (!create)
+            throw bip::interprocess_exception(bip::not_found_error);
+
+        auto segment = std::make_shared<HeapSegment>(size);
+        segments_[segment_name] = segment;
+        return segment;
+    }
+
+    bool remove(const std::string &segment_name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return segments_.erase(segment_name) > 0;
+    }
+
+private:
+
+    InProcessRegistry() = default;
+
+    std::mutex mutex_;
+    std::set<std::string> names_;
+    std::map<std::string, std::shared_ptr<HeapSegment>> segments_;
+};
+
+/**
+ * Make SINKs and SOURCEs in this process that use the node at address
+ * exchange data through the heap instead of POSIX shared memory. Synchronization
+ * is unchanged, but the node is invisible to other processes. Must be called
+ * before any SINK or SOURCE in this process opens the node.
+ * @param address Node address.
+ */
+inline void useInProcessTransport(const std::string &address) {
+    InProcessRegistry::instance().add(address);
+}
+
+/**
+ * A managed memory segment holding a node or its shared objects. Backed by
+ * POSIX shared memory, or by a HeapSegment if the node uses the in-process
+ * transport.
+ */
+class Segment {
+
+public:
+
+    using segment_manager = bip::managed_shared_memory::segment_manager;
+    using handle_t = bip::managed_shared_memory::handle_t;
+
+    Segment() = default;
+
+    Segment(bip::create_only_t, const char *name, const size_t size) {
+        if (InProcessRegistry::instance().contains(name))
+            openHeap(name, size, true, false);
+        else
+            openShared(std::make_shared<bip::managed_shared_memory>
+                            (bip::create_only, name, size));
+    }
+
+    Segment(bip::open_only_t, const char *name) {
+        if (InProcessRegistry::instance().contains(name))
+            openHeap(name, 0, false, true);
+        else
+            openShared(std::make_shared<bip::managed_shared_memory>
+                            (bip::open_only, name));
+    }
+
+    Segment(bip::open_or_create_t, const char *name, const size_t size) {
+        if (InProcessRegistry::instance().contains(name))
+            openHeap(name, size, true, true);
+        else
+            openShared(std::make_shared<bip::managed_shared_memory>
+                            (bip::open_or_create, name, size));
+    }
+
+    /**
+     * Remove a segment name. The memory is freed once every Segment mapping
+     * it has been destroyed.
+     * @param name Segment name.
+     * @return True if the name existed.
+     */
+    static bool remove(const char *name) {
+        if (InProcessRegistry::instance().contains(name))
+            return InProcessRegistry::instance().remove(name);
+        return bip::shared_memory_object::remove(name);
+    }
+
+    template <typename T>
+    std::pair<T *, std::size_t> find(const char *name) {
+        return manager_->template find<T>(name);
+    }
+
+    template <typename T>
+    typename segment_manager::template construct_proxy<T>::type
+    construct(const char *name) {
+        return manager_->template construct<T>(name);
+    }
+
+    template <typename T>
+    typename segment_manager::template construct_proxy<T>::type
+    find_or_construct(const char *name) {
+        return manager_->template find_or_construct<T>(name);
+    }
+
+    template <typename Func>
+    void atomic_func(Func &f) { manager_->atomic_func(f); }
+
+    void * allocate(const std::size_t bytes) { return manager_->allocate(bytes); }
+
+    // Handles are offsets from the start of the segment, so they are valid
+    // in every process that maps it
+    handle_t get_handle_from_address(const void *ptr) const {
+        return static_cast<const char *>(ptr) - static_cast<const char *>(address_);
+    }
+
+    void * get_address_from_handle(const handle_t handle) const {
+        return static_cast<char *>(address_) + handle;
+    }
+
+    void * get_address(void) const { return address_; }
+    std::size_t get_size(void) const { return size_; }
+
+    bool in_process(void) const { return in_process_; }
+
+private:
+
+    std::shared_ptr<void> owner_;   //!< Keeps the mapping or heap alive
+    segment_manager *manager_ {nullptr};
+    void *address_ {nullptr};
+    std::size_t size_ {0};
+    bool in_process_ {false};
+
+    void openShared(std::shared_ptr<bip::managed_shared_memory> &&memory) {
+        manager_ = memory->get_segment_manager();
+        address_ = memory->get_address();
+        size_ = memory->get_size();
+        owner_ = std::move(memory);
+    }
+
+    void openHeap(const char *name, const size_t size,
+                  const bool create, const bool open) {
+        auto heap = InProcessRegistry::instance().open(name, size, create, open);
+        manager_ = heap->memory().get_segment_manager();
+        address_ = heap->memory().get_address();
+        size_ = heap->memory().get_size();
+        in_process_ = true;
+        owner_ = std::move(heap);
+    }
+};
+
+}       /* namespace oat */
+#endif	/* OAT_SEGMENT_H */
@@ -0,0 +1,137 @@
+//******************************************************************************
+//* File:   Semaphore.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_SEMAPHORE_H
+#define	OAT_SEMAPHORE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "Futex.h"
+
+namespace oat {
+
+/**
+ * Counting semaphore that can be placed in shared memory.
+ *
+ * The count is a 32-bit futex word. post() and an uncontended wait() are a
+ * single atomic operation each. Blocked waiters sleep in the kernel and are
+ * woken directly by post(), so there is no polling and no clock reads on the
+ * fast path. Waiters and posters may live in different processes.
+ */
+class Semaphore {
+
+    using Clock = std::chrono::steady_clock;
+
+public:
+
+    explicit Semaphore(const uint32_t count = 0) :
+      count_(count)
+    {
+        // Nothing
+    }
+
+    // Semaphores are not copyable
+    Semaphore(const Semaphore &) = delete;
+    Semaphore & operator=(const Semaphore &) = delete;
+
+    /**
+     * Increment the count and wake one blocked waiter, if there is one.
+     */
+    void post() {
+
+        // seq_cst ordering pairs with the waiter's registration in block():
+        // either this load sees the waiter, or the waiter's FUTEX_WAIT sees
+        // the incremented count and does not sleep.
+        count_.fetch_add(1, std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_seq_cst) > 0)
+            futex::wake(count_, 1);
+    }
+
+    /**
+     * Decrement the count if it is positive.
+     * @return True if the count was decremented.
+     */
+    bool try_wait() {
+
+        uint32_t c = count_.load(std::memory_order_relaxed);
+        while (c > 0) {
+            if (count_.compare_exchange_weak(c, c - 1,
+                                             std::memory_order_acquire,
+                                             std::memory_order_relaxed))
+                return true;
+        }
+
+        return false;
+    }
+
+    /**
+     * Block until the count can be decremented.
+     */
+    void wait() {
+
+        while (!try_wait())
+            block(nullptr);
+    }
+
+    /**
+     * Block until the count can be decremented or the timeout expires.
+     * @param timeout Maximum time to block.
+     * @return True if the count was decremented, false on timeout.
+     */
+    template <typename Rep, typename Period>
+    bool timed_wait(const std::chrono::duration<Rep, Period> timeout) {
+
+        const auto deadline = Clock::now() + timeout;
+
+        while (!try_wait()) {
+
+            auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>
+                                (deadline - Clock::now());
+            if (remaining.count() <= 0)
+                return false;
+
+            struct timespec ts = futex::toTimespec(remaining);
+            block(&ts);
+        }
+
+        return true;
+    }
+
+    uint32_t count(void) const { return count_.load(std::memory_order_relaxed); }
+
+private:
+
+    std::atomic<uint32_t> count_;
+    std::atomic<uint32_t> waiters_ {0};
+
+    void block(const struct timespec *timeout) {
+
+        waiters_.fetch_add(1, std::memory_order_seq_cst);
+
+        // Sleeps only if the count is still 0
+        futex::wait(count_, 0, timeout);
+
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+};
+
+}       /* namespace oat */
+#endif	/* OAT_SEMAPHORE_H */
@@ -0,0 +1,122 @@
+//******************************************************************************
+//* File:   SeqLock.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_SEQLOCK_H
+#define	OAT_SEQLOCK_H
+
+#include <atomic>
+#include <climits>
+#include <chrono>
+#include <cstdint>
+
+#include "Futex.h"
+
+namespace oat {
+
+/**
+ * Sequence counters that let readers copy the newest sample out of a ring
+ * of depth slots without ever blocking the single writer.
+ *
+ * The writer brackets each write with beginWrite() and endWrite(). Write
+ * number n (counting from 0) goes to ring slot n % depth. A reader takes
+ * n = completed(), copies slot (n - 1) % depth, and then calls
+ * validate(n, depth). The copy is torn, and must be retried, only if the
+ * writer has since started writing to that same slot again. With depth 1
+ * this is an ordinary seqlock.
+ *
+ * Readers that want to sleep until the next write use the eventcount
+ * prepareWait()/wait() pair, which never misses an endWrite() or wake().
+ */
+class SeqLock {
+
+public:
+
+    SeqLock() = default;
+
+    // SeqLocks are not copyable
+    SeqLock(const SeqLock &) = delete;
+    SeqLock & operator=(const SeqLock &) = delete;
+
+    // Writer
+    void beginWrite() {
+        started_.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    void endWrite() {
+        completed_.fetch_add(1, std::memory_order_release);
+        wake();
+    }
+
+    // Undo a beginWrite() that was not followed by any writes
+    void abortWrite() {
+        started_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // Reader
+    uint64_t completed() const {
+        return completed_.load(std::memory_order_acquire);
+    }
+
+    bool validate(const uint64_t n, const uint64_t depth) const {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return started_.load(std::memory_order_relaxed) < n + depth;
+    }
+
+    /**
+     * Get a key to pass to wait(). Must be called before checking the
+     * condition that is being waited for.
+     */
+    uint32_t prepareWait() const {
+        return epoch_.load(std::memory_order_seq_cst);
+    }
+
+    /**
+     * Sleep until the next endWrite() or wake() following prepareWait(), or
+     * until the timeout expires.
+     */
+    template <typename Rep, typename Period>
+    void wait(const uint32_t key, const std::chrono::duration<Rep, Period> timeout) {
+
+        struct timespec ts = futex::toTimespec(timeout);
+
+        waiters_.fetch_add(1, std::memory_order_seq_cst);
+        futex::wait(epoch_, key, &ts);
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Wake all sleeping readers.
+     */
+    void wake() {
+        epoch_.fetch_add(1, std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_seq_cst) > 0)
+            futex::wake(epoch_, INT_MAX);
+    }
+
+private:
+
+    std::atomic<uint64_t> started_ {0};
+    std::atomic<uint64_t> completed_ {0};
+    std::atomic<uint32_t> epoch_ {0};
+    std::atomic<uint32_t> waiters_ {0};
+};
+
+}       /* namespace oat */
+#endif	/* OAT_SEQLOCK_H */
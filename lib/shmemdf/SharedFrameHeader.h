@@ -23,6 +23,8 @@
 #include <atomic>
 #include <boost/interprocess/managed_shared_memory.hpp>
 
+#include "../datatypes/PixelFormat.h"
+
 namespace oat {
 namespace bip = boost::interprocess;
 
@@ -50,6 +52,9 @@ public :
     size_t rows() const { return rows_; }
     size_t cols() const { return cols_; }
     int type() const { return type_; }
+    PixelFormat format() const { return static_cast<PixelFormat>(format_.load()); }
+    size_t step() const { return step_; }
+    size_t offset() const { return offset_; }
     handle_t sample() const { return sample_; }
     handle_t data() const { return data_; }
 
@@ -61,17 +66,28 @@ public :
      * @param rows Number of rows in the matrix
      * @param cols Number of columns in the matrix
      * @param type OpenCV cv::Mat type of the frame
+     * @param format Pixel format of the frame
+     * @param step Bytes from one row of the frame to the next
+     * @param offset Bytes from the start of the matrix data to the frame's
+     * first pixel. Together with step, this allows the frame to be a region
+     * of a larger matrix.
      */
     void setParameters(const handle_t data,
                        const handle_t sample,
                        const size_t rows,
                        const size_t cols,
-                       const int type) {
+                       const int type,
+                       const PixelFormat format,
+                       const size_t step,
+                       const size_t offset) {
         data_ = data;
         sample_ = sample;
         rows_ = rows;
         cols_ = cols;
         type_ = type;
+        format_ = static_cast<int>(format);
+        step_ = step;
+        offset_ = offset;
     }
 
 private :
@@ -85,6 +101,9 @@ private :
     std::atomic<int> rows_ {0};
     std::atomic<int> cols_ {0};
     std::atomic<int> type_ {0};
+    std::atomic<int> format_ {0};
+    std::atomic<size_t> step_ {0};
+    std::atomic<size_t> offset_ {0};
 
     // Interprocess matrix data and sample handles
     std::atomic<handle_t> data_;
@@ -23,14 +23,16 @@
 #include <iostream>
 #include <string>
 #include <memory>
+#include <vector>
 #include <boost/interprocess/managed_shared_memory.hpp>
-#include <boost/thread/thread_time.hpp>
 
 #include "../datatypes/Sample.h"
 #include "../datatypes/Frame.h"
 
 #include "ForwardsDecl.h"
 #include "Node.h"
+#include "Pages.h"
+#include "Registry.h"
 #include "SharedFrameHeader.h"
 
 namespace oat {
@@ -48,6 +50,55 @@ public:
     void wait();
     void post();
 
+    /**
+     * Give back the ring slot obtained by wait() without publishing it, e.g.
+     * when the SINK's input ends before it has written. Nothing may have
+     * been written to the slot. wait() is required again afterwards.
+     */
+    void cancel();
+
+    /**
+     * Set the number of shared object slots that this SINK cycles through.
+     * With a ring of more than one slot, the SINK only blocks in wait() when
+     * it is ring_size writes ahead of its slowest SOURCE. Must be set before
+     * bind().
+     * @param value Number of ring slots, 1 to Node::MAX_RING_SIZE.
+     */
+    void set_ring_size(const size_t value);
+    size_t ring_size(void) const { return ring_size_; }
+
+    /**
+     * Set the maximum number of SOURCEs that can share this SINK's node in
+     * SourceMode::SYNCHRONOUS. Slots are allocated when the node is created,
+     * so this only has an effect if the SINK binds before any SOURCE
+     * touches the node. Must be set before bind().
+     * @param value Number of SOURCE slots, 1 to Node::MAX_NUM_SLOTS.
+     */
+    void set_max_sources(const size_t value);
+    size_t max_sources(void) const { return max_sources_; }
+
+    /**
+     * Set how the pages of this SINK's shared memory segments are backed.
+     * SOURCEs apply the same policy to their mappings. Must be set before
+     * bind().
+     * @param value PagePolicy flags.
+     */
+    void set_page_policy(const uint32_t value);
+    uint32_t page_policy(void) const { return page_policy_; }
+
+    /**
+     * @return PagePolicy flags that took effect when the SINK bound. Flags
+     * the system did not allow are dropped.
+     */
+    uint32_t applied_page_policy(void) const { return applied_page_policy_; }
+
+    /**
+     * Record how late a SINK that writes on a schedule was for the deadline
+     * of its last write, for monitoring tools. Must be called after bind().
+     * @param ns Lateness in nanoseconds.
+     */
+    void recordLateness(const int64_t ns) { node_->stats.recordLateness(ns); }
+
 protected:
 
     std::string address_;
@@ -55,7 +106,18 @@ protected:
     Node * node_ {nullptr};
     T * sh_object_ {nullptr};
     std::string node_address_, obj_address_;
+    size_t ring_size_ {1};
+    size_t max_sources_ {Node::DEFAULT_NUM_SLOTS};
+    uint32_t page_policy_ {PAGES_DEFAULT};
+    uint32_t applied_page_policy_ {PAGES_DEFAULT};
     bool bound_ {false};
+    Registration registration_;
+
+    // Index of the ring slot that will be published by the next post()
+    size_t write_slot(void) const { return node_->write_number() % ring_size_; }
+
+    // Apply the page policy to the node and object segments
+    void preparePages(void);
 
 private:
     bool did_wait_need_post_ {false};
@@ -75,10 +137,14 @@ inline SinkBase<T>::~SinkBase() {
 
         node_->set_sink_state(NodeState::END);
 
+        // Blocked SOURCEs will not be woken by another write, so wake them
+        // to see that the SINK has left
+        node_->wakeSources();
+
         // If the client ref count is 0, memory can be deallocated
         if (node_->source_ref_count() == 0 &&
-            bip::shared_memory_object::remove(node_address_.c_str()) &&
-            bip::shared_memory_object::remove(obj_address_.c_str())) {
+            shmem_t::remove(node_address_.c_str()) &&
+            shmem_t::remove(obj_address_.c_str())) {
 
 #ifndef NDEBUG
         std::cout << "Shared memory at \'" + node_address_ +
@@ -99,16 +165,21 @@ inline void SinkBase<T>::wait() {
         throw std::runtime_error("wait() called when post() was required.");
 #endif
 
-    boost::system_time timeout = boost::get_system_time() + msec_t(10);
+    // Wait for a free ring slot. Slots written while no SOURCE is attached
+    // are returned immediately by the node, so this does not block without
+    // readers. Blocked SINKs are woken by the post() of the last reader; the
+    // timeout only serves to reclaim slots held by SOURCEs that died.
+    if (!node_->write_barrier.try_wait()) {
+
+        const int64_t t0 = statsClock();
+        while (!node_->write_barrier.timed_wait(LIVENESS_PERIOD))
+            node_->releaseDeadSlots();
 
-    // Only wait if there is a SOURCE attached to the node
-    // Wait with timed wait with period check to prevent deadlocks
-    while (node_->source_ref_count() > 0 &&
-          !node_->write_barrier.timed_wait(timeout)) {
-        // Loops checking if wait has been released
-        timeout = boost::get_system_time() + msec_t(10);
+        node_->stats.recordSinkWait(statsClock() - t0);
     }
 
+    node_->notifySinkWriteStart();
+
     did_wait_need_post_ = true;
 }
 
@@ -134,6 +205,73 @@ inline void SinkBase<T>::post() {
 #endif
 }
 
+template<typename T>
+inline void SinkBase<T>::cancel() {
+
+#ifndef NDEBUG
+    // Don't use Asserts because it does not clean shmem
+    if(!bound_)
+        throw std::runtime_error("Sink must be bound before calling cancel()");
+    if (!did_wait_need_post_)
+        throw std::runtime_error("cancel() called when wait() was required.");
+#endif
+
+    node_->notifySinkWriteCancelled();
+
+    did_wait_need_post_ = false;
+}
+
+template<typename T>
+inline void SinkBase<T>::set_ring_size(const size_t value) {
+
+    if (bound_)
+        throw std::runtime_error("Ring size must be set before the sink binds.");
+
+    if (value < 1 || value > Node::MAX_RING_SIZE)
+        throw std::runtime_error("Ring size must be between 1 and "
+                                 + std::to_string(Node::MAX_RING_SIZE) + ".");
+
+    ring_size_ = value;
+}
+
+template<typename T>
+inline void SinkBase<T>::set_max_sources(const size_t value) {
+
+    if (bound_)
+        throw std::runtime_error("Maximum number of sources must be set "
+                                 "before the sink binds.");
+
+    if (value < 1 || value > Node::MAX_NUM_SLOTS)
+        throw std::runtime_error("Maximum number of sources must be between 1 and "
+                                 + std::to_string(Node::MAX_NUM_SLOTS) + ".");
+
+    max_sources_ = value;
+}
+
+template<typename T>
+inline void SinkBase<T>::set_page_policy(const uint32_t value) {
+
+    if (bound_)
+        throw std::runtime_error("Page policy must be set before the sink binds.");
+
+    if (value & ~(PAGES_HUGE | PAGES_LOCKED))
+        throw std::runtime_error("Invalid page policy.");
+
+    page_policy_ = value;
+}
+
+template<typename T>
+inline void SinkBase<T>::preparePages() {
+
+    applied_page_policy_ =
+        applyPagePolicy(obj_shmem_.get_address(), obj_shmem_.get_size(),
+                        page_policy_, obj_shmem_.in_process());
+    applyPagePolicy(node_shmem_.get_address(), node_shmem_.get_size(),
+                    applied_page_policy_, node_shmem_.in_process());
+
+    node_->set_page_policy(applied_page_policy_);
+}
+
 // Specializations...
 
 // 0. Generic without need for zero-copy storage
@@ -148,7 +286,13 @@ class Sink : public SinkBase<T> {
     using SinkBase<T>::obj_shmem_;
     using SinkBase<T>::node_;
     using SinkBase<T>::sh_object_;
+    using SinkBase<T>::ring_size_;
+    using SinkBase<T>::max_sources_;
+    using SinkBase<T>::page_policy_;
     using SinkBase<T>::bound_;
+    using SinkBase<T>::write_slot;
+    using SinkBase<T>::preparePages;
+    using SinkBase<T>::registration_;
 
 public:
 
@@ -171,34 +315,46 @@ inline void Sink<T>::bind(const std::string &address, Targs... args) {
     node_address_ = address + "_node";
     obj_address_ = address + "_obj";
 
-    // Define shared memory
-    // Extra 1024 bytes are used to hold managed shared mem helper objects
-    // (name-object index, internal synchronization objects, internal
-    // variables...)
-    node_shmem_ = bip::managed_shared_memory(
-            bip::open_or_create,
-            node_address_.c_str(),
-            1024 + sizeof(Node));
+    // Reclaim the node if the components that last used it died, and
+    // make this SINK known to monitoring tools
+    registration_.template record<T>(RegistryEntry::SINK, address);
 
     // Bind to a node which facilitates synchronized access to shmem
-    node_ = node_shmem_.template find_or_construct<Node>(typeid(Node).name())();
+    node_ = openNode(node_shmem_, node_address_, max_sources_);
 
     // Make sure there is not another SINK using this shmem
     if (node_->sink_state() != NodeState::UNDEFINED) {
 
         // There is already a SINK using this shmem
+        registration_.release();
         throw (std::runtime_error(
                 "Requested SINK address, '" + address + "', is not available."));
+    } else if (node_->num_slots() < max_sources_) {
+
+        // SOURCEs that touch a node before its SINK binds create it with
+        // the default number of slots
+        registration_.release();
+        throw (std::runtime_error(
+                "Node '" + address + "' was created with "
+                + std::to_string(node_->num_slots()) + " SOURCE slots. "
+                "Bind the SINK before starting its SOURCEs to allocate more."));
     } else {
 
-        obj_shmem_ = bip::managed_shared_memory(
+        // Extra 1024 bytes are used to hold managed shared mem helper objects
+        // (name-object index, internal synchronization objects, internal
+        // variables...)
+        obj_shmem_ = shmem_t(
             bip::create_only,
             obj_address_.c_str(),
-            1024 + sizeof (T));
+            pageAlign(1024 + ring_size_ * sizeof (T), page_policy_));
 
-        // Find an existing shared object or construct one
-        sh_object_ = obj_shmem_.template find_or_construct<T>(typeid(T).name())(args...);
+        // Find an existing shared object ring or construct one
+        sh_object_ = obj_shmem_.template
+            find_or_construct<T>(typeid(T).name())[ring_size_](args...);
+        preparePages();
+        node_->set_ring_size(ring_size_);
         node_->set_sink_state(NodeState::SINK_BOUND);
+        registration_.set_sizes(node_shmem_.get_size(), obj_shmem_.get_size());
         bound_ = true;
     }
 }
@@ -212,7 +368,9 @@ inline T * Sink<T>::retrieve() {
         throw (std::runtime_error("SINK must be bound before shared object is retrieved."));
 #endif
 
-    return sh_object_;
+    // With a ring of more than one slot, this must be called between wait()
+    // and post() to get the slot that will be published
+    return sh_object_ + write_slot();
 }
 
 // 1. SharedFrameHeader
@@ -222,7 +380,23 @@ class Sink<SharedFrameHeader> : public SinkBase<SharedFrameHeader> {
 
 public:
     void bind(const std::string &address, const size_t bytes);
-    oat::Frame retrieve(const size_t rows, size_t cols, const int type);
+    oat::Frame retrieve(const size_t rows, size_t cols, const int type,
+                        const PixelFormat format = PixelFormat::BGR);
+
+    /**
+     * Allocate frames of rows x cols, but publish only a region of each.
+     * SOURCEs see the region as a view into the full frame, so a SINK can
+     * capture whole frames straight into shared memory without cropping
+     * them.
+     * @return Full frame for the ring slot that will be published next.
+     */
+    oat::Frame retrieve(const size_t rows, size_t cols, const int type,
+                        const PixelFormat format, const cv::Rect &roi);
+    oat::Frame retrieve(void);
+
+private:
+    std::vector<oat::Frame> frames_;
+    size_t last_slot_ {0};
 };
 
 inline void Sink<SharedFrameHeader>::bind(const std::string &address, const size_t bytes) {
@@ -236,58 +410,122 @@ inline void Sink<SharedFrameHeader>::bind(const std::string &address, const size
     node_address_ = address + "_node";
     obj_address_ = address + "_obj";
 
-    // Define shared memory
-    node_shmem_ = bip::managed_shared_memory(
-            bip::open_or_create,
-            node_address_.c_str(),
-            1024  + sizeof(Node));
+    // Reclaim the node if the components that last used it died, and
+    // make this SINK known to monitoring tools
+    registration_.record<SharedFrameHeader>(RegistryEntry::SINK, address);
 
     // Facilitates synchronized access to shmem
-    node_ = node_shmem_.find_or_construct<Node>(typeid(Node).name())();
+    node_ = openNode(node_shmem_, node_address_, max_sources_);
 
     // Make sure there is not another SINK using this shmem
     if (node_->sink_state() != NodeState::UNDEFINED) {
 
         // There is already a SINK using this shmem
+        registration_.release();
         throw (std::runtime_error(
                 "Requested SINK address, '" + address + "', is not available."));
+    } else if (node_->num_slots() < max_sources_) {
+
+        // SOURCEs that touch a node before its SINK binds create it with
+        // the default number of slots
+        registration_.release();
+        throw (std::runtime_error(
+                "Node '" + address + "' was created with "
+                + std::to_string(node_->num_slots()) + " SOURCE slots. "
+                "Bind the SINK before starting its SOURCEs to allocate more."));
     } else {
 
-        // Object shared memory
-        obj_shmem_ = bip::managed_shared_memory(
+        // Object shared memory. Each ring slot holds a header, matrix data and
+        // a sample, plus allocator book-keeping.
+        obj_shmem_ = shmem_t(
             bip::create_only,
             obj_address_.c_str(),
-            1024 + sizeof(SharedFrameHeader) + bytes + sizeof(uint64_t));
+            pageAlign(1024 + ring_size_ * (sizeof(SharedFrameHeader) + bytes
+                                           + sizeof(oat::Sample) + 128),
+                      page_policy_));
 
-        // Find an existing shared object or construct one
-        sh_object_ = obj_shmem_.find_or_construct<SharedFrameHeader>(typeid(SharedFrameHeader).name())();
+        // Find an existing shared object ring or construct one
+        sh_object_ = obj_shmem_.find_or_construct<SharedFrameHeader>
+            (typeid(SharedFrameHeader).name())[ring_size_]();
+        preparePages();
 
+        node_->set_ring_size(ring_size_);
         node_->set_sink_state(NodeState::SINK_BOUND);
+        registration_.set_sizes(node_shmem_.get_size(), obj_shmem_.get_size());
         bound_ = true;
     }
 }
 
-inline oat::Frame Sink<SharedFrameHeader>::retrieve(const size_t rows, const size_t cols, const int type) {
+inline oat::Frame Sink<SharedFrameHeader>::retrieve(const size_t rows,
+                                                    const size_t cols,
+                                                    const int type,
+                                                    const PixelFormat format) {
+
+    return retrieve(rows, cols, type, format, cv::Rect(0, 0, cols, rows));
+}
+
+inline oat::Frame Sink<SharedFrameHeader>::retrieve(const size_t rows,
+                                                    const size_t cols,
+                                                    const int type,
+                                                    const PixelFormat format,
+                                                    const cv::Rect &roi) {
 
     // Make sure that the SINK is bound to a shared memory segment
     //assert(bound_);
     if (!bound_)
         throw (std::runtime_error("SINK must be bound before shared cvMat is retrieved."));
 
-    // Allocate memory for sample number
-    void * sample = obj_shmem_.allocate(sizeof(oat::Sample));
-    handle_t sample_handle = obj_shmem_.get_handle_from_address(sample);
+    if ((roi & cv::Rect(0, 0, cols, rows)) != roi || roi.area() == 0)
+        throw (std::runtime_error("The published region of a shared frame "
+                                  "must lie within the frame."));
 
-    // Allocate memory for the shared object's data
     cv::Mat temp(rows, cols, type);
-    void * data = obj_shmem_.allocate(temp.total() * temp.elemSize());
-    handle_t data_handle = obj_shmem_.get_handle_from_address(data);
+    const size_t step = temp.step[0];
+    const size_t offset = roi.y * step + roi.x * temp.elemSize();
+    frames_.clear();
+
+    for (size_t i = 0; i < ring_size_; i++) {
+
+        // Allocate memory for sample number
+        void * sample = obj_shmem_.allocate(sizeof(oat::Sample));
+        handle_t sample_handle = obj_shmem_.get_handle_from_address(sample);
+        new (sample) oat::Sample();
+
+        // Allocate memory for the shared object's data
+        void * data = obj_shmem_.allocate(temp.total() * temp.elemSize());
+        handle_t data_handle = obj_shmem_.get_handle_from_address(data);
+
+        oat::Frame frame(rows, cols, type, data, sample, format);
 
-    // Reset the SharedFrameHeader's parameters now that we know what they should be
-    sh_object_->setParameters(data_handle, sample_handle, rows, cols, type);
+        // Reset the SharedFrameHeader's parameters now that we know what they should be
+        sh_object_[i].setParameters(data_handle, sample_handle, roi.height,
+                                    roi.width, type, frame.format(), step,
+                                    offset);
+
+        frames_.push_back(frame);
+    }
+
+    // Return frame header pointing to memory allocated for the slot that will
+    // be published next
+    last_slot_ = write_slot();
+    return frames_[last_slot_];
+}
+
+inline oat::Frame Sink<SharedFrameHeader>::retrieve() {
+
+    if (frames_.empty())
+        throw (std::runtime_error("SINK must allocate shared cvMat before it is retrieved."));
+
+    // Carry the sample forward so that the ring looks like a single shared
+    // frame to the SINK. Called between wait() and post(), so the slot is not
+    // being read.
+    size_t slot = write_slot();
+    if (slot != last_slot_) {
+        frames_[slot].sample() = frames_[last_slot_].sample();
+        last_slot_ = slot;
+    }
 
-    // Return pointer to memory allocated for shared object
-    return oat::Frame(rows, cols, type, data, sample);
+    return frames_[slot];
 }
 
 } // namespace oat
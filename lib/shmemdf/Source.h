@@ -25,13 +25,15 @@
 #include <iostream>
 #include <string>
 #include <sstream>
+#include <vector>
 #include <boost/interprocess/managed_shared_memory.hpp>
-#include <boost/thread/thread_time.hpp>
 
 #include "../datatypes/Frame.h"
 
 #include "ForwardsDecl.h"
 #include "Node.h"
+#include "Pages.h"
+#include "Registry.h"
 #include "SharedFrameHeader.h"
 
 namespace oat {
@@ -45,6 +47,27 @@ enum class SourceState : std::int16_t
     CONNECTED       = 2,
 };
 
+/**
+ * How a SOURCE consumes samples from its node.
+ *
+ * SYNCHRONOUS: The SOURCE holds one of the node's slots and reads every
+ * sample in lockstep with the SINK. The SINK cannot overwrite a sample
+ * until every SYNCHRONOUS SOURCE has read it.
+ *
+ * LATEST: The SOURCE holds no slot and never blocks the SINK. wait() blocks
+ * until there is a sample newer than the last one read, and clone() or
+ * copyTo() copy the newest sample, retrying if the SINK overwrote it during
+ * the copy. Samples may be skipped. Suited to monitoring components that
+ * must not throttle a pipeline. If the SINK fills its object inside a long
+ * critical section (e.g. while waiting on a camera), it should use a ring
+ * size of at least 2 so that the newest sample is not always being rewritten.
+ */
+enum class SourceMode : std::int16_t
+{
+    SYNCHRONOUS     = 0,
+    LATEST          = 1,
+};
+
 //inline std::ostream& operator<< (std::ostream & os, SourceState state) {
 //
 //    switch (state)  {
@@ -67,8 +90,10 @@ public:
     virtual ~SourceBase();
 
     // Node connection
-    void touch(const std::string &address);
+    void touch(const std::string &address,
+               const SourceMode mode = SourceMode::SYNCHRONOUS);
     virtual void connect(void);
+    SourceMode mode(void) const { return mode_; }
 
     // Sychronization
     NodeState wait();
@@ -80,15 +105,34 @@ public:
 
 protected:
 
+    // Index of the ring slot that this SOURCE reads next
+    size_t read_slot(void) const {
+        return node_->read_cursor(slot_index_) % ring_size_;
+    }
+
+    // Block until the SINK has bound the node
+    void waitForSink(void);
+
+    // Apply the SINK's page policy to this SOURCE's mappings
+    void preparePages(void);
+
+    // Copy the newest sample using copy(slot) in SourceMode::LATEST
+    template<typename Copy>
+    auto readLatest(Copy copy) const -> decltype(copy(size_t {0}));
+
     shmem_t node_shmem_, obj_shmem_;
     T * sh_object_ {nullptr};
     Node * node_ {nullptr};
     std::string address_, node_address_, obj_address_;
     size_t slot_index_ {0};
+    size_t ring_size_ {1};
+    SourceMode mode_ {SourceMode::SYNCHRONOUS};
+    mutable uint64_t latest_read_ {0}; //!< Writes completed at last LATEST read
     std::atomic<SourceState> state_ {SourceState::VIRGIN};
     bool touched_ {false};
     bool connected_ {false};
     bool did_wait_need_post_ {false};
+    Registration registration_;
 
 };
 
@@ -103,7 +147,8 @@ inline SourceBase<T>::~SourceBase() {
 
     // If we have touched the node, or there was a node type mismatch, we must
     // release our slot
-    if (state_ >= SourceState::TOUCHED || state_ == SourceState::ERR_TYPEMIS)
+    if (mode_ == SourceMode::SYNCHRONOUS &&
+        (state_ >= SourceState::TOUCHED || state_ == SourceState::ERR_TYPEMIS))
         node_->releaseSlot(slot_index_);
 
     // If the client reference count is 0 and there is no server
@@ -112,8 +157,8 @@ inline SourceBase<T>::~SourceBase() {
         node_->sink_state() != NodeState::SINK_BOUND) {
 
         bool shmem_freed = false;
-        shmem_freed |= bip::shared_memory_object::remove(node_address_.c_str());
-        shmem_freed |= bip::shared_memory_object::remove(obj_address_.c_str());
+        shmem_freed |= shmem_t::remove(node_address_.c_str());
+        shmem_freed |= shmem_t::remove(obj_address_.c_str());
 
 #ifndef NDEBUG
         if (shmem_freed)
@@ -123,7 +168,8 @@ inline SourceBase<T>::~SourceBase() {
 }
 
 template<typename T>
-inline void SourceBase<T>::touch(const std::string &address) {
+inline void SourceBase<T>::touch(const std::string &address,
+                                  const SourceMode mode) {
 
     // Make sure we did not connect already
     if (state_ != SourceState::VIRGIN)
@@ -135,20 +181,19 @@ inline void SourceBase<T>::touch(const std::string &address) {
     node_address_ = address + "_node";
     obj_address_ = address + "_obj";
 
-    // Define shared memory
-    // Extra 1024 bytes are used to hold managed shared mem helper objects
-    // (name-object index, internal synchronization objects, internal
-    // variables...)
-    node_shmem_ = bip::managed_shared_memory(
-            bip::open_or_create,
-            node_address_.c_str(),
-            1024 + sizeof(Node));
+    // Reclaim the node if the components that last used it died, and
+    // make this SOURCE known to monitoring tools
+    registration_.template record<T>(RegistryEntry::SOURCE, address);
 
     // Facilitates synchronized access to shmem
-    node_ = node_shmem_.find_or_construct<Node>(typeid(Node).name())();
+    node_ = openNode(node_shmem_, node_address_, Node::DEFAULT_NUM_SLOTS);
+
+    mode_ = mode;
 
-    // Let the node know this source is attached and retrieve *this's index
-    if (node_->acquireSlot(slot_index_) < 0) {
+    // Let the node know this source is attached and retrieve *this's index.
+    // LATEST sources are invisible to the node.
+    if (mode_ == SourceMode::SYNCHRONOUS && node_->acquireSlot(slot_index_) < 0) {
+        registration_.release();
         state_ = SourceState::ERR_NODEFULL;
         return;
     }
@@ -166,21 +211,14 @@ inline void SourceBase<T>::connect() {
                                  "touch()ed a node.");
 
     // Wait for the SINK to bind and construct the shared object
-    if (node_->sink_state() != NodeState::SINK_BOUND) {
-        wait();
-
-        // Self post since all loops start with wait() and we just
-        // finished our wait(). This will make the first call to
-        // wait() a 'freebie'
-        node_->read_barrier(slot_index_).post();
-        did_wait_need_post_ = false;
-    }
+    waitForSink();
 
     // Find an existing shared object constructed by the SINK
     obj_shmem_ =
-            bip::managed_shared_memory(bip::open_only, obj_address_.c_str());
+            shmem_t(bip::open_only, obj_address_.c_str());
     std::pair<T *,std::size_t> temp = obj_shmem_.find<T>(typeid(T).name());
     sh_object_ = temp.first;
+    ring_size_ = temp.second;
 
     // Only occurs when the name of the shared object does not match typeid(T).name()
     if (sh_object_ == nullptr) {
@@ -188,9 +226,79 @@ inline void SourceBase<T>::connect() {
         throw std::runtime_error("Type mismatch: Source<T> can only connect to Node<T>.");
     }
 
+    preparePages();
+    registration_.set_sizes(node_shmem_.get_size(), obj_shmem_.get_size());
+
     state_ = SourceState::CONNECTED;
 }
 
+template<typename T>
+inline void SourceBase<T>::waitForSink() {
+
+    if (node_->sink_state() == NodeState::SINK_BOUND)
+        return;
+
+    if (mode_ == SourceMode::LATEST) {
+
+        // The node wakes LATEST sources when the SINK state changes
+        SeqLock &seq = node_->write_sequence;
+        for (;;) {
+            uint32_t key = seq.prepareWait();
+            if (node_->sink_state() == NodeState::SINK_BOUND)
+                break;
+            seq.wait(key, LIVENESS_PERIOD);
+        }
+
+        return;
+    }
+
+    wait();
+
+    // Self post since all loops start with wait() and we just
+    // finished our wait(). This will make the first call to
+    // wait() a 'freebie'
+    node_->read_barrier(slot_index_).post();
+    did_wait_need_post_ = false;
+}
+
+template<typename T>
+inline void SourceBase<T>::preparePages() {
+
+    const uint32_t policy = node_->page_policy();
+    applyPagePolicy(obj_shmem_.get_address(), obj_shmem_.get_size(), policy,
+                    obj_shmem_.in_process());
+    applyPagePolicy(node_shmem_.get_address(), node_shmem_.get_size(), policy,
+                    node_shmem_.in_process());
+}
+
+template<typename T>
+template<typename Copy>
+inline auto SourceBase<T>::readLatest(Copy copy) const
+    -> decltype(copy(size_t {0})) {
+
+    SeqLock &seq = node_->write_sequence;
+
+    for (;;) {
+
+        const uint64_t n = seq.completed();
+        decltype(copy(size_t {0})) value = copy(n == 0 ? 0 : (n - 1) % ring_size_);
+
+        // Accept the copy if the SINK did not start rewriting its slot during
+        // the copy, or if there is no SINK left to finish the rewrite
+        if (seq.validate(n, ring_size_)
+            || node_->sink_state() != NodeState::SINK_BOUND) {
+            latest_read_ = n;
+            return value;
+        }
+
+        // The SINK is rewriting the slot. Sleep until it is done instead of
+        // spinning.
+        uint32_t key = seq.prepareWait();
+        if (seq.completed() == n)
+            seq.wait(key, LIVENESS_PERIOD);
+    }
+}
+
 template<typename T>
 inline NodeState SourceBase<T>::wait() {
 
@@ -202,18 +310,51 @@ inline NodeState SourceBase<T>::wait() {
         throw std::runtime_error("wait() called when post() was required.");
 #endif
 
-    boost::system_time timeout = boost::get_system_time() + msec_t(10);
+    if (mode_ == SourceMode::LATEST) {
+
+        // Sleep until there is a sample newer than the last one read
+        SeqLock &seq = node_->write_sequence;
+        for (;;) {
+
+            uint32_t key = seq.prepareWait();
+
+            if (seq.completed() > latest_read_
+                || node_->sink_state() == NodeState::END)
+                break;
 
-    // Only wait if there is a SOURCE attached to the node
-    // Wait with timed wait with period check to prevent deadlocks
-    while (!node_->read_barrier(slot_index_).timed_wait(timeout)) {
+            if (!node_->sinkAlive()) {
+                node_->set_sink_state(NodeState::END);
+                break;
+            }
 
-        // Loops checking if wait has been released
-        timeout = boost::get_system_time() + msec_t(10);
+            seq.wait(key, LIVENESS_PERIOD);
+        }
 
-        // If the sink has left the room, we should too
-        if (node_->sink_state() == NodeState::END)
-            break;
+        latest_read_ = seq.completed();
+        did_wait_need_post_ = true;
+
+        return node_->sink_state();
+    }
+
+    // Blocked SOURCEs are woken by the SINK's post() or by the SINK leaving
+    // the node. The timeout only serves to detect a SINK that died.
+    auto &barrier = node_->read_barrier(slot_index_);
+    if (!barrier.try_wait()) {
+
+        const int64_t t0 = statsClock();
+        while (!barrier.timed_wait(LIVENESS_PERIOD)) {
+
+            // If the sink has left the room, we should too
+            if (node_->sink_state() == NodeState::END)
+                break;
+
+            if (!node_->sinkAlive()) {
+                node_->set_sink_state(NodeState::END);
+                break;
+            }
+        }
+
+        node_->recordSourceWait(slot_index_, statsClock() - t0);
     }
 
     did_wait_need_post_ = true;
@@ -232,7 +373,9 @@ inline void SourceBase<T>::post() {
         throw std::runtime_error("post() called when wait() was required.");
 #endif
 
-    if (node_->notifySourceReadComplete(slot_index_))
+    // LATEST sources do not hold up the SINK, so there is nothing to release
+    if (mode_ == SourceMode::SYNCHRONOUS
+        && node_->notifySourceReadComplete(slot_index_))
         node_->write_barrier.post();
 
     did_wait_need_post_ = false;
@@ -246,6 +389,9 @@ class Source : public SourceBase<T> {
     using SourceBase<T>::sh_object_;
     using SourceBase<T>::connected_;
     using SourceBase<T>::state_;
+    using SourceBase<T>::read_slot;
+    using SourceBase<T>::readLatest;
+    using SourceBase<T>::mode_;
 
 public:
     T * retrieve();
@@ -261,7 +407,11 @@ inline T * Source<T>::retrieve() {
         throw (std::runtime_error("Source must be connected before shared object is retrieved."));
 #endif
 
-    return sh_object_;
+    if (mode_ == SourceMode::LATEST)
+        throw (std::runtime_error("A LATEST source can be overwritten while "
+                                  "it is read. Use clone()."));
+
+    return sh_object_ + read_slot();
 }
 
 template<typename T>
@@ -273,7 +423,10 @@ inline T  Source<T>::clone() const {
         throw (std::runtime_error("Source must be connected before shared object is cloned."));
 #endif
 
-    return *sh_object_;
+    if (mode_ == SourceMode::LATEST)
+        return readLatest([this](size_t slot) { return T(sh_object_[slot]); });
+
+    return *(sh_object_ + read_slot());
 }
 
 // 1. SharedFrameHeader
@@ -288,18 +441,96 @@ public:
         size_t rows  {0};
         size_t type  {0};
         size_t bytes {0};
+        PixelFormat format {PixelFormat::BGR};
+    };
+
+    /**
+     * Read-only, zero-copy view of the frame this SOURCE is reading. The
+     * frame refers directly to shared memory, and the SINK cannot overwrite
+     * it until the lease is released. Destroying the lease releases it,
+     * which is equivalent to calling post(). Obtain one with lease() after
+     * wait().
+     */
+    class Lease {
+
+        friend class Source<SharedFrameHeader>;
+
+    public:
+
+        Lease(Lease &&other) noexcept :
+          source_(other.source_)
+        , frame_(other.frame_)
+        {
+            other.source_ = nullptr;
+        }
+
+        Lease & operator=(Lease &&other) noexcept {
+            if (this != &other) {
+                release();
+                source_ = other.source_;
+                frame_ = other.frame_;
+                other.source_ = nullptr;
+            }
+            return *this;
+        }
+
+        // Leases are not copyable
+        Lease(const Lease &) = delete;
+        Lease & operator=(const Lease &) = delete;
+
+        ~Lease() { release(); }
+
+        /**
+         * @return Shared frame. Must not be written to or used after the
+         * lease is released. Make a private copy to keep it longer.
+         */
+        const oat::Frame & frame(void) const { return frame_; }
+
+        /**
+         * Allow the SINK to overwrite the frame.
+         */
+        void release(void) {
+            if (source_ != nullptr) {
+                source_->leased_ = false;
+                source_->post();
+                source_ = nullptr;
+            }
+        }
+
+        bool held(void) const { return source_ != nullptr; }
+
+    private:
+
+        Lease(Source<SharedFrameHeader> *source, const oat::Frame &frame) :
+          source_(source)
+        , frame_(frame)
+        {
+            // Nothing
+        }
+
+        Source<SharedFrameHeader> *source_;
+        oat::Frame frame_;
     };
 
     void connect() override;
 
-    oat::Frame retrieve() const { return frame_; }
-    oat::Frame clone() const { return frame_.clone(); }
-    void copyTo(oat::Frame &frame) const { frame_.copyTo(frame); };
+    /**
+     * Lease the frame obtained by the last wait() instead of copying it. The
+     * lease takes over the post() for that wait().
+     * @return Lease on the shared frame.
+     */
+    Lease lease();
+
+    // Frame header for the ring slot this SOURCE reads next
+    oat::Frame retrieve() const;
+    oat::Frame clone() const;
+    void copyTo(oat::Frame &frame) const;
     ConnectionParameters parameters() const { return parameters_; }
 
 private :
-    oat::Frame frame_;
+    std::vector<oat::Frame> frames_;
     ConnectionParameters parameters_;
+    bool leased_ {false};
 };
 
 inline void Source<SharedFrameHeader>::connect() {
@@ -311,23 +542,15 @@ inline void Source<SharedFrameHeader>::connect() {
 
     // Wait for the SINK to bind the node and provide matrix
     // header info.
-    if (node_->sink_state() != NodeState::SINK_BOUND) {
-
-        wait();
-
-        // Self post since all loops start with wait() and we just
-        // finished our wait(). This will make the first call to
-        // wait() a 'freebie'
-        node_->read_barrier(slot_index_).post();
-        did_wait_need_post_ = false;
-    }
+    waitForSink();
 
     // Find an existing shared object constructed by the SINK
     obj_shmem_ =
-            bip::managed_shared_memory(bip::open_only, obj_address_.c_str());
+            shmem_t(bip::open_only, obj_address_.c_str());
     std::pair<SharedFrameHeader *, std::size_t> temp =
             obj_shmem_.find<SharedFrameHeader>(typeid(SharedFrameHeader).name());
     sh_object_ = temp.first;
+    ring_size_ = temp.second;
 
     // Only occurs when the name of the shared object does not match typeid(T).name()
     if (sh_object_ == nullptr) {
@@ -335,21 +558,79 @@ inline void Source<SharedFrameHeader>::connect() {
         throw std::runtime_error("Type mismatch: Source<T> can only connect to Node<T>.");
     }
 
-    // Generate frame header using info in shmem segment
-    frame_ = oat::Frame(sh_object_->rows(),
-                        sh_object_->cols(),
-                        sh_object_->type(),
-                        obj_shmem_.get_address_from_handle(sh_object_->data()),
-                        obj_shmem_.get_address_from_handle(sh_object_->sample()));
+    // Generate a frame header for each ring slot using info in shmem
+    // segment. A SINK may publish a region of a larger frame, which is
+    // viewed in place.
+    frames_.clear();
+    for (size_t i = 0; i < ring_size_; i++) {
+        const SharedFrameHeader &h = sh_object_[i];
+        char *data =
+            static_cast<char *>(obj_shmem_.get_address_from_handle(h.data()));
+        frames_.push_back(
+            oat::Frame(h.rows(),
+                       h.cols(),
+                       h.type(),
+                       data + h.offset(),
+                       obj_shmem_.get_address_from_handle(h.sample()),
+                       h.format(),
+                       h.step()));
+    }
 
     // Save parameters so that to construct cv::Mats with
     parameters_.cols = sh_object_->cols();
     parameters_.rows = sh_object_->rows();
     parameters_.type = sh_object_->type();
-    parameters_.bytes = frame_.total() * frame_.elemSize();
+    parameters_.bytes = frames_[0].total() * frames_[0].elemSize();
+    parameters_.format = frames_[0].format();
+
+    preparePages();
+    registration_.set_sizes(node_shmem_.get_size(), obj_shmem_.get_size());
 
     state_ = SourceState::CONNECTED;
 }
 
+inline oat::Frame Source<SharedFrameHeader>::retrieve() const {
+
+    if (mode_ == SourceMode::LATEST)
+        throw (std::runtime_error("A LATEST source can be overwritten while "
+                                  "it is read. Use clone() or copyTo()."));
+
+    return frames_[read_slot()];
+}
+
+inline Source<SharedFrameHeader>::Lease Source<SharedFrameHeader>::lease() {
+
+    if (!did_wait_need_post_ || leased_)
+        throw (std::runtime_error("A frame can only be leased once per wait()."));
+
+    if (mode_ == SourceMode::LATEST)
+        throw (std::runtime_error("A LATEST source can be overwritten while "
+                                  "it is read. Use clone() or copyTo()."));
+
+    leased_ = true;
+    return Lease(this, frames_[read_slot()]);
+}
+
+inline oat::Frame Source<SharedFrameHeader>::clone() const {
+
+    if (mode_ == SourceMode::LATEST)
+        return readLatest([this](size_t slot) { return frames_[slot].clone(); });
+
+    return frames_[read_slot()].clone();
+}
+
+inline void Source<SharedFrameHeader>::copyTo(oat::Frame &frame) const {
+
+    if (mode_ == SourceMode::LATEST) {
+        readLatest([this, &frame](size_t slot) -> oat::Frame & {
+            frames_[slot].copyTo(frame);
+            return frame;
+        });
+        return;
+    }
+
+    frames_[read_slot()].copyTo(frame);
+}
+
 }      /* namespace oat */
 #endif /* OAT_SOURCE_H */
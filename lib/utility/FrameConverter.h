@@ -0,0 +1,214 @@
+//******************************************************************************
+//* File:   FrameConverter.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_FRAMECONVERTER_H
+#define	OAT_FRAMECONVERTER_H
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "../datatypes/Frame.h"
+#include "../datatypes/PixelFormat.h"
+
+namespace oat {
+
+/**
+ * Convert a frame to another pixel format and/or bit depth. Depth changes
+ * scale 16 bit values by 1/256 (and 8 bit values by 256), i.e. 16 bit data
+ * is taken to be MSB aligned.
+ * @param in Frame to convert.
+ * @param from Pixel format of in.
+ * @param out Converted frame. Written in place if it already has the right
+ * size and type.
+ * @param to Pixel format of out. Must be BGR or GREY unless it is from.
+ * @param depth Depth of out (CV_8U or CV_16U), or -1 for the depth of in.
+ * @param scratch Intermediate buffer used when both the format and the
+ * depth change.
+ */
+inline void convertFrame(const cv::Mat &in, const PixelFormat from,
+                         cv::Mat &out, const PixelFormat to, int depth,
+                         cv::Mat &scratch) {
+
+    if (depth < 0)
+        depth = in.depth();
+
+    const double scale = depth == in.depth() ? 1.0 :
+                         depth == CV_8U ? 1.0 / 256.0 : 256.0;
+
+    int code {-1};
+    if (from != to) {
+
+        if (isBayer(to))
+            throw (std::runtime_error("Frames cannot be converted to a "
+                                      "Bayer mosaic."));
+
+        const bool bgr = to == PixelFormat::BGR;
+        switch (from) {
+            case PixelFormat::BGR:
+                code = cv::COLOR_BGR2GRAY;
+                break;
+            case PixelFormat::GREY:
+                code = cv::COLOR_GRAY2BGR;
+                break;
+            case PixelFormat::BAYER_RGGB:
+                code = bgr ? cv::COLOR_BayerBG2BGR : cv::COLOR_BayerBG2GRAY;
+                break;
+            case PixelFormat::BAYER_GRBG:
+                code = bgr ? cv::COLOR_BayerGB2BGR : cv::COLOR_BayerGB2GRAY;
+                break;
+            case PixelFormat::BAYER_GBRG:
+                code = bgr ? cv::COLOR_BayerGR2BGR : cv::COLOR_BayerGR2GRAY;
+                break;
+            case PixelFormat::BAYER_BGGR:
+                code = bgr ? cv::COLOR_BayerRG2BGR : cv::COLOR_BayerRG2GRAY;
+                break;
+        }
+    }
+
+    if (code < 0) {
+        in.convertTo(out, depth, scale);
+    } else if (depth == in.depth()) {
+        cv::cvtColor(in, out, code);
+    } else if (in.channels() == 1) {
+
+        // Change the depth while there is only one channel to scale
+        in.convertTo(scratch, depth, scale);
+        cv::cvtColor(scratch, out, code);
+    } else {
+        cv::cvtColor(in, scratch, code);
+        scratch.convertTo(out, depth, scale);
+    }
+}
+
+/**
+ * Provides frames in the pixel format and depth a component works with,
+ * e.g. demosaiced BGR from a SOURCE that publishes raw Bayer frames.
+ * Conversions are cached per sample. FrameConverters of the same node
+ * address share their cache, so several components reading a node in one
+ * process (see oat-pipeline) convert each sample only once.
+ */
+class FrameConverter {
+
+public:
+
+    /**
+     * @param address Address of the node that converted frames are read
+     * from. Converters with an empty address do not share conversions.
+     */
+    explicit FrameConverter(const std::string &address = "") :
+      address_(address)
+    {
+        // Nothing
+    }
+
+    void set_address(const std::string &address) {
+        address_ = address;
+        entries_.clear();
+    }
+
+    /**
+     * @param frame Frame to convert.
+     * @param to Pixel format to provide. BGR or GREY unless it is the
+     * frame's own format.
+     * @param depth Depth to provide (CV_8U or CV_16U), or -1 for the frame's
+     * depth.
+     * @return frame itself, without a copy, if it already has the requested
+     * format and depth. Otherwise, its conversion. Must not be modified.
+     * Valid until the next sample is converted.
+     */
+    cv::Mat convert(const oat::Frame &frame, const PixelFormat to,
+                    const int depth = -1) {
+
+        const PixelFormat from = frame.format();
+        if (from == to && (depth < 0 || depth == frame.depth()))
+            return frame;
+
+        Entry &e = entry(to, depth);
+        std::lock_guard<std::mutex> lock(e.mutex);
+
+        const uint64_t count = frame.sample().count();
+        if (!e.valid || e.count != count) {
+
+            // Convert into a new buffer if a reader still holds the last
+            // conversion. Readers release their copies without the entry
+            // lock, so the count is read atomically.
+            if (e.frame.u != nullptr && CV_XADD(&e.frame.u->refcount, 0) > 1)
+                e.frame.release();
+
+            convertFrame(frame, from, e.frame, to, depth, e.scratch);
+            e.count = count;
+            e.valid = true;
+        }
+
+        return e.frame;
+    }
+
+private:
+
+    struct Entry {
+        std::mutex mutex;
+        bool valid {false};
+        uint64_t count {0};
+        cv::Mat frame;
+        cv::Mat scratch;
+    };
+
+    using Key = std::tuple<PixelFormat, int>;
+
+    std::string address_;
+    std::map<Key, std::shared_ptr<Entry>> entries_;
+
+    Entry & entry(const PixelFormat to, const int depth) {
+
+        const Key key {to, depth};
+        auto it = entries_.find(key);
+        if (it != entries_.end())
+            return *it->second;
+
+        std::shared_ptr<Entry> e;
+        if (address_.empty()) {
+            e = std::make_shared<Entry>();
+        } else {
+
+            // Process wide conversions of each node
+            static std::mutex shared_mutex;
+            static std::map<std::tuple<std::string, PixelFormat, int>,
+                            std::shared_ptr<Entry>> shared;
+
+            std::lock_guard<std::mutex> lock(shared_mutex);
+            auto &s = shared[std::make_tuple(address_, to, depth)];
+            if (!s)
+                s = std::make_shared<Entry>();
+            e = s;
+        }
+
+        entries_[key] = e;
+        return *e;
+    }
+};
+
+}      /* namespace oat */
+#endif /* OAT_FRAMECONVERTER_H */
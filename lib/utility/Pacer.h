@@ -0,0 +1,138 @@
+//******************************************************************************
+//* File:   Pacer.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_PACER_H
+#define	OAT_PACER_H
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+namespace oat {
+
+/**
+ * Paces a loop at a fixed rate. Deadline n is start + n / rate on a
+ * monotonic clock, so neither the time spent in the loop nor rounding of
+ * the period accumulates into drift. The last part of each wait can be
+ * spent spinning instead of sleeping, to avoid the scheduler's wake-up
+ * latency at high rates. A caller that falls more than one period behind
+ * restarts the schedule from the current time instead of bursting to catch
+ * up.
+ */
+class Pacer {
+
+public:
+
+    using Clock = std::chrono::steady_clock;
+
+    Pacer()
+    {
+        // Nothing
+    }
+
+    /**
+     * @param rate_hz Loop rate in Hz. 0 or less disables pacing.
+     */
+    explicit Pacer(const double rate_hz)
+    {
+        set_rate_hz(rate_hz);
+    }
+
+    /**
+     * Set the loop rate. Restarts the schedule.
+     * @param rate_hz Loop rate in Hz. 0 or less disables pacing.
+     */
+    void set_rate_hz(const double rate_hz) {
+        period_sec_ = rate_hz > 0 ? 1.0 / rate_hz : 0.0;
+        started_ = false;
+    }
+
+    /**
+     * Set the time before each deadline that is spent spinning instead of
+     * sleeping.
+     * @param spin Spin time. Zero sleeps until the deadline.
+     */
+    void set_spin(const Clock::duration spin) { spin_ = spin; }
+
+    bool enabled(void) const { return period_sec_ > 0; }
+    double period_sec(void) const { return period_sec_; }
+
+    // Number of times the schedule was restarted because the caller fell
+    // behind
+    uint64_t slips(void) const { return slips_; }
+
+    /**
+     * Start the schedule. The first deadline is one period from now. Called
+     * by the first wait() if it has not been called before.
+     */
+    void start(void) {
+        start_ = Clock::now();
+        n_ = 0;
+        started_ = true;
+    }
+
+    /**
+     * Wait for the next deadline.
+     * @return Nanoseconds from the deadline to the return of this call,
+     * i.e. how late the caller is. 0 if pacing is disabled.
+     */
+    int64_t wait(void) {
+
+        if (!enabled())
+            return 0;
+
+        if (!started_)
+            start();
+
+        const Clock::time_point deadline = start_ +
+            std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(++n_ * period_sec_));
+
+        if (spin_ > Clock::duration::zero()) {
+            std::this_thread::sleep_until(deadline - spin_);
+            while (Clock::now() < deadline) { }
+        } else {
+            std::this_thread::sleep_until(deadline);
+        }
+
+        const Clock::time_point now = Clock::now();
+        const Clock::duration late = now - deadline;
+
+        // Restart the schedule rather than catch up after a stall
+        if (late > std::chrono::duration<double>(period_sec_)) {
+            start_ = now;
+            n_ = 0;
+            slips_++;
+        }
+
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(late).count();
+    }
+
+private:
+
+    double period_sec_ {0.0};
+    Clock::duration spin_ {Clock::duration::zero()};
+    bool started_ {false};
+    Clock::time_point start_;
+    uint64_t n_ {0};
+    uint64_t slips_ {0};
+};
+
+}      /* namespace oat */
+#endif /* OAT_PACER_H */
@@ -0,0 +1,87 @@
+//******************************************************************************
+//* File:   Bridge.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_BRIDGE_H
+#define	OAT_BRIDGE_H
+
+#include <string>
+
+#include "Link.h"
+
+namespace oat {
+
+/**
+ * Abstract bridge. One half of a connection that carries the samples of a
+ * node between hosts.
+ */
+class Bridge {
+
+public:
+
+    /**
+     * Abstract bridge.
+     *
+     * All concrete bridges implement this ABC.
+     * @param name Component name
+     * @param endpoint Network endpoint, '<transport>://<host>:<port>'
+     */
+    Bridge(const std::string &name, const std::string &endpoint) :
+      name_(name)
+    , link_(endpoint)
+    {
+        // Nothing
+    }
+
+    virtual ~Bridge() { }
+
+    /**
+     * Bridges must be able to connect to a node in shared memory and to the
+     * other half of the bridge.
+     */
+    virtual void connectToNode(void) = 0;
+
+    /**
+     * Move one sample across the bridge.
+     * @return End-of-stream signal. If true, this component should exit.
+     */
+    virtual bool process(void) = 0;
+
+    // Bridges must be configurable via file
+    virtual void configure(const std::string &file_name, const std::string &key) = 0;
+
+    /**
+     * Wake the bridge if it is blocked on the network. Safe to call from a
+     * signal handler.
+     */
+    void interrupt(void) noexcept { link_.interrupt(); }
+
+    // Accessors
+    std::string name(void) const { return name_; }
+
+protected:
+
+    // Bridge name
+    const std::string name_;
+
+    // Connection to the other half of the bridge
+    bridge::Link link_;
+};
+
+}      /* namespace oat */
+#endif /* OAT_BRIDGE_H */
@@ -0,0 +1,271 @@
+//******************************************************************************
+//* File:   BridgeReceiver.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_BRIDGERECEIVER_H
+#define	OAT_BRIDGERECEIVER_H
+
+#include <cmath>
+#include <string>
+#include <vector>
+#include <cpptoml.h>
+#include <opencv2/imgcodecs.hpp>
+
+#include "../../lib/datatypes/Frame.h"
+#include "../../lib/datatypes/Position2D.h"
+#include "../../lib/shmemdf/Sink.h"
+#include "../../lib/shmemdf/SharedFrameHeader.h"
+#include "../../lib/utility/IOFormat.h"
+#include "../../lib/utility/OatTOMLSanitize.h"
+
+#include "Bridge.h"
+
+namespace oat {
+
+/**
+ * Receiving half of a bridge. Publishes the samples sent by a BridgeSender
+ * to a SINK. The type of the SINK is taken from the first message received,
+ * and its address defaults to the address of the node being sent.
+ */
+class BridgeReceiver : public Bridge {
+
+public:
+
+    /**
+     * Bind to the endpoint. The BridgeSender can connect as soon as this
+     * returns.
+     * @param endpoint Endpoint to receive samples on
+     * @param sink_address SINK node address. If empty, the address of the
+     * node being sent is used.
+     */
+    explicit BridgeReceiver(const std::string &endpoint,
+                            const std::string &sink_address = "") :
+      Bridge("bridge[" + endpoint + "->"
+             + (sink_address.empty() ? "*" : sink_address) + "]", endpoint)
+    , sink_address_(sink_address)
+    {
+        link_.listen();
+    }
+
+    void configure(const std::string &config_file,
+                   const std::string &config_key) override {
+
+        // Available options
+        std::vector<std::string> options {"ring-size"};
+
+        // This will throw cpptoml::parse_exception if a file
+        // with invalid TOML is provided
+        auto config = cpptoml::parse_file(config_file);
+
+        // See if a configuration was provided
+        if (config->contains(config_key)) {
+
+            // Get this components configuration table
+            auto this_config = config->get_table(config_key);
+
+            // Check for unknown options in the table and throw if you find them
+            oat::config::checkKeys(options, this_config);
+
+            // Set the number of shared sample slots
+            int64_t ring_size;
+            if (oat::config::getValue(this_config, "ring-size", ring_size, (int64_t)1)) {
+                frame_sink_.set_ring_size(ring_size);
+                position_sink_.set_ring_size(ring_size);
+            }
+
+        } else {
+            throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
+        }
+    }
+
+    /**
+     * Wait for the BridgeSender to connect and send its first sample, then
+     * bind a SINK of the matching type.
+     */
+    void connectToNode(void) override {
+
+        link_.accept();
+
+        if (!link_.receiveHeader(header_) || header_.kind == bridge::END) {
+            pending_ = false;
+            return;
+        }
+
+        if (sink_address_.empty())
+            sink_address_ = header_.address_string();
+
+        if (header_.kind == bridge::FRAME) {
+
+            // Geometry was validated by MessageHeader::check()
+            frame_sink_.bind(sink_address_, header_.frame_bytes());
+            shared_frame_ = frame_sink_.retrieve(
+                header_.rows, header_.cols, header_.type,
+                static_cast<oat::PixelFormat>(header_.format));
+
+        } else if (header_.kind == bridge::POSITION2D) {
+
+            position_sink_.bind(sink_address_, sink_address_);
+            shared_position_ = position_sink_.retrieve();
+
+        } else {
+            throw (std::runtime_error("Received a sample of unknown type."));
+        }
+
+        kind_ = header_.kind;
+        pending_ = true;
+    }
+
+    bool process(void) override {
+
+        // The first header was received by connectToNode()
+        if (!pending_ && !link_.receiveHeader(header_))
+            return true;
+        pending_ = false;
+
+        if (header_.kind == bridge::END)
+            return true;
+
+        if (header_.kind != kind_) {
+            link_.skipPayload(header_.payload_bytes);
+            throw (std::runtime_error("Received a sample whose type does not "
+                                      "match the SINK."));
+        }
+
+        // Samples the sender did not send, or that were lost in transit
+        if (received_ > 0 && header_.count > last_count_ + 1)
+            missed_ += header_.count - last_count_ - 1;
+        last_count_ = header_.count;
+        received_++;
+
+        // Sample information is kept here, since only the SINK may
+        // increment it
+        if (std::isfinite(header_.rate_hz) && header_.rate_hz > 0)
+            sample_.set_rate_hz(header_.rate_hz);
+        sample_.incrementCount(oat::Sample::Microseconds(header_.usec));
+
+        if (kind_ == bridge::FRAME)
+            publishFrame();
+        else
+            publishPosition();
+
+        // Sender was not at END state
+        return false;
+    }
+
+    /**
+     * @return Port the receiver is bound to.
+     */
+    unsigned short port(void) const { return link_.local_port(); }
+
+    // Samples that the sending half skipped or that were lost in transit
+    uint64_t missed(void) const { return missed_; }
+
+private:
+
+    void publishFrame(void) {
+
+        if (header_.rows != shared_frame_.rows
+            || header_.cols != shared_frame_.cols
+            || header_.type != shared_frame_.type())
+            throw (std::runtime_error("Frame parameters changed during the stream."));
+
+        const size_t bytes = shared_frame_.total() * shared_frame_.elemSize();
+
+        // Compressed frames are received and decoded before the SINK waits
+        cv::Mat decoded;
+        if (header_.encoding != bridge::RAW) {
+            encoded_.resize(header_.payload_bytes);
+            link_.receivePayload(encoded_.data(), encoded_.size());
+            decoded = cv::imdecode(encoded_, cv::IMREAD_UNCHANGED);
+            if (decoded.rows != shared_frame_.rows
+                || decoded.cols != shared_frame_.cols
+                || decoded.type() != shared_frame_.type())
+                throw (std::runtime_error("Received a frame that could not be decoded."));
+        } else if (header_.payload_bytes != bytes) {
+            throw (std::runtime_error("Received a frame of the wrong size."));
+        }
+
+        // START CRITICAL SECTION //
+        ////////////////////////////
+
+        // Wait for sources to read
+        frame_sink_.wait();
+        shared_frame_ = frame_sink_.retrieve();
+
+        // Raw frames are received straight into shared memory
+        if (header_.encoding == bridge::RAW)
+            link_.receivePayload(shared_frame_.data, bytes);
+        else
+            decoded.copyTo(shared_frame_);
+
+        shared_frame_.sample() = sample_;
+
+        // Tell sources there is new data
+        frame_sink_.post();
+
+        ////////////////////////////
+        //  END CRITICAL SECTION  //
+    }
+
+    void publishPosition(void) {
+
+        if (header_.payload_bytes != sizeof(bridge::PositionMessage))
+            throw (std::runtime_error("Received a position of the wrong size."));
+
+        bridge::PositionMessage m;
+        link_.receivePayload(&m, sizeof(m));
+
+        // START CRITICAL SECTION //
+        ////////////////////////////
+
+        // Wait for sources to read
+        position_sink_.wait();
+        shared_position_ = position_sink_.retrieve();
+
+        bridge::unpack(m, *shared_position_);
+        shared_position_->sample() = sample_;
+
+        // Tell sources there is new data
+        position_sink_.post();
+
+        ////////////////////////////
+        //  END CRITICAL SECTION  //
+    }
+
+    // The header of the message being received
+    bridge::MessageHeader header_;
+    bool pending_ {false};
+    uint16_t kind_ {bridge::END};
+
+    // Sample keeping
+    oat::Sample sample_;
+    uint64_t received_ {0};
+    uint64_t last_count_ {0};
+    uint64_t missed_ {0};
+
+    // Sink
+    std::string sink_address_;
+    oat::Sink<oat::SharedFrameHeader> frame_sink_;
+    oat::Frame shared_frame_;
+    std::vector<uchar> encoded_;
+    oat::Sink<oat::Position2D> position_sink_;
+    oat::Position2D *shared_position_ {nullptr};
+};
+
+}      /* namespace oat */
+#endif /* OAT_BRIDGERECEIVER_H */
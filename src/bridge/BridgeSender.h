@@ -0,0 +1,467 @@
+//******************************************************************************
+//* File:   BridgeSender.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_BRIDGESENDER_H
+#define	OAT_BRIDGESENDER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cpptoml.h>
+#include <opencv2/imgcodecs.hpp>
+
+#include "../../lib/datatypes/Frame.h"
+#include "../../lib/datatypes/Position2D.h"
+#include "../../lib/shmemdf/Source.h"
+#include "../../lib/shmemdf/SharedFrameHeader.h"
+#include "../../lib/utility/IOFormat.h"
+#include "../../lib/utility/OatTOMLSanitize.h"
+
+#include "Bridge.h"
+
+namespace oat {
+
+/**
+ * Sending half of a bridge. Reads samples from a SOURCE and sends them to a
+ * BridgeReceiver.
+ *
+ * By default, each sample is sent while the SOURCE holds it, so frames go
+ * from shared memory to the socket without a copy and a slow network holds
+ * up the node like any other slow SOURCE. With a queue depth above zero,
+ * samples are copied into a bounded queue that a separate thread sends.
+ * When the queue is full, the oldest sample is dropped, so the node is
+ * never held up by the network.
+ */
+template <typename T>
+class BridgeSender : public Bridge {
+
+public:
+
+    /**
+     * @param source_address SOURCE node address
+     * @param endpoint Endpoint of the BridgeReceiver
+     */
+    BridgeSender(const std::string &source_address,
+                 const std::string &endpoint) :
+      Bridge("bridge[" + source_address + "->" + endpoint + "]", endpoint)
+    , source_address_(source_address)
+    {
+        // Nothing
+    }
+
+    ~BridgeSender() { stopSending(); }
+
+    void configure(const std::string &config_file,
+                   const std::string &config_key) override {
+
+        // Available options
+        std::vector<std::string> options {"queue", "compress", "quality"};
+
+        // This will throw cpptoml::parse_exception if a file
+        // with invalid TOML is provided
+        auto config = cpptoml::parse_file(config_file);
+
+        // See if a configuration was provided
+        if (config->contains(config_key)) {
+
+            // Get this components configuration table
+            auto this_config = config->get_table(config_key);
+
+            // Check for unknown options in the table and throw if you find them
+            oat::config::checkKeys(options, this_config);
+
+            int64_t queue;
+            if (oat::config::getValue(this_config, "queue", queue, (int64_t)0))
+                set_queue_depth(queue);
+
+            std::string compress;
+            if (oat::config::getValue(this_config, "compress", compress)) {
+                if (compress == "none")
+                    encoding_ = bridge::RAW;
+                else if (compress == "png")
+                    encoding_ = bridge::PNG;
+                else if (compress == "jpeg")
+                    encoding_ = bridge::JPEG;
+                else
+                    throw (std::runtime_error("Unknown compression '" + compress
+                                              + "'. Use none, png or jpeg."));
+            }
+
+            int64_t quality;
+            if (oat::config::getValue(this_config, "quality", quality, (int64_t)0, (int64_t)100))
+                jpeg_quality_ = quality;
+
+        } else {
+            throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
+        }
+    }
+
+    void connectToNode(void) override {
+
+        // Establish our a slot in the node
+        source_.touch(source_address_);
+
+        // Wait for sychronous start with sink when it binds the node
+        source_.connect();
+
+        // Connect to the receiving half
+        link_.connect();
+
+        if (queue_depth_ > 0) {
+            sending_ = true;
+            send_thread_ = std::thread(&BridgeSender<T>::sendQueued, this);
+        }
+    }
+
+    bool process(void) override {
+
+        checkSendError();
+
+        // START CRITICAL SECTION //
+        ////////////////////////////
+        if (source_.wait() == oat::NodeState::END) {
+
+            // Send what is left in the queue, then tell the receiver
+            stopSending();
+            checkSendError();
+
+            bridge::MessageHeader end;
+            end.kind = bridge::END;
+            end.set_address(source_address_);
+            link_.send(end, {});
+
+            return true;
+        }
+
+        // Sending in place posts as soon as the sample has been sent.
+        // Queueing posts as soon as the sample has been copied.
+        if (queue_depth_ == 0)
+            sendInPlace();
+        else
+            enqueue();
+
+        ////////////////////////////
+        //  END CRITICAL SECTION  //
+
+        // Sink was not at END state
+        return false;
+    }
+
+    /**
+     * Set the number of samples that can wait to be sent. 0, the default,
+     * sends each sample while it is held in shared memory. Must be called
+     * before connectToNode().
+     */
+    void set_queue_depth(const size_t value) { queue_depth_ = value; }
+
+    /**
+     * Set how frames are compressed. Ignored for other sample types.
+     * @param value Frame encoding.
+     * @param jpeg_quality JPEG quality, 0 to 100.
+     */
+    void set_encoding(const bridge::Encoding value, const int jpeg_quality = 95) {
+        encoding_ = value;
+        jpeg_quality_ = jpeg_quality;
+    }
+
+    // Number of samples dropped because the queue was full or because they
+    // did not fit in a datagram
+    uint64_t dropped(void) const { return dropped_; }
+
+private:
+
+    // A message waiting in the queue
+    struct Message {
+        bridge::MessageHeader header;
+        std::vector<uchar> payload;
+    };
+
+    /**
+     * Send the sample obtained by the last wait() and post().
+     */
+    void sendInPlace(void);
+
+    /**
+     * Copy the sample obtained by the last wait() into a message and post().
+     */
+    void encode(Message &message);
+
+    bridge::MessageHeader header(const oat::Frame &frame) const {
+
+        bridge::MessageHeader h;
+        h.kind = bridge::FRAME;
+        h.encoding = encoding_;
+        h.rows = frame.rows;
+        h.cols = frame.cols;
+        h.type = frame.type();
+        h.format = static_cast<uint16_t>(frame.format());
+        h.count = frame.sample().count();
+        h.usec = frame.sample().microseconds().count();
+        h.rate_hz = frame.sample().rate_hz();
+        h.set_address(source_address_);
+
+        return h;
+    }
+
+    bridge::MessageHeader header(oat::Position2D &position) const {
+
+        bridge::MessageHeader h;
+        h.kind = bridge::POSITION2D;
+        h.count = position.sample().count();
+        h.usec = position.sample().microseconds().count();
+        h.rate_hz = position.sample().rate_hz();
+        h.payload_bytes = sizeof(bridge::PositionMessage);
+        h.set_address(source_address_);
+
+        return h;
+    }
+
+    void enqueue(void) {
+
+        Message message = takeSpare();
+        encode(message);
+
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+
+        // Drop the oldest sample to make room
+        if (queue_.size() >= queue_depth_) {
+            spare_.push_back(std::move(queue_.front()));
+            queue_.pop_front();
+            dropped_++;
+        }
+
+        queue_.push_back(std::move(message));
+        lock.unlock();
+        queue_cv_.notify_one();
+    }
+
+    Message takeSpare(void) {
+
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (spare_.empty())
+            return Message();
+
+        Message message = std::move(spare_.back());
+        spare_.pop_back();
+        return message;
+    }
+
+    // Send thread. Runs until stopSending() is called and the queue is
+    // empty.
+    void sendQueued(void) {
+
+        for (;;) {
+
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            queue_cv_.wait(lock, [this] { return !queue_.empty() || !sending_; });
+            if (queue_.empty())
+                return;
+
+            Message message = std::move(queue_.front());
+            queue_.pop_front();
+            lock.unlock();
+
+            try {
+                send(message.header, message.payload.data(), message.payload.size());
+            } catch (...) {
+                std::lock_guard<std::mutex> guard(queue_mutex_);
+                send_error_ = std::current_exception();
+                queue_.clear();
+                return;
+            }
+
+            lock.lock();
+            spare_.push_back(std::move(message));
+        }
+    }
+
+    void stopSending(void) {
+
+        if (!send_thread_.joinable())
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            sending_ = false;
+        }
+        queue_cv_.notify_one();
+        send_thread_.join();
+    }
+
+    void checkSendError(void) {
+
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (send_error_)
+            std::rethrow_exception(send_error_);
+    }
+
+    void send(const bridge::MessageHeader &header, const void *data, const size_t bytes) {
+
+        if (link_.send(header, data, bytes))
+            return;
+
+        dropped_++;
+        if (!warned_too_large_) {
+            std::cerr << oat::whoWarn(name_,
+                "Samples are too large to fit in a datagram and are being "
+                "dropped. Use tcp or compress frames.\n");
+            warned_too_large_ = true;
+        }
+    }
+
+    // Source
+    const std::string source_address_;
+    oat::Source<T> source_;
+
+    // Frame compression
+    bridge::Encoding encoding_ {bridge::RAW};
+    int jpeg_quality_ {95};
+    std::vector<uchar> encoded_;
+
+    // Queue of samples waiting to be sent by the send thread
+    size_t queue_depth_ {0};
+    bool sending_ {false};
+    std::mutex queue_mutex_;
+    std::condition_variable queue_cv_;
+    std::deque<Message> queue_;
+    std::vector<Message> spare_;
+    std::thread send_thread_;
+    std::exception_ptr send_error_;
+
+    std::atomic<uint64_t> dropped_ {0};
+    std::atomic<bool> warned_too_large_ {false};
+};
+
+// 1. SharedFrameHeader
+
+/**
+ * Copy a frame's pixels into a contiguous buffer. Frames that are a region
+ * of interest of a larger shared frame are not continuous.
+ */
+inline void packRows(const cv::Mat &frame, std::vector<uchar> &buffer) {
+
+    const size_t row_bytes = frame.cols * frame.elemSize();
+    buffer.resize(row_bytes * frame.rows);
+
+    if (frame.isContinuous()) {
+        std::memcpy(buffer.data(), frame.data, buffer.size());
+        return;
+    }
+
+    for (int i = 0; i < frame.rows; i++)
+        std::memcpy(buffer.data() + i * row_bytes, frame.ptr(i), row_bytes);
+}
+
+template <>
+inline void BridgeSender<SharedFrameHeader>::sendInPlace() {
+
+    auto lease = source_.lease();
+    const oat::Frame &frame = lease.frame();
+
+    bridge::MessageHeader h = header(frame);
+
+    if (encoding_ == bridge::RAW) {
+
+        h.payload_bytes = frame.total() * frame.elemSize();
+
+        if (frame.isContinuous()) {
+
+            // Gathered straight out of shared memory
+            send(h, frame.data, h.payload_bytes);
+
+        } else {
+
+            // A region of interest of a larger frame: pack its rows
+            packRows(frame, encoded_);
+            lease.release();
+            send(h, encoded_.data(), encoded_.size());
+        }
+
+    } else {
+
+        // Compress, then let the SINK continue while the frame is sent
+        std::vector<int> params;
+        if (encoding_ == bridge::JPEG)
+            params = {cv::IMWRITE_JPEG_QUALITY, jpeg_quality_};
+        cv::imencode(encoding_ == bridge::PNG ? ".png" : ".jpg", frame, encoded_, params);
+        lease.release();
+
+        h.payload_bytes = encoded_.size();
+        send(h, encoded_.data(), encoded_.size());
+    }
+}
+
+template <>
+inline void BridgeSender<SharedFrameHeader>::encode(Message &message) {
+
+    auto lease = source_.lease();
+    const oat::Frame &frame = lease.frame();
+
+    message.header = header(frame);
+
+    if (encoding_ == bridge::RAW) {
+        packRows(frame, message.payload);
+    } else {
+        std::vector<int> params;
+        if (encoding_ == bridge::JPEG)
+            params = {cv::IMWRITE_JPEG_QUALITY, jpeg_quality_};
+        cv::imencode(encoding_ == bridge::PNG ? ".png" : ".jpg", frame, message.payload, params);
+    }
+
+    message.header.payload_bytes = message.payload.size();
+}
+
+// 2. Position2D
+
+template <>
+inline void BridgeSender<Position2D>::sendInPlace() {
+
+    // Positions are small, so they are copied out and the SINK is released
+    // before sending
+    Position2D position = source_.clone();
+    source_.post();
+
+    bridge::PositionMessage m;
+    bridge::pack(position, m);
+    send(header(position), &m, sizeof(m));
+}
+
+template <>
+inline void BridgeSender<Position2D>::encode(Message &message) {
+
+    Position2D position = source_.clone();
+    source_.post();
+
+    bridge::PositionMessage m;
+    bridge::pack(position, m);
+
+    message.header = header(position);
+    message.payload.resize(sizeof(m));
+    std::memcpy(message.payload.data(), &m, sizeof(m));
+}
+
+}      /* namespace oat */
+#endif /* OAT_BRIDGESENDER_H */
@@ -0,0 +1,311 @@
+//******************************************************************************
+//* File:   Link.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_BRIDGELINK_H
+#define	OAT_BRIDGELINK_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/connect.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/ip/udp.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+
+#include "Protocol.h"
+
+namespace oat {
+namespace bridge {
+
+/**
+ * One end of a TCP connection or UDP flow between two bridges. Messages are
+ * a MessageHeader followed by payload_bytes of payload. Over UDP, each
+ * message is a single datagram.
+ */
+class Link {
+
+    using tcp = boost::asio::ip::tcp;
+    using udp = boost::asio::ip::udp;
+
+public:
+
+    enum class Transport { TCP, UDP };
+
+    static constexpr size_t MAX_DATAGRAM {65507};
+
+    /**
+     * @param endpoint '<transport>://<host>:<port>', where transport is tcp
+     * or udp. When listening, host may be '*' to accept messages on any
+     * interface.
+     */
+    explicit Link(const std::string &endpoint) :
+      acceptor_(io_service_)
+    , tcp_socket_(io_service_)
+    , udp_socket_(io_service_)
+    {
+        const size_t sep = endpoint.find("://");
+        const size_t colon = endpoint.rfind(':');
+        if (sep == std::string::npos || colon == std::string::npos || colon <= sep + 2)
+            throw (std::runtime_error("Endpoint '" + endpoint + "' must be "
+                                      "specified as '<transport>://<host>:<port>'."));
+
+        const std::string transport = endpoint.substr(0, sep);
+        if (transport == "tcp")
+            transport_ = Transport::TCP;
+        else if (transport == "udp")
+            transport_ = Transport::UDP;
+        else
+            throw (std::runtime_error("Unsupported transport '" + transport
+                                      + "'. Use tcp or udp."));
+
+        host_ = endpoint.substr(sep + 3, colon - sep - 3);
+        port_ = endpoint.substr(colon + 1);
+    }
+
+    /**
+     * Connect to a listening bridge. Used by the sending end.
+     */
+    void connect(void) {
+
+        if (transport_ == Transport::TCP) {
+
+            tcp::resolver resolver(io_service_);
+            boost::asio::connect(tcp_socket_, resolver.resolve({host_, port_}));
+            tcp_socket_.set_option(tcp::no_delay(true));
+            fd_ = tcp_socket_.native_handle();
+
+        } else {
+
+            udp::resolver resolver(io_service_);
+            udp_peer_ = *resolver.resolve({udp::v4(), host_, port_});
+            udp_socket_.open(udp::v4());
+            udp_socket_.set_option(udp::socket::send_buffer_size(SOCKET_BUFFER_BYTES));
+            fd_ = udp_socket_.native_handle();
+        }
+    }
+
+    /**
+     * Bind to the endpoint. Used by the receiving end. Messages are not
+     * received until accept() is called.
+     */
+    void listen(void) {
+
+        const unsigned short port = static_cast<unsigned short>(std::stoul(port_));
+
+        if (transport_ == Transport::TCP) {
+
+            tcp::endpoint ep(tcp::v4(), port);
+            if (host_ != "*")
+                ep.address(boost::asio::ip::address::from_string(host_));
+
+            acceptor_.open(ep.protocol());
+            acceptor_.set_option(tcp::acceptor::reuse_address(true));
+            acceptor_.bind(ep);
+            acceptor_.listen(1);
+            fd_ = acceptor_.native_handle();
+
+        } else {
+
+            udp::endpoint ep(udp::v4(), port);
+            if (host_ != "*")
+                ep.address(boost::asio::ip::address::from_string(host_));
+
+            udp_socket_.open(ep.protocol());
+            udp_socket_.set_option(udp::socket::receive_buffer_size(SOCKET_BUFFER_BYTES));
+            udp_socket_.bind(ep);
+            datagram_.resize(MAX_DATAGRAM);
+            fd_ = udp_socket_.native_handle();
+        }
+    }
+
+    /**
+     * Wait for the sending end to connect. Returns immediately for UDP.
+     */
+    void accept(void) {
+
+        if (transport_ == Transport::TCP) {
+            acceptor_.accept(tcp_socket_);
+            tcp_socket_.set_option(tcp::no_delay(true));
+            fd_ = tcp_socket_.native_handle();
+            acceptor_.close();
+        }
+    }
+
+    /**
+     * @return Port the receiving end is bound to, e.g. when port 0 was
+     * requested.
+     */
+    unsigned short local_port(void) const {
+
+        if (transport_ == Transport::TCP)
+            return acceptor_.local_endpoint().port();
+        return udp_socket_.local_endpoint().port();
+    }
+
+    /**
+     * Send a message. The header and payload buffers are gathered by the
+     * kernel, so the payload is sent from where it lies.
+     * @param header Message header. payload_bytes must be the total size
+     * of the payload buffers.
+     * @param payload Payload buffers.
+     * @return False if the message was too large for a datagram and was not
+     * sent.
+     */
+    bool send(const MessageHeader &header,
+              const std::vector<boost::asio::const_buffer> &payload) {
+
+        std::vector<boost::asio::const_buffer> buffers;
+        buffers.reserve(payload.size() + 1);
+        buffers.push_back(boost::asio::buffer(&header, sizeof(header)));
+        buffers.insert(buffers.end(), payload.begin(), payload.end());
+
+        if (transport_ == Transport::TCP) {
+            boost::asio::write(tcp_socket_, buffers);
+            return true;
+        }
+
+        if (sizeof(header) + header.payload_bytes > MAX_DATAGRAM)
+            return false;
+
+        udp_socket_.send_to(buffers, udp_peer_);
+        return true;
+    }
+
+    bool send(const MessageHeader &header, const void *payload, const size_t bytes) {
+        return send(header, {boost::asio::buffer(payload, bytes)});
+    }
+
+    /**
+     * Receive the header of the next message. Its payload must be consumed
+     * with receivePayload() or skipPayload() before the next header is
+     * received.
+     * @param header Received header.
+     * @return False if the sending end closed the connection.
+     */
+    bool receiveHeader(MessageHeader &header) {
+
+        if (transport_ == Transport::TCP) {
+
+            boost::system::error_code ec;
+            boost::asio::read(tcp_socket_,
+                              boost::asio::buffer(&header, sizeof(header)),
+                              ec);
+            if (ec == boost::asio::error::eof)
+                return false;
+            if (ec)
+                throw boost::system::system_error(ec);
+
+            header.check();
+            return true;
+        }
+
+        // Datagrams too short to hold a header are not from a bridge
+        size_t bytes = 0;
+        do {
+            bytes = udp_socket_.receive(boost::asio::buffer(datagram_));
+        } while (bytes < sizeof(header));
+
+        std::memcpy(&header, datagram_.data(), sizeof(header));
+        header.check();
+
+        if (header.payload_bytes != bytes - sizeof(header))
+            throw (std::runtime_error("Received a truncated datagram."));
+
+        datagram_offset_ = sizeof(header);
+        return true;
+    }
+
+    /**
+     * Receive the payload of the last message, or part of it, directly
+     * into dst.
+     */
+    void receivePayload(void *dst, const size_t bytes) {
+
+        if (transport_ == Transport::TCP) {
+            boost::asio::read(tcp_socket_, boost::asio::buffer(dst, bytes));
+            return;
+        }
+
+        std::memcpy(dst, datagram_.data() + datagram_offset_, bytes);
+        datagram_offset_ += bytes;
+    }
+
+    /**
+     * Discard the payload of the last message, or part of it.
+     */
+    void skipPayload(size_t bytes) {
+
+        if (transport_ == Transport::UDP) {
+            datagram_offset_ += bytes;
+            return;
+        }
+
+        char discard[4096];
+        while (bytes > 0) {
+            const size_t n = std::min(bytes, sizeof(discard));
+            boost::asio::read(tcp_socket_, boost::asio::buffer(discard, n));
+            bytes -= n;
+        }
+    }
+
+    /**
+     * Wake any thread blocked sending, receiving or accepting on this link.
+     * Safe to call from a signal handler.
+     */
+    void interrupt(void) noexcept {
+
+        const int fd = fd_.load();
+        if (fd >= 0)
+            ::shutdown(fd, SHUT_RDWR);
+    }
+
+    Transport transport(void) const { return transport_; }
+
+private:
+
+    static constexpr int SOCKET_BUFFER_BYTES {4 * 1024 * 1024};
+
+    Transport transport_ {Transport::TCP};
+    std::string host_;
+    std::string port_;
+
+    boost::asio::io_service io_service_;
+    tcp::acceptor acceptor_;
+    tcp::socket tcp_socket_;
+    udp::socket udp_socket_;
+    udp::endpoint udp_peer_;
+
+    // Socket that blocking calls are made on
+    std::atomic<int> fd_ {-1};
+
+    // Last datagram received over UDP
+    std::vector<char> datagram_;
+    size_t datagram_offset_ {0};
+};
+
+}       /* namespace bridge */
+}       /* namespace oat */
+#endif	/* OAT_BRIDGELINK_H */
@@ -0,0 +1,233 @@
+//******************************************************************************
+//* File:   Protocol.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_BRIDGEPROTOCOL_H
+#define	OAT_BRIDGEPROTOCOL_H
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <opencv2/core.hpp>
+
+#include "../../lib/datatypes/Position2D.h"
+
+namespace oat {
+namespace bridge {
+
+/**
+ * Kind of sample carried by a message.
+ */
+enum Kind : uint16_t {
+    FRAME = 0,      //!< An oat::Frame
+    POSITION2D,     //!< An oat::Position2D
+    END             //!< The SOURCE's SINK reached the end of its stream
+};
+
+/**
+ * How the payload of a FRAME message is encoded.
+ */
+enum Encoding : uint16_t {
+    RAW = 0,        //!< Matrix data, row after row
+    PNG,            //!< Lossless cv::imencode() output
+    JPEG            //!< Lossy cv::imencode() output
+};
+
+/**
+ * Fixed size header sent before each payload. The header carries the
+ * length of the payload that follows it, so a stream of messages can be
+ * split without parsing the payload. Fields are sent in host byte order;
+ * the magic number will not match if the hosts do not share one.
+ */
+struct MessageHeader {
+
+    static constexpr uint32_t MAGIC {0x4254414f}; // "OATB"
+    static constexpr uint16_t VERSION {1};
+    static constexpr size_t MAX_ADDRESS_LENGTH {64};
+
+    // Largest frame a receiver will allocate shared memory for
+    static constexpr uint64_t MAX_FRAME_BYTES {uint64_t(1) << 30};
+
+    // Largest payload of a message that is not a frame. Compressed frames
+    // may exceed their raw size by an eighth of it plus this much.
+    static constexpr uint64_t MAX_PAYLOAD_OVERHEAD {uint64_t(1) << 16};
+
+    uint32_t magic {MAGIC};
+    uint16_t version {VERSION};
+    uint16_t kind {FRAME};
+    uint16_t encoding {RAW};
+    uint16_t format {0};    //!< oat::PixelFormat of a FRAME
+
+    // Frame geometry. Unused by other kinds.
+    int32_t rows {0};
+    int32_t cols {0};
+    int32_t type {0};
+
+    // Sample information at the sending end
+    uint64_t count {0};
+    int64_t usec {0};
+    double rate_hz {0};
+
+    uint64_t payload_bytes {0};
+
+    char address[MAX_ADDRESS_LENGTH] {}; //!< Name of the node being sent
+
+    void set_address(const std::string &value) {
+        std::strncpy(address, value.c_str(), sizeof(address) - 1);
+        address[sizeof(address) - 1] = '\0';
+    }
+
+    /**
+     * @return Node name, which is not NUL terminated if it fills address.
+     */
+    std::string address_string(void) const {
+        return std::string(address, strnlen(address, MAX_ADDRESS_LENGTH));
+    }
+
+    /**
+     * @return Size of the raw data of a FRAME. Only valid once check()
+     * has passed.
+     */
+    uint64_t frame_bytes(void) const {
+        return static_cast<uint64_t>(rows) * static_cast<uint64_t>(cols)
+               * CV_ELEM_SIZE(type);
+    }
+
+    /**
+     * Throw if the header was not sent by a compatible bridge, or describes
+     * a sample that is malformed or too large to receive.
+     */
+    void check(void) const {
+
+        if (magic != MAGIC)
+            throw (std::runtime_error("Received a message that was not sent "
+                                      "by oat-bridge, or was sent by a host "
+                                      "with a different byte order."));
+        if (version != VERSION)
+            throw (std::runtime_error("Received a message from an incompatible "
+                                      "version of oat-bridge."));
+        if (kind > END)
+            throw (std::runtime_error("Received a sample of unknown type."));
+
+        if (kind != FRAME) {
+            if (payload_bytes > MAX_PAYLOAD_OVERHEAD)
+                throw (std::runtime_error("Received a sample that is too large."));
+            return;
+        }
+
+        if (rows <= 0 || cols <= 0)
+            throw (std::runtime_error("Received a frame with invalid dimensions."));
+
+        // Depths are CV_8U to CV_64F
+        if (type < 0 || CV_MAT_DEPTH(type) > CV_64F
+            || CV_MAT_CN(type) < 1 || CV_MAT_CN(type) > 4
+            || type != CV_MAKETYPE(CV_MAT_DEPTH(type), CV_MAT_CN(type)))
+            throw (std::runtime_error("Received a frame with an invalid type."));
+
+        // Pixel count is checked first so that the size cannot overflow
+        const uint64_t pixels = static_cast<uint64_t>(rows) * static_cast<uint64_t>(cols);
+        const uint64_t bytes = frame_bytes();
+        if (pixels > MAX_FRAME_BYTES || bytes > MAX_FRAME_BYTES)
+            throw (std::runtime_error("Received a frame that is too large."));
+
+        if (payload_bytes > bytes + bytes / 8 + MAX_PAYLOAD_OVERHEAD)
+            throw (std::runtime_error("Received a frame whose payload is "
+                                      "larger than the frame."));
+    }
+};
+
+static_assert(std::is_trivially_copyable<MessageHeader>::value,
+              "MessageHeader is sent as raw bytes.");
+
+/**
+ * Payload of a POSITION2D message. Position2D has a vtable and a label that
+ * are not sent, so its fields are copied here.
+ */
+struct PositionMessage {
+
+    int32_t unit {0};
+    uint8_t position_valid {0};
+    uint8_t velocity_valid {0};
+    uint8_t heading_valid {0};
+    uint8_t region_valid {0};
+    double position[2] {0, 0};
+    double velocity[2] {0, 0};
+    double heading[2] {0, 0};
+    double homography[9] {0};
+    char region[100] {};
+};
+
+static_assert(std::is_trivially_copyable<PositionMessage>::value,
+              "PositionMessage is sent as raw bytes.");
+
+/**
+ * Copy a position into its payload.
+ * @param p Position to send.
+ * @param m Payload to fill in.
+ */
+inline void pack(const oat::Position2D &p, PositionMessage &m) {
+
+    m.unit = static_cast<int32_t>(p.unit_of_length());
+    m.position_valid = p.position_valid;
+    m.velocity_valid = p.velocity_valid;
+    m.heading_valid = p.heading_valid;
+    m.region_valid = p.region_valid;
+    m.position[0] = p.position.x;
+    m.position[1] = p.position.y;
+    m.velocity[0] = p.velocity.x;
+    m.velocity[1] = p.velocity.y;
+    m.heading[0] = p.heading.x;
+    m.heading[1] = p.heading.y;
+
+    const cv::Matx33d h = p.homography();
+    for (int i = 0; i < 9; i++)
+        m.homography[i] = h.val[i];
+
+    std::memcpy(m.region, p.region, sizeof(m.region));
+    m.region[sizeof(m.region) - 1] = '\0';
+}
+
+/**
+ * Copy a received payload into a position. The sample is not touched.
+ * @param m Received payload.
+ * @param p Position to fill in.
+ */
+inline void unpack(const PositionMessage &m, oat::Position2D &p) {
+
+    cv::Matx33d h;
+    for (int i = 0; i < 9; i++)
+        h.val[i] = m.homography[i];
+    p.setCoordSystem(static_cast<oat::DistanceUnit>(m.unit), h);
+
+    p.position_valid = m.position_valid;
+    p.velocity_valid = m.velocity_valid;
+    p.heading_valid = m.heading_valid;
+    p.region_valid = m.region_valid;
+    p.position = oat::Point2D(m.position[0], m.position[1]);
+    p.velocity = oat::Velocity2D(m.velocity[0], m.velocity[1]);
+    p.heading = oat::UnitVector2D(m.heading[0], m.heading[1]);
+
+    std::memcpy(p.region, m.region, sizeof(p.region));
+    p.region[sizeof(p.region) - 1] = '\0';
+}
+
+}       /* namespace bridge */
+}       /* namespace oat */
+#endif	/* OAT_BRIDGEPROTOCOL_H */
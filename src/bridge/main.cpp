@@ -0,0 +1,288 @@
+//******************************************************************************
+//* File:   oat bridge main.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//****************************************************************************
+
+#include "OatConfig.h" // Generated by CMake
+
+#include <atomic>
+#include <csignal>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <boost/program_options.hpp>
+#include <boost/interprocess/exceptions.hpp>
+#include <boost/system/system_error.hpp>
+#include <cpptoml.h>
+
+#include "../../lib/utility/IOFormat.h"
+
+#include "BridgeReceiver.h"
+#include "BridgeSender.h"
+
+namespace po = boost::program_options;
+
+volatile sig_atomic_t quit = 0;
+volatile sig_atomic_t source_eof = 0;
+
+// Bridge to wake when ctrl-c is pressed
+std::atomic<oat::Bridge *> running_bridge {nullptr};
+
+void printUsage(po::options_description options) {
+    std::cout << "Usage: bridge [INFO]\n"
+              << "   or: bridge send TYPE SOURCE ENDPOINT [CONFIGURATION]\n"
+              << "   or: bridge recv ENDPOINT [SINK] [CONFIGURATION]\n"
+              << "Carry a node between hosts. 'send' reads samples from SOURCE\n"
+              << "and sends them to ENDPOINT. 'recv' receives samples on ENDPOINT\n"
+              << "and publishes them to SINK.\n\n"
+              << "TYPE\n"
+              << "  frame: Frame bridge\n"
+              << "  pos2D: 2D Position bridge\n\n"
+              << "SOURCE:\n"
+              << "  User-supplied name of the memory segment to send samples\n"
+              << "  from (e.g. raw).\n\n"
+              << "ENDPOINT:\n"
+              << "  '<transport>://<host>:<port>', where transport is tcp or\n"
+              << "  udp. For instance, 'tcp://10.0.0.2:5555' sends to, and\n"
+              << "  'tcp://*:5555' receives on, port 5555 using TCP. Start 'recv'\n"
+              << "  before 'send' when using TCP.\n\n"
+              << "SINK:\n"
+              << "  User-supplied name of the memory segment to publish samples\n"
+              << "  to. Defaults to the name of the SOURCE on the sending host.\n\n"
+              << options << "\n";
+}
+
+// Signal handler to ensure shared resources are cleaned on exit due to ctrl-c
+void sigHandler(int) {
+    quit = 1;
+    oat::Bridge *bridge = running_bridge.load();
+    if (bridge != nullptr)
+        bridge->interrupt();
+}
+
+void run(const std::shared_ptr<oat::Bridge> &bridge) {
+
+    try {
+
+        bridge->connectToNode();
+
+        while (!quit && !source_eof) {
+            source_eof = bridge->process();
+        }
+
+    } catch (const boost::interprocess::interprocess_exception &ex) {
+
+        // Error code 1 indicates a SIGNINT during a call to wait(), which
+        // is normal behavior
+        if (ex.get_error_code() != 1)
+            throw;
+    } catch (const boost::system::system_error &ex) {
+
+        // Sockets are shut down by ctrl-c
+        if (!quit)
+            throw;
+    }
+}
+
+int main(int argc, char *argv[]) {
+
+    std::signal(SIGINT, sigHandler);
+
+    std::string mode;
+    std::vector<std::string> args;
+    std::vector<std::string> config_fk;
+    bool config_used = false;
+    po::options_description visible_options("OPTIONS");
+
+    try {
+
+        po::options_description options("INFO");
+        options.add_options()
+                ("help", "Produce help message.")
+                ("version,v", "Print version information.")
+                ;
+
+        po::options_description config("CONFIGURATION");
+        config.add_options()
+                ("config,c", po::value<std::vector<std::string> >()->multitoken(),
+                "Configuration file/key pair.")
+                ;
+
+        po::options_description hidden("HIDDEN OPTIONS");
+        hidden.add_options()
+                ("mode", po::value<std::string>(&mode), "send or recv.")
+                ("args", po::value<std::vector<std::string> >(),
+                "TYPE, SOURCE and ENDPOINT, or ENDPOINT and SINK.")
+                ;
+
+        po::positional_options_description positional_options;
+        positional_options.add("mode", 1);
+        positional_options.add("args", -1);
+
+        visible_options.add(options).add(config);
+
+        po::options_description all_options("ALL OPTIONS");
+        all_options.add(options).add(config).add(hidden);
+
+        po::variables_map variable_map;
+        po::store(po::command_line_parser(argc, argv)
+                .options(all_options)
+                .positional(positional_options)
+                .run(),
+                variable_map);
+        po::notify(variable_map);
+
+        // Use the parsed options
+        if (variable_map.count("help")) {
+            printUsage(visible_options);
+            return 0;
+        }
+
+        if (variable_map.count("version")) {
+            std::cout << "Oat Bridge version "
+                      << Oat_VERSION_MAJOR
+                      << "."
+                      << Oat_VERSION_MINOR
+                      << "\n";
+            std::cout << "Written by Jonathan P. Newman in the MWL@MIT.\n";
+            std::cout << "Licensed under the GPL3.0.\n";
+            return 0;
+        }
+
+        if (variable_map.count("args"))
+            args = variable_map["args"].as<std::vector<std::string> >();
+
+        if (mode == "send") {
+            if (args.size() != 3) {
+                printUsage(visible_options);
+                std::cerr << oat::Error("A TYPE, SOURCE and ENDPOINT must be specified.\n");
+                return -1;
+            }
+        } else if (mode == "recv") {
+            if (args.size() < 1 || args.size() > 2) {
+                printUsage(visible_options);
+                std::cerr << oat::Error("An ENDPOINT and optional SINK must be specified.\n");
+                return -1;
+            }
+        } else {
+            printUsage(visible_options);
+            std::cerr << oat::Error("Either send or recv must be specified.\n");
+            return -1;
+        }
+
+        if (!variable_map["config"].empty()) {
+
+            config_fk = variable_map["config"].as<std::vector<std::string> >();
+
+            if (config_fk.size() == 2) {
+                config_used = true;
+            } else {
+                printUsage(visible_options);
+                std::cerr << oat::Error("Configuration must be supplied as file key pair.\n");
+                return -1;
+            }
+        }
+
+    } catch (std::exception& e) {
+        std::cerr << oat::Error(e.what()) << "\n";
+        return -1;
+    } catch (...) {
+        std::cerr << oat::Error("Exception of unknown type.\n");
+        return -1;
+    }
+
+    // Create component
+    std::string name = "bridge";
+    std::shared_ptr<oat::Bridge> bridge;
+
+    try {
+
+        if (mode == "send") {
+
+            if (args[0] == "frame") {
+                bridge = std::make_shared<oat::BridgeSender<oat::SharedFrameHeader>>(args[1], args[2]);
+            } else if (args[0] == "pos2D") {
+                bridge = std::make_shared<oat::BridgeSender<oat::Position2D>>(args[1], args[2]);
+            } else {
+                printUsage(visible_options);
+                std::cerr << oat::Error("Invalid TYPE specified.\n");
+                return -1;
+            }
+
+        } else {
+            bridge = std::make_shared<oat::BridgeReceiver>(args[0],
+                                                           args.size() > 1 ? args[1] : "");
+        }
+
+        name = bridge->name();
+
+        if (config_used)
+            bridge->configure(config_fk[0], config_fk[1]);
+
+        running_bridge = bridge.get();
+
+        // Tell user
+        if (mode == "send")
+            std::cout << oat::whoMessage(name,
+                    "Sending source " + oat::sourceText(args[1]) + " to " + args[2] + ".\n");
+        else
+            std::cout << oat::whoMessage(name,
+                    "Waiting for a sender on " + args[0] + ".\n");
+        std::cout << oat::whoMessage(name, "Press CTRL+C to exit.\n");
+
+        // Infinite loop until ctrl-c or end of stream signal
+        run(bridge);
+
+        running_bridge = nullptr;
+
+        // Tell user
+        uint64_t lost = 0;
+        if (auto r = std::dynamic_pointer_cast<oat::BridgeReceiver>(bridge))
+            lost = r->missed();
+        else if (auto s = std::dynamic_pointer_cast<oat::BridgeSender<oat::SharedFrameHeader>>(bridge))
+            lost = s->dropped();
+        else if (auto s = std::dynamic_pointer_cast<oat::BridgeSender<oat::Position2D>>(bridge))
+            lost = s->dropped();
+
+        if (lost > 0)
+            std::cout << oat::whoMessage(name,
+                    std::to_string(lost) + " samples were dropped.\n");
+        std::cout << oat::whoMessage(name, "Exiting.\n");
+
+        // Exit
+        return 0;
+
+    } catch (const cpptoml::parse_exception &ex) {
+        std::cerr << oat::whoError(name,
+                     "Failed to parse configuration file " + config_fk[0] + "\n")
+                  << oat::whoError(name, ex.what()) << "\n";
+    } catch (const std::runtime_error &ex) {
+        std::cerr << oat::whoError(name, ex.what()) << "\n";
+    } catch (const cv::Exception &ex) {
+        std::cerr << oat::whoError(name, ex.what()) << "\n";
+    } catch (const boost::interprocess::interprocess_exception &ex) {
+        std::cerr << oat::whoError(name, ex.what()) << "\n";
+    } catch (...) {
+        std::cerr << oat::whoError(name, "Unknown exception.\n");
+    }
+
+    running_bridge = nullptr;
+
+    // Exit failure
+    return -1;
+}
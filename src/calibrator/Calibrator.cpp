@@ -65,7 +65,10 @@ bool Calibrator::process(void) {
     ////////////////////////////
     //  END CRITICAL SECTION  //
 
-    calibrate(internal_frame_);
+    // Calibrators work on 8 bit BGR frames. The converter is not shared, so
+    // its output is private to this calibrator and can be drawn on.
+    cv::Mat frame = converter_.convert(internal_frame_, PixelFormat::BGR, CV_8U);
+    calibrate(frame);
 
     // Sink was not at END state
     return false;
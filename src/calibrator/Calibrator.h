@@ -26,6 +26,7 @@
 
 #include "../../lib/datatypes/Frame.h"
 #include "../../lib/shmemdf/Source.h"
+#include "../../lib/utility/FrameConverter.h"
 
 namespace oat {
 
@@ -106,6 +107,7 @@ private:
 
     std::string name_;                      //!< Calibrator name
     oat::Frame internal_frame_;             //!< Current frame provided by SOURCE
+    oat::FrameConverter converter_;         //!< Provides 8 bit BGR frames to calibrate()
     std::string frame_source_address_;      //!< Frame source address
     oat::NodeState node_state_ {oat::NodeState::UNDEFINED}; //!< Frame source node state
     oat::Source<SharedFrameHeader> frame_source_; //!< The calibrator frame SOURCE
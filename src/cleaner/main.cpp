@@ -22,9 +22,11 @@
 #include <iostream>
 #include <unordered_map>
 #include <csignal>
+#include <set>
 #include <boost/program_options.hpp>
 #include <boost/interprocess/managed_shared_memory.hpp>
 
+#include "../../lib/shmemdf/Registry.h"
 #include "../../lib/utility/IOFormat.h"
 
 namespace po = boost::program_options;
@@ -33,6 +35,7 @@ namespace bip = boost::interprocess;
 void printUsage(po::options_description options) {
     std::cout << "Usage: clean [INFO]\n"
               << "   or: clean NAMES [CONFIGURATION]\n"
+              << "   or: clean --stale [CONFIGURATION]\n"
               << "Deallocate the named shared memory segments specified by NAMES.\n\n"
               << options << "\n";
 }
@@ -42,6 +45,7 @@ int main(int argc, char *argv[]) {
     std::vector<std::string> names;
     bool quiet = false;
     bool legacy = false;
+    bool stale = false;
 
     try {
 
@@ -55,6 +59,9 @@ int main(int argc, char *argv[]) {
         options.add_options()
                 ("quiet,q", "Quiet mode. Prevent output text.")
                 ("legacy,l", "Legacy mode. Append  \"_sh_mem\" to input NAMES before removing.")
+                ("stale,s", "Deallocate the nodes of every component that has died "
+                 "without cleaning up, as recorded in the node registry. NAMES are not "
+                 "required.")
                 ;
 
         po::options_description hidden("HIDDEN OPTIONS");
@@ -97,7 +104,10 @@ int main(int argc, char *argv[]) {
             return 0;
         }
 
-        if (!variable_map.count("names")) {
+        if (variable_map.count("stale"))
+            stale = true;
+
+        if (!variable_map.count("names") && !stale) {
             printUsage(visible_options);
             std::cout << "Error: at least a single NAME must be specified. Exiting.\n";
             return -1;
@@ -109,7 +119,8 @@ int main(int argc, char *argv[]) {
         if (variable_map.count("legacy"))
             legacy = true;
 
-        names = variable_map["names"].as< std::vector<std::string> >();
+        if (variable_map.count("names"))
+            names = variable_map["names"].as< std::vector<std::string> >();
 
     } catch (std::exception& e) {
         std::cerr << oat::Error(e.what()) << "\n";
@@ -119,6 +130,23 @@ int main(int argc, char *argv[]) {
         return -1;
     }
 
+    if (stale) {
+
+        oat::shmem_t segment;
+        oat::Registry *registry = oat::openRegistry(segment);
+
+        std::set<std::string> removed;
+        auto reclaim = [registry, &removed] { removed = registry->reclaim(); };
+        segment.atomic_func(reclaim);
+
+        if (!quiet) {
+            for (auto &name : removed)
+                std::cout << "Removed stale node \'" << name << "\'.\n";
+            if (removed.empty())
+                std::cout << "No stale nodes were found.\n";
+        }
+    }
+
     for (auto &name : names) {
 
         // All servers (MatServer and SMServer) append "_sh_mem" to user-provided
@@ -97,44 +97,64 @@ void Decorator::connectToNodes() {
                      );
     }
 
-    // Bind to sink sink node and create a shared frame
-    frame_sink_.bind(frame_sink_address_, param.bytes);
-    shared_frame_ = frame_sink_.retrieve(param.rows, param.cols, param.type);
+    // Bind to sink sink node and create a shared frame. Decorated frames are
+    // always 8 bit BGR.
+    frame_sink_.bind(frame_sink_address_, param.rows * param.cols * 3);
+    shared_frame_ = frame_sink_.retrieve(param.rows, param.cols, CV_8UC3);
 
     // Set drawing parameters based on frame dimensions
     size_t min_size = (param.rows < param.cols) ? param.rows : param.cols;
     position_circle_radius_ =  std::ceil(static_cast<float>(min_size)/100.0);
     heading_line_length_ =  std::ceil(static_cast<float>(min_size)/100.0);
     encode_bit_size_  =  
-        std::ceil(param.cols / 3 / sizeof(internal_frame_.sample().count()) / 8);
+        std::ceil(param.cols / 3 / sizeof(shared_frame_.sample().count()) / 8);
 }
 
 bool Decorator::decorateFrame() {
 
+    // Wait for sources to read before taking the SOURCE sample, so that
+    // slow readers downstream do not hold up the SINK upstream
+    frame_sink_.wait();
+
     // 1. Get frame
     // START CRITICAL SECTION //
     ////////////////////////////
 
     // Wait for sink to write to node
-    if (frame_source_.wait() == oat::NodeState::END )
+    if (frame_source_.wait() == oat::NodeState::END ) {
+        frame_sink_.cancel();
         return true;
+    }
 
-    // Clone the shared frame
-    frame_source_.copyTo(internal_frame_);
+    // Read the shared frame in place
+    auto lease = frame_source_.lease();
 
-    // Tell sink it can continue
-    frame_source_.post();
+    // Copy or convert the frame straight into the SINK frame, which is
+    // decorated in place below
+    const oat::Frame &frame = lease.frame();
+    if (frame.type() == CV_8UC3) {
+        frame.copyTo(shared_frame_);
+    } else {
+        cv::Mat decorated = shared_frame_;
+        oat::convertFrame(frame, frame.format(), decorated,
+                          PixelFormat::BGR, CV_8U, conversion_scratch_);
+        shared_frame_.sample() = frame.sample();
+    }
 
-    ////////////////////////////
-    //  END CRITICAL SECTION  //
+    // Tell sink it can continue
+    lease.release();
 
     // 2. Get positions
     for (pvec_size_t i = 0; i !=  position_sources_.size(); i++) {
 
         // START CRITICAL SECTION //
         ////////////////////////////
-        if (position_sources_[i].source->wait() == oat::NodeState::END)
+        // The frame is already in the SINK, so publish it undecorated
+        // rather than leave the write unfinished
+        if (position_sources_[i].source->wait() == oat::NodeState::END) {
+            frame_sink_.post();
             return true;
+        }
 
         positions_[i] = position_sources_[i].source->clone();
 
@@ -146,14 +166,6 @@ bool Decorator::decorateFrame() {
     // Decorate frame
     drawOnFrame();
 
-    // START CRITICAL SECTION //
-    ////////////////////////////
-
-    // Wait for sources to read
-    frame_sink_.wait();
-
-    internal_frame_.copyTo(shared_frame_);
-
     // Tell sources there is new data
     frame_sink_.post();
 
@@ -233,7 +245,7 @@ void Decorator::drawPosition() {
 
         if (p.position_valid) {
 
-            cv::circle(internal_frame_,
+            cv::circle(shared_frame_,
                        p.position,
                        position_circle_radius_,
                        pos_colors_[i],
@@ -243,7 +255,7 @@ void Decorator::drawPosition() {
 
                 cv::Point2d end = 
                     p.position + (velocity_scale_factor_ * p.velocity);
-                cv::line(internal_frame_,
+                cv::line(shared_frame_,
                          p.position,
                          end,
                          pos_colors_[i],
@@ -257,7 +269,7 @@ void Decorator::drawPosition() {
                 cv::Point2d end =
                         p.position + (heading_line_length_ * p.heading);
 
-                cv::line(internal_frame_, start, end, font_color_, line_thickness_);
+                cv::line(shared_frame_, start, end, font_color_, line_thickness_);
             }
         }
 
@@ -282,7 +294,7 @@ void Decorator::printRegion() {
             cv::getTextSize(reg_text, font_type_, font_scale_, font_thickness_, &baseline);
 
     cv::Point text_origin(10, reg_text_size.height);
-    cv::putText(internal_frame_, reg_text, text_origin, font_thickness_, font_scale_, font_color_);
+    cv::putText(shared_frame_, reg_text, text_origin, font_thickness_, font_scale_, font_color_);
 
     // Add ID: region information
     size_t i = 0;
@@ -293,7 +305,7 @@ void Decorator::printRegion() {
             reg_text = ps.name + ": ?";
 
         text_origin.y += reg_text_size.height + 2;
-        cv::putText(internal_frame_,
+        cv::putText(shared_frame_,
                     reg_text, text_origin,
                     font_thickness_,
                     font_scale_,
@@ -314,15 +326,15 @@ void Decorator::printTimeStamp() {
 
     std::strftime(buffer, 80, "%c", time_info);
 
-    cv::Point text_origin(internal_frame_.cols - 230, internal_frame_.rows - 10);
-    cv::putText(internal_frame_, std::string(buffer), text_origin, 1, font_scale_, font_color_);
+    cv::Point text_origin(shared_frame_.cols - 230, shared_frame_.rows - 10);
+    cv::putText(shared_frame_, std::string(buffer), text_origin, 1, font_scale_, font_color_);
 }
 
 void Decorator::printSampleNumber() {
 
-    cv::Point text_origin(10, internal_frame_.rows - 10);
-    cv::putText(internal_frame_,
-                std::to_string(internal_frame_.sample().count()),
+    cv::Point text_origin(10, shared_frame_.rows - 10);
+    cv::putText(shared_frame_,
+                std::to_string(shared_frame_.sample().count()),
                 text_origin,
                 1,
                 font_scale_,
@@ -334,8 +346,8 @@ void Decorator::printSampleNumber() {
  */
 void Decorator::encodeSampleNumber() {
 
-    uint64_t sample_count = internal_frame_.sample().count();
-    int column = internal_frame_.cols - 64 * encode_bit_size_;
+    uint64_t sample_count = shared_frame_.sample().count();
+    int column = shared_frame_.cols - 64 * encode_bit_size_;
 
     if (column < 0)
         throw std::runtime_error("Binary counter bar is too large for frame."
@@ -343,16 +355,16 @@ void Decorator::encodeSampleNumber() {
 
     for (int shift = 0; shift < 64; shift++) {
 
-        cv::Mat sub_square = internal_frame_.colRange(column, column + encode_bit_size_).rowRange(0, encode_bit_size_);
+        cv::Mat sub_square = shared_frame_.colRange(column, column + encode_bit_size_).rowRange(0, encode_bit_size_);
 
         if (sample_count & 0x1) {
 
-            cv::Mat true_mat(encode_bit_size_, encode_bit_size_, internal_frame_.type(), CV_RGB(255, 255, 255));
+            cv::Mat true_mat(encode_bit_size_, encode_bit_size_, shared_frame_.type(), CV_RGB(255, 255, 255));
             true_mat.copyTo(sub_square);
 
         } else {
 
-            cv::Mat false_mat = cv::Mat::zeros(encode_bit_size_, encode_bit_size_, internal_frame_.type());
+            cv::Mat false_mat = cv::Mat::zeros(encode_bit_size_, encode_bit_size_, shared_frame_.type());
             false_mat.copyTo(sub_square);
         }
 
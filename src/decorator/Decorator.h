@@ -29,6 +29,7 @@
 #include "../../lib/shmemdf/Sink.h"
 #include "../../lib/shmemdf/SharedFrameHeader.h"
 #include "../../lib/datatypes/Position2D.h"
+#include "../../lib/utility/FrameConverter.h"
 
 namespace oat {
 
@@ -80,15 +81,17 @@ private:
     // Decorator name
     std::string name_;
 
-    // Internal frame copy
-    oat::Frame internal_frame_;
-
     // Mat client object for receiving frames
     std::string frame_source_address_;
     oat::Source<SharedFrameHeader> frame_source_;
 
-    // Mat server for sending decorated frames
+    // Mat server for sending decorated frames. Frames are decorated in place.
     oat::Frame shared_frame_;
+
+    // Decorations are drawn in colour, so SOURCE frames in other formats
+    // (e.g. grey or raw Bayer) are converted to 8 bit BGR on their way into
+    // the SINK frame
+    cv::Mat conversion_scratch_;
     std::string frame_sink_address_;
     oat::Sink<SharedFrameHeader> frame_sink_;
 
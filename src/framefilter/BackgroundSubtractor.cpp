@@ -23,6 +23,7 @@
 #include <iostream>
 #include <opencv2/core.hpp>
 #include <opencv2/highgui.hpp>
+#include <opencv2/imgproc.hpp>
 
 #include <cpptoml.h>
 #include "../../lib/utility/OatTOMLSanitize.h"
@@ -43,7 +44,9 @@ BackgroundSubtractor::BackgroundSubtractor(
 void BackgroundSubtractor::configure(const std::string& config_file, const std::string& config_key) {
 
     // Available options
-    std::vector<std::string> options {"background"};
+    std::vector<std::string> options {"background",
+                                      "learning-coeff",
+                                      "update-stride"};
 
     // This will throw cpptoml::parse_exception if a file
     // with invalid TOML is provided
@@ -69,6 +72,12 @@ void BackgroundSubtractor::configure(const std::string& config_file, const std::
             background_set = true;
         }
 
+        oat::config::getValue(this_config, "learning-coeff", learning_coeff,
+                              0.0, 1.0);
+
+        oat::config::getValue(this_config, "update-stride", update_stride,
+                              (int64_t)1);
+
     } else {
         throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
     }
@@ -81,6 +90,12 @@ void BackgroundSubtractor::setBackgroundImage(const cv::Mat& frame) {
 }
 
 void BackgroundSubtractor::filter(cv::Mat& frame) {
+
+    // Saturating subtraction works in place
+    filterInto(frame, frame);
+}
+
+void BackgroundSubtractor::filterInto(const cv::Mat &frame, cv::Mat &filtered) {
     // Throws cv::Exception if there is a size mismatch between frames,
     // or in any case where cv assertions fail.
 
@@ -89,7 +104,30 @@ void BackgroundSubtractor::filter(cv::Mat& frame) {
     if (!background_set)
         setBackgroundImage(frame);
 
-    frame = frame - background_frame;
+    // Blend the frame into the background before subtracting, since
+    // filtered may be frame itself
+    if (learning_coeff > 0.0 && ++frames_since_update >= update_stride) {
+        updateBackground(frame);
+        frames_since_update = 0;
+    }
+
+    // Saturating subtraction, same as operator- but written straight into
+    // filtered
+    cv::subtract(frame, background_frame, filtered);
+}
+
+void BackgroundSubtractor::updateBackground(const cv::Mat &frame) {
+
+    // Start from the current background
+    if (accumulator.empty())
+        background_frame.convertTo(accumulator,
+                CV_MAKETYPE(CV_32F, background_frame.channels()));
+
+    // accumulator = (1 - a) * accumulator + a * frame, in place
+    cv::accumulateWeighted(frame, accumulator, learning_coeff);
+
+    // Rounded and saturated into the existing background frame
+    accumulator.convertTo(background_frame, background_frame.type());
 }
 
 } /* namespace oat */
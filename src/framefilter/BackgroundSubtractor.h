@@ -34,7 +34,8 @@ public:
      * A basic background subtractor.
      * Subtract a frame image from a frame stream. The background frame is
      * the first frame obtained from the SOURCE frame stream, or can be
-     * supplied via configuration file.
+     * supplied via configuration file. It can optionally adapt to the
+     * stream as a running average of its frames.
      * @param frame_source_address raw frame source address
      * @param frame_sink_address filtered frame sink address
      */
@@ -53,6 +54,13 @@ private:
      */
     void filter(cv::Mat& frame) override;
 
+    /**
+     * Apply background subtraction without copying the unfiltered frame.
+     * @param frame unfiltered frame
+     * @param filtered filtered frame
+     */
+    void filterInto(const cv::Mat &frame, cv::Mat &filtered) override;
+
     // Is the background frame set?
     bool background_set = false;
 
@@ -61,6 +69,27 @@ private:
 
     // Set the background frame
     void setBackgroundImage(const cv::Mat&);
+
+    // Weight of each new frame in the running average background. 0 keeps
+    // the background static.
+    double learning_coeff = 0.0;
+
+    // Update the background every update_stride frames
+    int64_t update_stride = 1;
+    int64_t frames_since_update = 0;
+
+    // Running average background in single precision floating point. An
+    // update is only lost when learning_coeff * |frame - background| is
+    // below half the float spacing at the background's value, i.e. about
+    // 2^-17 / learning_coeff grey levels for 8 bit frames (0.008 at 0.001)
+    // and 2^-9 / learning_coeff for 16 bit frames.
+    cv::Mat accumulator;
+
+    /**
+     * Blend a frame into the running average background.
+     * @param frame Unfiltered frame
+     */
+    void updateBackground(const cv::Mat &frame);
 };
 
 }      /* namespace oat */
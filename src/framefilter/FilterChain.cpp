@@ -0,0 +1,187 @@
+//******************************************************************************
+//* File:   FilterChain.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include <string>
+
+#include <opencv2/core.hpp>
+#include <cpptoml.h>
+
+#include "../../lib/utility/OatTOMLSanitize.h"
+#include "../../lib/utility/IOFormat.h"
+#include "../../lib/utility/make_unique.h"
+
+#include "BackgroundSubtractor.h"
+#include "BackgroundSubtractorMOG.h"
+#include "FrameMasker.h"
+#include "Undistorter.h"
+
+#include "FilterChain.h"
+
+namespace oat {
+
+namespace {
+
+std::unique_ptr<FrameFilter> makeFilter(const std::string &type,
+                                        const std::string &source,
+                                        const std::string &sink) {
+
+    if (type == "bsub")
+        return std::make_unique<oat::BackgroundSubtractor>(source, sink);
+    else if (type == "mask")
+        return std::make_unique<oat::FrameMasker>(source, sink);
+    else if (type == "mog")
+        return std::make_unique<oat::BackgroundSubtractorMOG>(source, sink);
+    else if (type == "undistort")
+        return std::make_unique<oat::Undistorter>(source, sink);
+
+    throw (std::runtime_error("Invalid filter TYPE '" + type + "' in chain. "
+                              "Use bsub, mask, mog or undistort.\n"));
+}
+
+}
+
+FilterChain::FilterChain(const std::string &frame_source_address,
+                         const std::string &frame_sink_address) :
+  FrameFilter(frame_source_address, frame_sink_address)
+, frame_source_address_(frame_source_address)
+, frame_sink_address_(frame_sink_address)
+{
+    // Nothing
+}
+
+void FilterChain::configure(const std::string &config_file,
+                            const std::string &config_key) {
+
+    // Available options
+    std::vector<std::string> options {"filters", "configs"};
+
+    // This will throw cpptoml::parse_exception if a file
+    // with invalid TOML is provided
+    auto config = cpptoml::parse_file(config_file);
+
+    // See if a configuration was provided
+    if (config->contains(config_key)) {
+
+        // Get this components configuration table
+        auto this_config = config->get_table(config_key);
+
+        // Check for unknown options in the table and throw if you find them
+        oat::config::checkKeys(options, this_config);
+
+        oat::config::Array filter_array;
+        oat::config::getArray(this_config, "filters", filter_array, true);
+
+        std::vector<std::string> types;
+        for (auto &t : filter_array->array_of<std::string>())
+            types.push_back(t->get());
+
+        if (types.empty())
+            throw (std::runtime_error("A chain must contain at least one "
+                                      "filter.\n"));
+
+        // Each filter is configured from the table named after its TYPE,
+        // unless its configuration key is given
+        std::vector<std::string> keys = types;
+        oat::config::Array config_array;
+        const bool keys_given = oat::config::getArray(this_config, "configs",
+                                                      config_array,
+                                                      types.size());
+        if (keys_given) {
+            keys.clear();
+            for (auto &k : config_array->array_of<std::string>())
+                keys.push_back(k->get());
+        }
+
+        filters_.clear();
+        for (size_t i = 0; i < types.size(); i++) {
+
+            auto f = makeFilter(types[i], frame_source_address_,
+                                frame_sink_address_);
+
+            // Only a filter relying on its TYPE-named table may go without
+            // one. A missing table that was named is a mistake.
+            if (config->contains(keys[i]))
+                f->configure(config_file, keys[i]);
+            else if (keys_given)
+                throw (std::runtime_error(
+                        oat::configNoTableError(keys[i], config_file)));
+
+            filters_.push_back(std::move(f));
+        }
+
+    } else {
+        throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
+    }
+}
+
+void FilterChain::filter(cv::Mat &frame) {
+
+    for (auto &f : filters_)
+        f->filter(frame);
+}
+
+void FilterChain::filterInto(const cv::Mat &frame, cv::Mat &filtered) {
+
+    if (filters_.empty()) {
+        frame.copyTo(filtered);
+        return;
+    }
+
+    // The first filter reads the unfiltered frame and the rest work in
+    // place on its result, so the chain copies no more than one filter does
+    filters_[0]->filterInto(frame, filtered);
+    for (size_t i = 1; i < filters_.size(); i++)
+        filters_[i]->filter(filtered);
+}
+
+bool FilterChain::readsInPlace() const {
+
+    for (auto &f : filters_)
+        if (!f->readsInPlace())
+            return false;
+
+    return true;
+}
+
+bool FilterChain::acceptsMosaic() const {
+
+    for (auto &f : filters_)
+        if (!f->acceptsMosaic())
+            return false;
+
+    return true;
+}
+
+cv::Rect FilterChain::publishedRegion(const cv::Size &size) const {
+
+    const cv::Rect whole(cv::Point(0, 0), size);
+    if (filters_.empty())
+        return whole;
+
+    // Filters that publish part of the frame may leave the rest of it
+    // unfiltered, which later filters would read
+    for (size_t i = 0; i + 1 < filters_.size(); i++)
+        if (filters_[i]->publishedRegion(size) != whole)
+            throw (std::runtime_error("Only the last filter of a chain can "
+                                      "crop its frames.\n"));
+
+    return filters_.back()->publishedRegion(size);
+}
+
+} /* namespace oat */
@@ -0,0 +1,87 @@
+//******************************************************************************
+//* File:   FilterChain.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_FILTERCHAIN_H
+#define	OAT_FILTERCHAIN_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "FrameFilter.h"
+
+namespace oat {
+
+/**
+ * An ordered chain of frame filters applied within one component.
+ */
+class FilterChain : public FrameFilter {
+public:
+
+    /**
+     * An ordered chain of frame filters applied within one component.
+     * Filters run back to back on the SINK's frame, so a chain reads and
+     * publishes each frame once instead of once per filter, and needs no
+     * intermediate nodes.
+     * @param frame_source_address raw frame source address
+     * @param frame_sink_address filtered frame sink address
+     */
+    FilterChain(const std::string &frame_source_address,
+                const std::string &frame_sink_address);
+
+    void configure(const std::string &config_file,
+                   const std::string &config_key) override;
+
+private:
+
+    /**
+     * Apply each filter in turn.
+     * @param frame unfiltered frame
+     * @return filtered frame
+     */
+    void filter(cv::Mat& frame) override;
+
+    /**
+     * Apply the first filter from the unfiltered frame into the filtered
+     * frame, and the rest in place.
+     * @param frame Unfiltered frame
+     * @param filtered Filtered frame
+     */
+    void filterInto(const cv::Mat &frame, cv::Mat &filtered) override;
+
+    // The SOURCE frame is read in place only if every filter is cheap
+    // enough to read it in place
+    bool readsInPlace(void) const override;
+
+    // Raw Bayer frames are filtered only if every filter accepts them
+    bool acceptsMosaic(void) const override;
+
+    // Only the last filter can publish part of the frame
+    cv::Rect publishedRegion(const cv::Size &size) const override;
+
+    // Addresses the filters are made with. They are not connected.
+    const std::string frame_source_address_;
+    const std::string frame_sink_address_;
+
+    // The filters, in the order they are applied
+    std::vector<std::unique_ptr<FrameFilter>> filters_;
+};
+
+}      /* namespace oat */
+#endif /* OAT_FILTERCHAIN_H */
@@ -33,6 +33,7 @@ FrameFilter::FrameFilter(const std::string &frame_source_address,
                          const std::string &frame_sink_address) :
   name_("framefilt[" + frame_source_address + "->" + frame_sink_address + "]")
 , frame_source_address_(frame_source_address)
+, converter_(frame_source_address)
 , frame_sink_address_(frame_sink_address)
 {
     // Nothing
@@ -50,48 +51,302 @@ void FrameFilter::connectToNode() {
     oat::Source<oat::SharedFrameHeader>::ConnectionParameters param =
             frame_source_.parameters();
 
+    // Filters that mix neighbouring pixels must see demosaiced frames
+    demosaic_ = isBayer(param.format) && !acceptsMosaic();
+    if (demosaic_) {
+        param.type = CV_MAKETYPE(CV_MAT_DEPTH(param.type), 3);
+        param.bytes *= 3;
+        param.format = PixelFormat::BGR;
+    }
+
     // Bind to sink node and create a shared cv::Mat
     frame_sink_.bind(frame_sink_address_, param.bytes);
-    shared_frame_ = frame_sink_.retrieve(param.rows, param.cols, param.type);
+    shared_frame_ = frame_sink_.retrieve(param.rows, param.cols, param.type,
+                                         param.format,
+                                         publishedRegion(cv::Size(param.cols, param.rows)));
+
+    if (pipelined_)
+        startPipeline(param);
 }
 
 bool FrameFilter::processFrame() {
 
+    return pipelined_ ? ingestFrame() : processFrameInPlace();
+}
+
+bool FrameFilter::processFrameInPlace() {
+
+    // Wait for sources to read before taking the SOURCE sample, so that
+    // slow readers downstream do not hold up the SINK upstream
+    frame_sink_.wait();
+
     // START CRITICAL SECTION //
     ////////////////////////////
 
-    // Wait for sink to write to node
-    if (frame_source_.wait() == oat::NodeState::END)
+    // Wait for sink to write to node. Give back the SINK slot if there
+    // will be nothing to write to it.
+    if (frame_source_.wait() == oat::NodeState::END) {
+        frame_sink_.cancel();
         return true;
+    }
 
-    // Clone the shared frame
-    frame_source_.copyTo(internal_frame_);
+    // The upstream SINK cannot overwrite the shared frame until the lease
+    // is released
+    auto lease = frame_source_.lease();
+    const oat::Frame &frame = lease.frame();
+    shared_frame_.sample() = frame.sample();
 
-    // Tell sink it can continue
-    frame_source_.post();
+    cv::Mat filtered = shared_frame_;
+    if (readsInPlace()) {
+
+        // Filter straight from the SOURCE frame into the SINK frame
+        if (demosaic_)
+            filterInto(converter_.convert(frame, PixelFormat::BGR), filtered);
+        else
+            filterInto(frame, filtered);
+
+        lease.release();
+
+    } else {
+
+        // Take a private copy so that the upstream SINK is not held up
+        // while the frame is filtered
+        if (demosaic_)
+            oat::convertFrame(frame, frame.format(), input_frame_,
+                              PixelFormat::BGR, -1, conversion_scratch_);
+        else
+            static_cast<const cv::Mat &>(frame).copyTo(input_frame_);
+
+        // Tell sink it can continue
+        lease.release();
+
+        filterInto(input_frame_, filtered);
+    }
+
+    // Filters that reallocate their output could not write in place
+    if (filtered.data != shared_frame_.data)
+        filtered.copyTo(shared_frame_);
 
     ////////////////////////////
     //  END CRITICAL SECTION  //
 
-    // Mess with internal frame
-    filter(internal_frame_);
+    // Tell sources there is new data
+    frame_sink_.post();
+
+    // Sink was not at END state
+    return false;
+}
+
+void FrameFilter::filterInto(const cv::Mat &frame, cv::Mat &filtered) {
+
+    frame.copyTo(filtered);
+    filter(filtered);
+}
+
+void FrameFilter::stop() {
+
+    if (!filter_thread_.joinable())
+        return;
+
+    // Let the stages drain what they hold and exit
+    pipeline_running_ = false;
+    free_.wake();
+    to_filter_.wake();
+    to_publish_.wake();
+
+    filter_thread_.join();
+    publish_thread_.join();
+}
+
+void FrameFilter::startPipeline(
+        const oat::Source<oat::SharedFrameHeader>::ConnectionParameters &param) {
+
+    // Slots hold SINK formatted frames, so filters see the same frames as
+    // when they are not pipelined
+    slots_.resize(PIPELINE_SLOTS);
+    for (size_t i = 0; i < slots_.size(); i++) {
+        slots_[i].frame.create(param.rows, param.cols, param.type);
+        slots_[i].filtered.create(param.rows, param.cols, param.type);
+        free_.push(i);
+    }
+
+    pipeline_running_ = true;
+    filter_thread_ = std::thread(&FrameFilter::filterFrames, this);
+    publish_thread_ = std::thread(&FrameFilter::publishFrames, this);
+}
+
+bool FrameFilter::ingestFrame() {
+
+    // A failed filter or publish stage stops the component
+    rethrowPipelineError();
+
+    // Wait for the publish stage to hand back a slot
+    size_t slot;
+    if (!free_.pop(slot, pipeline_running_)) {
+        rethrowPipelineError();
+        return true;
+    }
+
+    // Wait for sink to write to node
+    if (frame_source_.wait() == oat::NodeState::END) {
+
+        // Publish the frames still in the pipeline
+        to_filter_.push(PIPELINE_END);
+        filter_thread_.join();
+        publish_thread_.join();
+        rethrowPipelineError();
+        return true;
+    }
 
     // START CRITICAL SECTION //
     ////////////////////////////
 
-    // Wait for sources to read
-    frame_sink_.wait();
+    auto lease = frame_source_.lease();
+    const oat::Frame &frame = lease.frame();
 
-    internal_frame_.copyTo(shared_frame_);
+    PipelineSlot &s = slots_[slot];
+    if (demosaic_)
+        oat::convertFrame(frame, frame.format(), s.frame, PixelFormat::BGR,
+                          -1, conversion_scratch_);
+    else
+        static_cast<const cv::Mat &>(frame).copyTo(s.frame);
+    s.sample = frame.sample();
 
-    // Tell sources there is new data
-    frame_sink_.post();
+    // Tell sink it can continue
+    lease.release();
 
     ////////////////////////////
     //  END CRITICAL SECTION  //
 
-    // Sink was not at END state
+    to_filter_.push(slot);
+
     return false;
 }
 
+void FrameFilter::filterFrames() {
+
+    try {
+
+        size_t slot;
+        while (to_filter_.pop(slot, pipeline_running_)) {
+
+            if (slot != PIPELINE_END) {
+
+                PipelineSlot &s = slots_[slot];
+                cv::Mat filtered = s.filtered;
+                filterInto(s.frame, filtered);
+
+                // Filters that reallocate their output could not write in
+                // place
+                if (filtered.data != s.filtered.data)
+                    filtered.copyTo(s.filtered);
+            }
+
+            to_publish_.push(slot);
+
+            if (slot == PIPELINE_END)
+                return;
+        }
+
+    } catch (...) {
+        failPipeline();
+    }
+}
+
+void FrameFilter::publishFrames() {
+
+    try {
+
+        size_t slot;
+        while (to_publish_.pop(slot, pipeline_running_)) {
+
+            if (slot == PIPELINE_END)
+                return;
+
+            const PipelineSlot &s = slots_[slot];
+
+            // START CRITICAL SECTION //
+            ////////////////////////////
+
+            // Wait for sources to read
+            frame_sink_.wait();
+
+            s.filtered.copyTo(shared_frame_);
+            shared_frame_.sample() = s.sample;
+
+            // Tell sources there is new data
+            frame_sink_.post();
+
+            ////////////////////////////
+            //  END CRITICAL SECTION  //
+
+            free_.push(slot);
+        }
+
+    } catch (...) {
+        failPipeline();
+    }
+}
+
+void FrameFilter::failPipeline() {
+
+    {
+        std::lock_guard<std::mutex> lock(pipeline_error_mutex_);
+        if (!pipeline_error_)
+            pipeline_error_ = std::current_exception();
+    }
+
+    // Stop the other stages, and unblock the reading thread so that it can
+    // rethrow
+    pipeline_running_ = false;
+    free_.wake();
+    to_filter_.wake();
+    to_publish_.wake();
+}
+
+void FrameFilter::rethrowPipelineError() {
+
+    std::lock_guard<std::mutex> lock(pipeline_error_mutex_);
+    if (pipeline_error_)
+        std::rethrow_exception(pipeline_error_);
+}
+
+void FrameFilter::SlotRing::push(const size_t slot) {
+
+    ring_.push(slot);
+
+    // Only wake a consumer that is about to sleep. The fences order this
+    // push and the consumer's flag before each side reads the other's, so
+    // either the consumer sees the slot or it is seen waiting. Taking the
+    // lock makes sure it is asleep before it is notified.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiting_.load(std::memory_order_relaxed)) {
+        { std::lock_guard<std::mutex> lock(mutex_); }
+        cv_.notify_one();
+    }
+}
+
+bool FrameFilter::SlotRing::pop(size_t &slot,
+                                const std::atomic<bool> &running) {
+
+    if (ring_.pop(slot))
+        return true;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    waiting_.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    cv_.wait(lock, [this, &running] {
+        return ring_.read_available() > 0 || !running;
+    });
+    waiting_.store(false, std::memory_order_relaxed);
+
+    return ring_.pop(slot);
+}
+
+void FrameFilter::SlotRing::wake() {
+
+    { std::lock_guard<std::mutex> lock(mutex_); }
+    cv_.notify_all();
+}
+
 } /* namespace oat */
@@ -20,11 +20,19 @@
 #ifndef OAT_FRAMEFILT_H
 #define	OAT_FRAMEFILT_H
 
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
+#include <boost/lockfree/spsc_queue.hpp>
 
 #include "../../lib/datatypes/Frame.h"
 #include "../../lib/shmemdf/Source.h"
 #include "../../lib/shmemdf/Sink.h"
+#include "../../lib/utility/FrameConverter.h"
 
 namespace oat {
 
@@ -47,7 +55,7 @@ public:
     FrameFilter(const std::string &frame_source_address,
                 const std::string &frame_sink_address);
 
-    virtual ~FrameFilter() { };
+    virtual ~FrameFilter() { stop(); };
 
     /**
      * FrameServers must be able to connect to a Source and Sink
@@ -57,11 +65,29 @@ public:
 
     /**
      * Obtain raw frame from SOURCE. Apply filter function to raw frame. Publish
-     * filtered frame to SINK.
+     * filtered frame to SINK. When pipelined, only the frame is read here.
+     * It is filtered and published on separate threads.
      * @return SOURCE end-of-stream signal. If true, this component should exit.
      */
     virtual bool processFrame(void);
 
+    /**
+     * Stop the filter and publish threads of a pipelined filter once the
+     * frames they already hold have been published. Must be called before
+     * a derived filter is destroyed, since the filter thread calls into it.
+     */
+    void stop(void);
+
+    /**
+     * Read, filter and publish frames on three threads instead of one, so
+     * that a frame is filtered while the next is read and the last is
+     * published. Throughput is then limited by the slowest stage rather than
+     * by the sum of the stages, at the cost of a frame copy into and out of
+     * the pipeline. Must be set before connectToNode().
+     * @param value True to pipeline.
+     */
+    void set_pipelined(const bool value) { pipelined_ = value; }
+
     /**
      * Configure filter parameters.
      * @param config_file configuration file path
@@ -78,23 +104,63 @@ public:
 
 protected:
 
+    // Chains apply other filters directly
+    friend class FilterChain;
+
     /**
      * Perform frame filtering.
      * @param frame to be filtered
      */
     virtual void filter(cv::Mat& frame) = 0;
 
+    /**
+     * Perform frame filtering without modifying the input frame. The
+     * default implementation copies frame to filtered and filters it in
+     * place. Filters that can read from one buffer and write to another
+     * should override this to avoid the copy.
+     * @param frame Unfiltered frame. Refers to SOURCE shared memory if
+     * readsInPlace().
+     * @param filtered Preallocated filtered frame. Refers to SINK shared
+     * memory.
+     */
+    virtual void filterInto(const cv::Mat &frame, cv::Mat &filtered);
+
+    /**
+     * @return True if the filter is cheap enough to read the SOURCE frame
+     * in place, e.g. a single pass over the frame. The upstream SINK cannot
+     * write its next frame while the filter runs. Otherwise, the frame is
+     * copied and the SOURCE released before filtering. By default, false.
+     */
+    virtual bool readsInPlace(void) const { return false; }
+
+    /**
+     * @return False if the filter combines neighbouring pixels (e.g. by
+     * interpolation), and so must be given demosaiced frames when the SOURCE
+     * publishes raw Bayer frames. The SINK then publishes BGR frames.
+     * Otherwise, frames are filtered and published in the SOURCE's format.
+     */
+    virtual bool acceptsMosaic(void) const { return true; }
+
+    /**
+     * @param size Size of the frames from SOURCE.
+     * @return Region of the filtered frame that is published to SINK. The
+     * whole frame is filtered into shared memory, and readers view the
+     * region in place. By default, the whole frame.
+     */
+    virtual cv::Rect publishedRegion(const cv::Size &size) const {
+        return cv::Rect(cv::Point(0, 0), size);
+    }
+
 private:
 
     // Filter name.
     const std::string name_;
 
-    // Currently processed frame
-    oat::Frame internal_frame_;
-
     // Frame source
     const std::string frame_source_address_;
     oat::Source<oat::SharedFrameHeader> frame_source_;
+    oat::FrameConverter converter_;
+    bool demosaic_ {false};
 
     // Frame sink
     const std::string frame_sink_address_;
@@ -102,6 +168,64 @@ private:
 
     // Currently acquired, shared frame
     oat::Frame shared_frame_;
+
+    // Private copy of the SOURCE frame for filters that do not read in
+    // place
+    cv::Mat input_frame_;
+
+    /**
+     * Read, filter and publish frames one at a time on the calling thread.
+     */
+    bool processFrameInPlace(void);
+
+    // Pipelined execution. Frames pass between stages in preallocated slots
+    // whose indices travel around lock-free rings: free -> filter ->
+    // publish -> free. A slot holds one frame in one stage at a time, and
+    // the rings keep frames in order.
+    static constexpr size_t PIPELINE_SLOTS {3};
+    static constexpr size_t PIPELINE_END {static_cast<size_t>(-1)};
+
+    struct PipelineSlot {
+        cv::Mat frame;
+        cv::Mat filtered;
+        oat::Sample sample;
+    };
+
+    /**
+     * Ring of slot indices between a pair of stages. The consuming stage
+     * only sleeps when the ring is empty.
+     */
+    class SlotRing {
+
+    public:
+        void push(const size_t slot);
+        bool pop(size_t &slot, const std::atomic<bool> &running);
+        void wake(void);
+
+    private:
+        // Holds every slot and the end of stream marker
+        boost::lockfree::spsc_queue<
+            size_t, boost::lockfree::capacity<PIPELINE_SLOTS + 1>> ring_;
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        std::atomic<bool> waiting_ {false};
+    };
+
+    bool pipelined_ {false};
+    std::atomic<bool> pipeline_running_ {false};
+    std::vector<PipelineSlot> slots_;
+    SlotRing free_, to_filter_, to_publish_;
+    std::thread filter_thread_, publish_thread_;
+    std::mutex pipeline_error_mutex_;
+    std::exception_ptr pipeline_error_;
+    cv::Mat conversion_scratch_;
+
+    void startPipeline(const oat::Source<oat::SharedFrameHeader>::ConnectionParameters &param);
+    bool ingestFrame(void);
+    void filterFrames(void);
+    void publishFrames(void);
+    void failPipeline(void);
+    void rethrowPipelineError(void);
 };
 
 }      /* namespace oat */
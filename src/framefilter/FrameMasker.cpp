@@ -19,6 +19,10 @@
 
 #include "FrameMasker.h"
 
+#include <cstring>
+#include <vector>
+
+#include <opencv2/core.hpp>
 #include <opencv2/core/mat.hpp>
 #include <opencv2/imgproc.hpp>
 #include <opencv2/highgui.hpp>
@@ -40,7 +44,7 @@ void FrameMasker::configure(const std::string &config_file,
                             const std::string &config_key) {
 
     // Available options
-    std::vector<std::string> options {"mask"};
+    std::vector<std::string> options {"mask", "crop"};
 
     // This will throw cpptoml::parse_exception if a file
     // with invalid TOML is provided
@@ -57,13 +61,31 @@ void FrameMasker::configure(const std::string &config_file,
 
         std::string mask_path;
         oat::config::getValue(this_config, "mask", mask_path, true);
-        roi_mask_ = cv::imread(mask_path, CV_LOAD_IMAGE_GRAYSCALE);
+        cv::Mat mask = cv::imread(mask_path, CV_LOAD_IMAGE_GRAYSCALE);
 
-        if (roi_mask_.data == NULL)
+        if (mask.data == NULL)
             throw (std::runtime_error("File \"" + mask_path + "\" could not be read."));
 
+        // Binarize the mask and find the bounding box of the kept pixels
+        // once, rather than for each frame
+        cv::compare(mask, 0, roi_mask_, cv::CMP_NE);
+
+        std::vector<cv::Point> kept;
+        cv::findNonZero(roi_mask_, kept);
+        mask_box_ = kept.empty() ? cv::Rect() : cv::boundingRect(kept);
+
+        // Start the box on an even pixel so that a cropped raw frame keeps
+        // its Bayer pattern
+        mask_box_.width += mask_box_.x & 1;
+        mask_box_.height += mask_box_.y & 1;
+        mask_box_.x &= ~1;
+        mask_box_.y &= ~1;
+
+        byte_mask_.release();
         mask_set_ = true;
 
+        oat::config::getValue(this_config, "crop", crop_);
+
     } else {
         throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
     }
@@ -71,10 +93,79 @@ void FrameMasker::configure(const std::string &config_file,
 
 void FrameMasker::filter(cv::Mat &frame) {
 
-    // Throws cv::Exception if there is a size mismatch between mask and frames
-    // received from SOURCE or in any case where setTo() assertions fail.
-    if (mask_set_)
-        frame.setTo(0, roi_mask_ == 0);
+    // Masking works in place
+    filterInto(frame, frame);
+}
+
+void FrameMasker::filterInto(const cv::Mat &frame, cv::Mat &filtered) {
+
+    if (!mask_set_) {
+        if (filtered.data != frame.data)
+            frame.copyTo(filtered);
+        return;
+    }
+
+    if (frame.size() != roi_mask_.size())
+        throw (std::runtime_error("Mask and frames from SOURCE must have the "
+                                  "same dimensions."));
+
+    const int elem_size = frame.elemSize();
+    if (byte_mask_.cols != frame.cols * elem_size)
+        expandMask(elem_size);
+
+    // View pixels as bytes so that one kernel masks every frame type
+    const cv::Mat in(frame.rows, frame.cols * elem_size, CV_8UC1,
+                     frame.data, frame.step);
+    cv::Mat out(filtered.rows, filtered.cols * elem_size, CV_8UC1,
+                filtered.data, filtered.step);
+    const cv::Rect box(mask_box_.x * elem_size, mask_box_.y,
+                       mask_box_.width * elem_size, mask_box_.height);
+
+    // Zero everything outside of the bounding box. Not needed when only the
+    // box is published.
+    if (!crop_ || box.area() == 0) {
+        for (int i = 0; i < out.rows; i++) {
+
+            uchar *row = out.ptr(i);
+            if (i < box.y || i >= box.y + box.height) {
+                std::memset(row, 0, out.cols);
+            } else {
+                std::memset(row, 0, box.x);
+                std::memset(row + box.x + box.width, 0,
+                            out.cols - box.x - box.width);
+            }
+        }
+    }
+
+    // Vectorized AND of the bounding box with the mask
+    if (box.area() > 0) {
+        cv::Mat out_box = out(box);
+        cv::bitwise_and(in(box), byte_mask_(box), out_box);
+    }
+}
+
+cv::Rect FrameMasker::publishedRegion(const cv::Size &size) const {
+
+    if (!crop_ || mask_box_.area() == 0)
+        return cv::Rect(cv::Point(0, 0), size);
+
+    if (size != roi_mask_.size())
+        throw (std::runtime_error("Mask and frames from SOURCE must have the "
+                                  "same dimensions."));
+
+    return mask_box_;
+}
+
+void FrameMasker::expandMask(const size_t elem_size) {
+
+    if (elem_size == 1) {
+        byte_mask_ = roi_mask_;
+        return;
+    }
+
+    cv::Mat repeated;
+    cv::merge(std::vector<cv::Mat>(elem_size, roi_mask_), repeated);
+    byte_mask_ = repeated.reshape(1);
 }
 
 } /* namespace oat */
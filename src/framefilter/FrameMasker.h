@@ -54,11 +54,42 @@ private:
      */
     void filter(cv::Mat& frame) override;
 
+    /**
+     * Apply frame mask without copying the unfiltered frame.
+     * @param frame Unfiltered frame
+     * @param filtered Filtered frame
+     */
+    void filterInto(const cv::Mat &frame, cv::Mat &filtered) override;
+
+    // Masking is a single pass over the frame
+    bool readsInPlace(void) const override { return true; }
+
+    // Publish only the mask's bounding box if cropping
+    cv::Rect publishedRegion(const cv::Size &size) const override;
+
+    /**
+     * Repeat each mask pixel once for each byte of a frame pixel, so that
+     * frames of any type can be masked bytewise.
+     * @param elem_size Bytes per frame pixel
+     */
+    void expandMask(const size_t elem_size);
+
     // Do we have a mask to work with
     bool mask_set_ = false;
 
-    // Mask frames with an arbitrary ROI
+    // Mask frames with an arbitrary ROI. 255 where pixels are kept, 0
+    // elsewhere.
     cv::Mat roi_mask_;
+
+    // Bounding box of the kept pixels. Pixels outside of it are zeroed
+    // without reading the frame.
+    cv::Rect mask_box_;
+
+    // roi_mask_ repeated for each byte of a frame pixel
+    cv::Mat byte_mask_;
+
+    // Publish only the bounding box of the mask
+    bool crop_ {false};
 };
 
 }      /* namespace oat */
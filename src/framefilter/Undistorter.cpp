@@ -99,18 +99,10 @@ void Undistorter::configure(const std::string &config_file,
 
         }
 
-        if (oat::config::getValue(this_config, "rotation", rotation_deg_, 0.0, 360.0)) {
-            // TODO: modify camera matrix to encapuslate rotation operation
-            //cv::Matx33d R;
-            //cv::Point center = cv::Point(frame.cols/2, frame.rows/2 );
-            //cv::Mat rm = cv::getRotationMatrix2D(center, rotation_deg_, 1.0);
-            //R(0, 2) = 0;
-            //R(2, 0) = 0;
-            //R(2, 2) = 1;
-            //rm.copyTo(R(cv::Rect(0,0,2,2)));
-            //std::cout << "Rotation matrix: " << R;
-            //camera_matrix_ = camera_matrix_ * R;
-        }
+        oat::config::getValue(this_config, "rotation", rotation_deg_, 0.0, 360.0);
+
+        // Rebuild remap tables using the new parameters
+        map1_.release();
 
     } else {
         throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
@@ -119,18 +111,50 @@ void Undistorter::configure(const std::string &config_file,
 
 void Undistorter::filter(cv::Mat& frame) {
 
-    cv::Mat temp = frame.clone();
+    // Undistortion cannot be performed in place
+    frame.copyTo(input_);
+    filterInto(input_, frame);
+}
+
+void Undistorter::filterInto(const cv::Mat &frame, cv::Mat &filtered) {
+
+    if (map1_.empty() || map1_.size() != frame.size())
+        buildMaps(frame.size());
+
+    // A single pass that undistorts and rotates. cv::remap splits the frame
+    // into row stripes that are processed in parallel, and writes straight
+    // into filtered since it is preallocated.
+    cv::remap(frame, filtered, map1_, map2_, cv::INTER_LINEAR,
+              cv::BORDER_CONSTANT);
+}
+
+void Undistorter::buildMaps(const cv::Size &size) {
 
+    // Source pixel of each undistorted pixel
+    cv::Mat map_x, map_y;
     switch (camera_model_) {
         case CameraModel::PINHOLE :
         {
-            cv::undistort(temp, frame, camera_matrix_, distortion_coefficients_);
+            cv::initUndistortRectifyMap(camera_matrix_,
+                                        distortion_coefficients_,
+                                        cv::noArray(),
+                                        camera_matrix_,
+                                        size,
+                                        CV_32FC1,
+                                        map_x,
+                                        map_y);
             break;
         }
         case CameraModel::FISHEYE :
         {
-            cv::fisheye::undistortImage(temp, frame, camera_matrix_,
-                    distortion_coefficients_, cv::Matx33d::eye());
+            cv::fisheye::initUndistortRectifyMap(camera_matrix_,
+                                                 distortion_coefficients_,
+                                                 cv::Matx33d::eye(),
+                                                 cv::Matx33d::eye(),
+                                                 size,
+                                                 CV_32FC1,
+                                                 map_x,
+                                                 map_y);
             break;
         }
         default :
@@ -139,12 +163,45 @@ void Undistorter::filter(cv::Mat& frame) {
         }
     }
 
+    // Rotating the maps by the rotation applied to the undistorted frame
+    // gives the source pixel of each rotated pixel. The border is
+    // replicated so that interpolation along the frame's edge never blends
+    // a coordinate with an out of frame marker.
     if (rotation_deg_ != 0.0) {
-        cv::Point center = cv::Point(frame.cols/2, frame.rows/2 );
+        cv::Point center = cv::Point(size.width/2, size.height/2);
         rotation_matrix_ = cv::getRotationMatrix2D(center, rotation_deg_, 1.0);
-        cv::warpAffine(frame, frame, rotation_matrix_, frame.size());
+
+        cv::Mat rotated_x, rotated_y;
+        cv::warpAffine(map_x, rotated_x, rotation_matrix_, size,
+                       cv::INTER_LINEAR, cv::BORDER_REPLICATE);
+        cv::warpAffine(map_y, rotated_y, rotation_matrix_, size,
+                       cv::INTER_LINEAR, cv::BORDER_REPLICATE);
+
+        // Pixels rotated in from outside the undistorted frame map to -1,
+        // which remap fills with the border, as warpAffine did
+        cv::Matx23d inverse;
+        cv::invertAffineTransform(rotation_matrix_, inverse);
+        const double max_x = size.width - 1, max_y = size.height - 1;
+        for (int i = 0; i < size.height; i++) {
+
+            float *x = rotated_x.ptr<float>(i);
+            float *y = rotated_y.ptr<float>(i);
+            for (int j = 0; j < size.width; j++) {
+
+                const double u = inverse(0, 0) * j + inverse(0, 1) * i + inverse(0, 2);
+                const double v = inverse(1, 0) * j + inverse(1, 1) * i + inverse(1, 2);
+                if (u < 0 || u > max_x || v < 0 || v > max_y) {
+                    x[j] = -1;
+                    y[j] = -1;
+                }
+            }
+        }
+
+        map_x = rotated_x;
+        map_y = rotated_y;
     }
 
+    cv::convertMaps(map_x, map_y, map1_, map2_, CV_16SC2);
 }
 
 } /* namespace oat */
@@ -47,8 +47,14 @@ public:
                    const std::string &config_key) override;
 
     // Accessors
-    void set_camera_matrix(const cv::Matx33d& value) { camera_matrix_ = value; }
-    void set_distortion_coefficients(const cv::Mat& value) { distortion_coefficients_ = value.clone(); }
+    void set_camera_matrix(const cv::Matx33d& value) {
+        camera_matrix_ = value;
+        map1_.release();
+    }
+    void set_distortion_coefficients(const cv::Mat& value) {
+        distortion_coefficients_ = value.clone();
+        map1_.release();
+    }
 
 private:
 
@@ -68,13 +74,37 @@ private:
      */
     void filter(cv::Mat& frame) override;
 
+    /**
+     * Apply undistortion filter without copying the unfiltered frame.
+     * @param frame Unfiltered frame
+     * @param filtered Filtered frame
+     */
+    void filterInto(const cv::Mat &frame, cv::Mat &filtered) override;
+
+    // Undistortion interpolates between neighbouring pixels
+    bool acceptsMosaic(void) const override { return false; }
+
     CameraModel camera_model_ {CameraModel::PINHOLE};
     cv::Matx33d camera_matrix_  {cv::Matx33d::eye()};
     std::vector<double> distortion_coefficients_ {0,0,0,0,0,0,0,0};
 
     // Negative implied no rotation
     double rotation_deg_ = 0.0;
-    cv::Matx23d rotation_matrix_; 
+    cv::Matx23d rotation_matrix_;
+
+    /**
+     * Compose the undistortion and rotation into a single pair of fixed
+     * point remap tables for frames of the given size.
+     * @param size Frame size
+     */
+    void buildMaps(const cv::Size &size);
+
+    // Remap tables (CV_16SC2 integer coordinates and CV_16UC1 interpolation
+    // weights), built on the first frame
+    cv::Mat map1_, map2_;
+
+    // Copy of the unfiltered frame for in place filtering
+    cv::Mat input_;
 };
 
 }      /* namespace oat */
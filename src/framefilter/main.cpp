@@ -34,6 +34,7 @@
 #include "FrameFilter.h"
 #include "BackgroundSubtractor.h"
 #include "BackgroundSubtractorMOG.h"
+#include "FilterChain.h"
 #include "FrameMasker.h"
 #include "Undistorter.h"
 
@@ -51,7 +52,8 @@ void printUsage(po::options_description options){
               << "  bsub: Background subtraction\n"
               << "  mask: Binary mask\n"
               << "  mog: Mixture of Gaussians background segmentation.\n"
-              << "  undistort: Compensate for lens distortion using distortion model.\n\n"
+              << "  undistort: Compensate for lens distortion using distortion model.\n"
+              << "  chain: Apply several of the above filters in order.\n\n"
               << "SOURCE:\n"
               << "  User-supplied name of the memory segment to receive frames "
               << "from (e.g. raw).\n\n"
@@ -81,9 +83,18 @@ void run(const std::shared_ptr<oat::FrameFilter>& filter) {
 
         // Error code 1 indicates a SIGNINT during a call to wait(), which
         // is normal behavior
-        if (ex.get_error_code() != 1)
+        if (ex.get_error_code() != 1) {
+            filter->stop();
             throw;
+        }
+
+    } catch (...) {
+        filter->stop();
+        throw;
     }
+
+    // Join pipeline threads while the filter is still whole
+    filter->stop();
 }
 
 int main(int argc, char *argv[]) {
@@ -95,6 +106,7 @@ int main(int argc, char *argv[]) {
     std::string sink;
     std::vector<std::string> config_fk;
     bool config_used = false;
+    bool pipelined = false;
     po::options_description visible_options("OPTIONS");
 
     std::unordered_map<std::string, char> type_hash;
@@ -102,6 +114,7 @@ int main(int argc, char *argv[]) {
     type_hash["mask"] = 'b';
     type_hash["mog"] = 'c';
     type_hash["undistort"] = 'd';
+    type_hash["chain"] = 'e';
 
     try {
 
@@ -115,6 +128,10 @@ int main(int argc, char *argv[]) {
         config.add_options()
                 ("config,c", po::value<std::vector<std::string> >()->multitoken(),
                 "Configuration file/key pair.")
+                ("pipeline,p", "Read, filter and publish frames on separate "
+                 "threads, so that throughput is limited by the slowest of the "
+                 "three rather than by their sum. Costs a frame copy into and "
+                 "out of the pipeline.")
                 ;
 
         po::options_description hidden("HIDDEN OPTIONS");
@@ -125,7 +142,8 @@ int main(int argc, char *argv[]) {
                 "  bsub: Background subtractor.\n"
                 "  mask: Binary mask.\n"
                 "  mog: Mixture of Gaussians background segmentation.\n"
-                "  undistort: Compensate for lens distortion using distortion model.\n")
+                "  undistort: Compensate for lens distortion using distortion model.\n"
+                "  chain: Apply several of the above filters in order.\n")
                 ("source", po::value<std::string>(&source),
                 "The name of the SOURCE that supplies images on which to perform background subtraction."
                 "The server must be of type SMServer<SharedCVMatHeader>\n")
@@ -186,6 +204,9 @@ int main(int argc, char *argv[]) {
             return -1;
         }
 
+        if (variable_map.count("pipeline"))
+            pipelined = true;
+
         if (!variable_map["config"].empty()) {
 
             config_fk = variable_map["config"].as<std::vector<std::string> >();
@@ -240,6 +261,15 @@ int main(int argc, char *argv[]) {
                          " This filter does nothing but waste CPU cycles.\n");
             break;
         }
+        case 'e':
+        {
+            filter = std::make_shared<oat::FilterChain>(source, sink);
+            if (!config_used)
+                 std::cerr << oat::whoWarn(filter->name(),
+                         "No chain configuration was provided."
+                         " This filter does nothing but waste CPU cycles.\n");
+            break;
+        }
         default:
         {
             printUsage(visible_options);
@@ -254,6 +284,8 @@ int main(int argc, char *argv[]) {
         if (config_used)
             filter->configure(config_fk[0], config_fk[1]);
 
+        filter->set_pipelined(pipelined);
+
         // Tell user
         std::cout << oat::whoMessage(filter->name(),
                 "Listening to source " + oat::sourceText(source) + ".\n")
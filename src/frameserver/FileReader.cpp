@@ -18,6 +18,8 @@
 //******************************************************************************
 
 #include <chrono>
+#include <functional>
+#include <mutex>
 #include <string>
 #include <thread>
 #include <opencv2/videoio.hpp>
@@ -25,6 +27,7 @@
 #include <cpptoml.h>
 #include "../../lib/utility/OatTOMLSanitize.h"
 #include "../../lib/utility/IOFormat.h"
+#include "../../lib/utility/make_unique.h"
 
 #include "FileReader.h"
 
@@ -40,8 +43,12 @@ FileReader::FileReader(const std::string &image_sink_address,
 {
 
     // Default config
-    calculateFramePeriod();
-    tick_ = clock_.now();
+    pacer_.set_rate_hz(frames_per_second_);
+}
+
+FileReader::~FileReader() {
+
+    stopDecoding();
 }
 
 void FileReader::connectToNode() {
@@ -49,47 +56,73 @@ void FileReader::connectToNode() {
     cv::Mat example_frame;
     file_reader_ >> example_frame;
 
-    if (use_roi_)
-        example_frame = example_frame(region_of_interest_);
+    // Whole frames are decoded into shared memory, and only the region of
+    // interest is published
+    bindFrameSink(example_frame);
 
-    frame_sink_.bind(frame_sink_address_,
-            example_frame.total() * example_frame.elemSize());
-
-    shared_frame_ = frame_sink_.retrieve(
-            example_frame.rows, example_frame.cols, example_frame.type());
+    // Tell the user if the SINK fell back to ordinary pages
+    checkPagePolicy();
 
     // Reset the video to the start
     file_reader_.set(CV_CAP_PROP_POS_AVI_RATIO, 0);
 
-    // Put the sample rate in the shared frame
-    shared_frame_.sample().set_rate_hz(1.0 / frame_period_in_sec_.count());
+    // Put the sample rate in the shared frame. Unthrottled playback keeps
+    // the file's own rate.
+    const double file_fps = file_reader_.get(CV_CAP_PROP_FPS);
+    if (frames_per_second_ > 0)
+        shared_frame_.sample().set_rate_hz(frames_per_second_);
+    else if (file_fps > 0)
+        shared_frame_.sample().set_rate_hz(file_fps);
+    else
+        shared_frame_.sample().set_rate_hz(1000000.0); // Need something
+
+    if (workers_ > 1)
+        startSegmentDecoding(example_frame);
+    else if (prefetch_ > 0)
+        startDecoding(example_frame);
+
+    pacer_.start();
 }
 
 bool FileReader::serveFrame() {
 
+    // Get the next decoded frame before readers are locked out
+    const bool decoded_ahead = workers_ > 1 || prefetch_ > 0;
+    size_t index = 0;
+    cv::Mat decoded;
+    if (workers_ > 1) {
+        decoded = takeSegmentFrame();
+        frame_empty_ = decoded.empty();
+    } else if (prefetch_ > 0) {
+        index = takeDecoded();
+        decoded = pool_[index];
+        frame_empty_ = decoded.empty();
+    }
+
     // START CRITICAL SECTION //
     ////////////////////////////
 
     // Wait for sources to read
     frame_sink_.wait();
 
-    // Crop if necessary
-    if (!use_roi_) {
-            
-        file_reader_ >> shared_frame_;
-        frame_empty_ = shared_frame_.empty();
+    // Get the ring slot that will be published next
+    shared_frame_ = frame_sink_.retrieve();
+
+    if (decoded_ahead) {
+
+        if (!frame_empty_)
+            copyToSharedFrame(decoded);
 
     } else {
 
-        oat::Frame to_crop;
-        file_reader_ >> to_crop;
-        if (!(frame_empty_ = to_crop.empty()))
-            to_crop = to_crop(region_of_interest_);
-        to_crop.copyTo(shared_frame_);
+        // Decode straight into the shared frame
+        cv::Mat frame = shared_frame_;
+        file_reader_ >> frame;
+        frame_empty_ = frame.empty();
     }
 
     // Increment sample count
-    shared_frame_.sample().incrementCount();
+    incrementSampleCount();
 
     // Tell sources there is new data
     frame_sink_.post();
@@ -97,20 +130,232 @@ bool FileReader::serveFrame() {
     ////////////////////////////
     //  END CRITICAL SECTION  //
 
+    if (workers_ > 1)
+        giveBackSegmentFrame();
+    else if (prefetch_ > 0)
+        giveBack(index);
 
-    std::this_thread::sleep_for(frame_period_in_sec_ - (clock_.now() - tick_));
-    tick_ = clock_.now();
+    pace();
 
     return frame_empty_;
 }
 
+void FileReader::startDecoding(const cv::Mat &example_frame) {
+
+    // Preallocate the frames that are decoded into
+    pool_.resize(prefetch_);
+    for (size_t i = 0; i < prefetch_; i++) {
+        pool_[i].create(example_frame.rows, example_frame.cols, example_frame.type());
+        free_.push_back(i);
+    }
+
+    decoding_ = true;
+    decode_thread_ = std::thread(&FileReader::decodeAhead, this);
+}
+
+void FileReader::startSegmentDecoding(const cv::Mat &example_frame) {
+
+    // Each worker needs its own decoder and room for a whole segment so
+    // that it can run ahead of the segment being served
+    for (size_t k = 0; k < workers_; k++) {
+
+        auto decoder = std::make_unique<SegmentDecoder>();
+        if (!decoder->capture.open(file_name_))
+            throw (std::runtime_error("Could not open " + file_name_
+                                      + " for segment decoding."));
+
+        decoder->frames.resize(segment_);
+        for (auto &f : decoder->frames)
+            f.create(example_frame.rows, example_frame.cols, example_frame.type());
+
+        decoder->segment = k;
+        segment_decoders_.push_back(std::move(decoder));
+    }
+
+    decoding_ = true;
+    for (auto &d : segment_decoders_)
+        d->thread = std::thread(&FileReader::decodeSegments, this, std::ref(*d));
+}
+
+void FileReader::stopDecoding() {
+
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        decoding_ = false;
+    }
+    free_cv_.notify_all();
+
+    if (decode_thread_.joinable())
+        decode_thread_.join();
+
+    for (auto &d : segment_decoders_)
+        if (d->thread.joinable())
+            d->thread.join();
+}
+
+void FileReader::decodeAhead() {
+
+    for (;;) {
+
+        std::unique_lock<std::mutex> lock(pool_mutex_);
+        free_cv_.wait(lock, [this] { return !free_.empty() || !decoding_; });
+        if (!decoding_)
+            return;
+
+        const size_t index = free_.back();
+        free_.pop_back();
+        lock.unlock();
+
+        // An empty frame marks the end of the file
+        bool eof;
+        try {
+            file_reader_ >> pool_[index];
+            eof = pool_[index].empty();
+        } catch (...) {
+            pool_[index].release();
+            lock.lock();
+            decode_error_ = std::current_exception();
+            eof = true;
+            lock.unlock();
+        }
+
+        lock.lock();
+        decoded_.push_back(index);
+        lock.unlock();
+        decoded_cv_.notify_one();
+
+        if (eof)
+            return;
+    }
+}
+
+size_t FileReader::takeDecoded() {
+
+    std::unique_lock<std::mutex> lock(pool_mutex_);
+    decoded_cv_.wait(lock, [this] { return !decoded_.empty(); });
+
+    if (decode_error_)
+        std::rethrow_exception(decode_error_);
+
+    const size_t index = decoded_.front();
+    decoded_.pop_front();
+    return index;
+}
+
+void FileReader::giveBack(const size_t index) {
+
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        free_.push_back(index);
+    }
+    free_cv_.notify_one();
+}
+
+void FileReader::decodeSegments(SegmentDecoder &decoder) {
+
+    for (;;) {
+
+        // Wait for the previous segment to be served
+        std::unique_lock<std::mutex> lock(pool_mutex_);
+        free_cv_.wait(lock, [this, &decoder] { return !decoder.done || !decoding_; });
+        if (!decoding_)
+            return;
+
+        const uint64_t segment = decoder.segment;
+        lock.unlock();
+
+        // An empty frame marks the end of the file
+        bool eof = false;
+        try {
+
+            // The decoder seeks to the keyframe at or before the first frame
+            // of the segment and decodes forward from there
+            const double first = static_cast<double>(segment * segment_);
+            if (!decoder.capture.set(CV_CAP_PROP_POS_FRAMES, first))
+                throw (std::runtime_error("Cannot seek in " + file_name_
+                        + ". Set workers = 1 to decode it sequentially."));
+
+            for (size_t i = 0; i < segment_ && !eof; i++) {
+
+                decoder.capture >> decoder.frames[i];
+                eof = decoder.frames[i].empty();
+
+                // The segment is marked done along with its last frame so
+                // that it cannot be handed back before it is finished
+                lock.lock();
+                if (!eof)
+                    decoder.decoded = i + 1;
+                decoder.done = eof || decoder.decoded == segment_;
+                const bool stop = !decoding_;
+                lock.unlock();
+                decoded_cv_.notify_one();
+
+                if (stop)
+                    return;
+            }
+
+        } catch (...) {
+            lock.lock();
+            decoder.error = std::current_exception();
+            decoder.done = true;
+            lock.unlock();
+            decoded_cv_.notify_one();
+            return;
+        }
+
+        if (eof)
+            return;
+    }
+}
+
+cv::Mat FileReader::takeSegmentFrame() {
+
+    SegmentDecoder &decoder = *segment_decoders_[serving_segment_ % workers_];
+
+    std::unique_lock<std::mutex> lock(pool_mutex_);
+    decoded_cv_.wait(lock, [this, &decoder] {
+        return decoder.decoded > serving_index_ || decoder.done;
+    });
+
+    if (decoder.decoded > serving_index_)
+        return decoder.frames[serving_index_];
+
+    // Frames decoded before a failure are served first
+    if (decoder.error)
+        std::rethrow_exception(decoder.error);
+
+    // The file ended inside this segment
+    return cv::Mat();
+}
+
+void FileReader::giveBackSegmentFrame() {
+
+    if (++serving_index_ < segment_)
+        return;
+
+    // The whole segment has been served, so its decoder can move on to the
+    // segment workers_ further along
+    SegmentDecoder &decoder = *segment_decoders_[serving_segment_ % workers_];
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        decoder.segment += workers_;
+        decoder.decoded = 0;
+        decoder.done = false;
+    }
+    free_cv_.notify_all();
+
+    serving_segment_++;
+    serving_index_ = 0;
+}
+
 void FileReader::configure() { }
 
 void FileReader::configure(const std::string& config_file,
                            const std::string& config_key) {
 
     // Available options
-    std::vector<std::string> options {"fps", "roi"};
+    std::vector<std::string> options {"fps", "roi", "prefetch", "workers",
+                                      "segment"};
 
     // This will throw cpptoml::parse_exception if a file
     // with invalid TOML is provided
@@ -122,18 +367,29 @@ void FileReader::configure(const std::string& config_file,
         // Get this components configuration table
         auto this_config = config->get_table(config_key);
 
-        // Check for unknown options in the table and throw if you find them
-        oat::config::checkKeys(options, this_config);
+        // Check for unknown options and apply the options of all servers
+        configureNode(this_config, options);
 
         // Set the frame rate
         oat::config::getValue(this_config, "fps", frames_per_second_, 0.0);
-        calculateFramePeriod();
+        pacer_.set_rate_hz(frames_per_second_);
+
+        // Set the number of frames decoded ahead
+        int64_t prefetch;
+        if (oat::config::getValue(this_config, "prefetch", prefetch, (int64_t)0))
+            prefetch_ = prefetch;
+
+        // Set the number of parallel segment decoders and the segment length
+        int64_t val;
+        if (oat::config::getValue(this_config, "workers", val, (int64_t)1))
+            workers_ = val;
+        if (oat::config::getValue(this_config, "segment", val, (int64_t)1))
+            segment_ = val;
 
         // Set the ROI
         oat::config::Table roi;
         if (oat::config::getTable(this_config, "roi", roi)) {
 
-            int64_t val;
             oat::config::getValue(roi, "x_offset", val, (int64_t)0, true);
             region_of_interest_.x = val;
             oat::config::getValue(roi, "y_offset", val, (int64_t)0, true);
@@ -150,12 +406,4 @@ void FileReader::configure(const std::string& config_file,
     }
 }
 
-void FileReader::calculateFramePeriod() {
-
-    std::chrono::duration<double> frame_period {1.0 / frames_per_second_};
-
-    // Automatic conversion
-    frame_period_in_sec_ = frame_period;
-}
-
 } /* namespace oat */
@@ -21,8 +21,14 @@
 #define	OAT_FILEREADER_H
 
 #include <chrono>
-#include <limits>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 #include <opencv2/videoio.hpp>
 
 #include "FrameServer.h"
@@ -34,7 +40,9 @@ public:
 
     FileReader(const std::string &file_name_in,
                const std::string &image_sink_name,
-               const double frames_per_second = std::numeric_limits<double>::max());
+               const double frames_per_second = 0.0);
+
+    ~FileReader();
 
     // Implement FrameServer interface
     void configure(void) override;
@@ -49,14 +57,51 @@ private:
     std::string file_name_;
     cv::VideoCapture file_reader_;
 
-    // Playback speed
-    double frames_per_second_;
-    void calculateFramePeriod(void);
+    // Decode whole frames on a separate thread so that only a copy of the
+    // region of interest happens while readers are locked out. prefetch_
+    // frames are decoded ahead. 0 decodes straight into the shared frame
+    // inside the critical section.
+    size_t prefetch_ {2};
+    bool decoding_ {false};
+    std::vector<cv::Mat> pool_;
+    std::deque<size_t> decoded_;
+    std::vector<size_t> free_;
+    std::mutex pool_mutex_;
+    std::condition_variable decoded_cv_, free_cv_;
+    std::thread decode_thread_;
+    std::exception_ptr decode_error_;
+
+    // Offline runs can instead split the file into segments of segment_
+    // frames that are decoded in parallel by workers_ threads, each with
+    // its own decoder. Worker k decodes segments k, k + workers_, ... and
+    // the segments are served in order.
+    size_t workers_ {1};
+    size_t segment_ {64};
+    struct SegmentDecoder {
+        cv::VideoCapture capture;
+        std::vector<cv::Mat> frames;
+        uint64_t segment {0};       // Segment being decoded
+        size_t decoded {0};         // Frames of segment decoded so far
+        bool done {false};          // Segment complete, or the file ended in it
+        std::exception_ptr error;   // Why segment stopped early, if it failed
+        std::thread thread;
+    };
+    std::vector<std::unique_ptr<SegmentDecoder>> segment_decoders_;
+    uint64_t serving_segment_ {0};
+    size_t serving_index_ {0};
 
-    // frame generation clock
-    std::chrono::high_resolution_clock clock_;
-    std::chrono::duration<double> frame_period_in_sec_;
-    std::chrono::high_resolution_clock::time_point tick_;
+    void startDecoding(const cv::Mat &example_frame);
+    void startSegmentDecoding(const cv::Mat &example_frame);
+    void stopDecoding(void);
+    void decodeAhead(void);
+    void decodeSegments(SegmentDecoder &decoder);
+    size_t takeDecoded(void);
+    void giveBack(const size_t index);
+    cv::Mat takeSegmentFrame(void);
+    void giveBackSegmentFrame(void);
+
+    // Playback speed. 0 is unthrottled.
+    double frames_per_second_;
 };
 
 }       /* namespace oat */
@@ -21,9 +21,16 @@
 #define	OAT_FRAMESERVER_H
 
 #include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
 #include <opencv2/opencv.hpp>
 
 #include "../../lib/datatypes/Frame.h"
+#include "../../lib/utility/IOFormat.h"
+#include "../../lib/utility/OatTOMLSanitize.h"
+#include "../../lib/utility/Pacer.h"
 #include "../../lib/shmemdf/Sink.h"
 #include "../../lib/shmemdf/SharedFrameHeader.h"
 
@@ -63,6 +70,24 @@ public:
     // Accessors
     std::string name() const { return name_; }
 
+    /**
+     * Stamp served frames with a clock shared by other FrameServers in this
+     * process, instead of with the server's own timing. The server is no
+     * longer paced by its own rate, since the owner of the clock sets the
+     * pace, and must publish exactly one frame per call to serveFrame().
+     * Must be called after configure() and before connectToNode().
+     * @param usec Time of the frame being served. Must outlive the server.
+     * @param rate_hz Rate of the shared clock, which is advertised in
+     * served samples. 0 if it is unpaced, in which case the server's own
+     * rate is advertised.
+     */
+    void set_shared_clock(const oat::Sample::Microseconds *usec,
+                          const double rate_hz = 0.0) {
+        shared_clock_ = usec;
+        shared_rate_hz_ = rate_hz;
+        disablePacing();
+    }
+
 protected:
 
     // Component name
@@ -72,6 +97,43 @@ protected:
     bool use_roi_ {false};
     cv::Rect_<size_t> region_of_interest_;
 
+    /**
+     * Bind the SINK and allocate shared frames shaped like full_frame. With
+     * a region of interest, the shared frames are full size but only the
+     * region is published. SOURCEs view it in place, so whole frames can be
+     * captured or copied into shared memory without cropping them first.
+     * @param full_frame Example of the frames that are captured.
+     */
+    void bindFrameSink(const cv::Mat &full_frame) {
+
+        frame_sink_.bind(frame_sink_address_,
+                         full_frame.total() * full_frame.elemSize());
+
+        if (use_roi_)
+            shared_frame_ = frame_sink_.retrieve(
+                full_frame.rows, full_frame.cols, full_frame.type(),
+                oat::PixelFormat::BGR, cv::Rect(region_of_interest_));
+        else
+            shared_frame_ = frame_sink_.retrieve(
+                full_frame.rows, full_frame.cols, full_frame.type());
+    }
+
+    /**
+     * Copy a full captured frame into the shared frame of a SINK bound by
+     * bindFrameSink(). Only the region of interest is copied.
+     * @param full_frame Captured frame.
+     */
+    void copyToSharedFrame(const cv::Mat &full_frame) {
+
+        cv::Mat shared = shared_frame_;
+        if (use_roi_) {
+            const cv::Rect roi(region_of_interest_);
+            full_frame(roi).copyTo(shared(roi));
+        } else {
+            full_frame.copyTo(shared);
+        }
+    }
+
     // Frame sink
     const std::string frame_sink_address_;
     oat::Sink<oat::SharedFrameHeader> frame_sink_;
@@ -79,6 +141,128 @@ protected:
     // Currently acquired, shared frame
     bool frame_empty_ {true};
     oat::Frame shared_frame_;
+
+    // Paces served frames against absolute deadlines. Disabled unless the
+    // server is given a rate.
+    oat::Pacer pacer_;
+
+    /**
+     * Wait for the deadline of the next frame, and record how late it was
+     * in the SINK's node for monitoring tools.
+     */
+    void pace(void) {
+        if (pacer_.enabled())
+            frame_sink_.recordLateness(pacer_.wait());
+    }
+
+    /**
+     * Stop pacing served frames, whatever rate the server was configured
+     * with.
+     */
+    void disablePacing(void) { pacer_.set_rate_hz(0.0); }
+
+    // Clock shared with other servers. Null if this server keeps its own.
+    const oat::Sample::Microseconds *shared_clock_ {nullptr};
+    double shared_rate_hz_ {0.0};
+
+    /**
+     * Advertise the rate of the shared clock, if there is one and it is
+     * paced, in the shared frame's sample.
+     */
+    void setSharedRate(void) {
+        if (shared_clock_ && shared_rate_hz_ > 0)
+            shared_frame_.sample().set_rate_hz(shared_rate_hz_);
+    }
+
+    /**
+     * Increment the sample count of the shared frame. The frame is stamped
+     * with the shared clock if there is one, or else advanced by the sample
+     * period.
+     */
+    uint64_t incrementSampleCount(void) {
+
+        if (!shared_clock_)
+            return shared_frame_.sample().incrementCount();
+
+        setSharedRate();
+        return shared_frame_.sample().incrementCount(*shared_clock_);
+    }
+
+    /**
+     * Increment the sample count of the shared frame. The frame is stamped
+     * with the shared clock if there is one, or else with usec.
+     * @param usec Time the frame was acquired.
+     */
+    uint64_t incrementSampleCount(const oat::Sample::Microseconds usec) {
+        setSharedRate();
+        return shared_frame_.sample().incrementCount(
+            shared_clock_ ? *shared_clock_ : usec);
+    }
+
+    /**
+     * @return False for servers that publish through other servers instead
+     * of binding their own SINK, which then take no SINK options.
+     */
+    virtual bool bindsSink(void) const { return true; }
+
+    /**
+     * Check a server's configuration for unknown options, and apply the
+     * options shared by all servers: the SINK's ring size and page policy
+     * and the pacer's spin time.
+     * @param config Server's configuration table.
+     * @param options Server specific options. Shared options are added.
+     */
+    void configureNode(const oat::config::Table &config,
+                       std::vector<std::string> options) {
+
+        options.push_back("spin-us");
+        if (bindsSink())
+            options.insert(options.end(),
+                           {"ring-size", "huge-pages", "lock-pages"});
+
+        // Check for unknown options in the table and throw if you find them
+        oat::config::checkKeys(options, config);
+
+        // Spend the end of each frame period spinning instead of sleeping
+        int64_t spin_us;
+        if (oat::config::getValue(config, "spin-us", spin_us, (int64_t)0))
+            pacer_.set_spin(std::chrono::microseconds(spin_us));
+
+        if (!bindsSink())
+            return;
+
+        // Set the number of shared frame slots
+        int64_t ring_size;
+        if (oat::config::getValue(config, "ring-size", ring_size, (int64_t)1))
+            frame_sink_.set_ring_size(ring_size);
+
+        // Back shared frames with huge and/or locked pages
+        bool huge_pages {false}, lock_pages {false};
+        oat::config::getValue(config, "huge-pages", huge_pages);
+        oat::config::getValue(config, "lock-pages", lock_pages);
+        frame_sink_.set_page_policy((huge_pages ? PAGES_HUGE : PAGES_DEFAULT)
+                                    | (lock_pages ? PAGES_LOCKED : PAGES_DEFAULT));
+    }
+
+    /**
+     * Warn about page policy flags that the system did not allow when the
+     * SINK bound.
+     */
+    void checkPagePolicy(void) const {
+
+        const uint32_t dropped =
+            frame_sink_.page_policy() & ~frame_sink_.applied_page_policy();
+
+        if (dropped & PAGES_HUGE)
+            std::cerr << oat::whoWarn(name_,
+                "Huge pages are not enabled for shared memory. "
+                "Falling back to ordinary pages.\n");
+
+        if (dropped & PAGES_LOCKED)
+            std::cerr << oat::whoWarn(name_,
+                "Shared frames could not be locked in RAM. "
+                "Check the locked memory limit (ulimit -l).\n");
+    }
 };
 
 }       /* namespace oat */
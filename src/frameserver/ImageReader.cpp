@@ -0,0 +1,351 @@
+//******************************************************************************
+//* File:   ImageReader.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <glob.h>
+#include <opencv2/imgcodecs.hpp>
+
+#include <cpptoml.h>
+#include "../../lib/utility/OatTOMLSanitize.h"
+#include "../../lib/utility/IOFormat.h"
+
+#include "ImageReader.h"
+
+namespace oat {
+
+namespace {
+
+bool isDigit(const char c) {
+    return std::isdigit(static_cast<unsigned char>(c));
+}
+
+/**
+ * Order file names so that runs of digits compare by value, e.g.
+ * frame2.png before frame10.png.
+ */
+bool naturalLess(const std::string &a, const std::string &b) {
+
+    size_t i = 0, j = 0;
+    while (i < a.size() && j < b.size()) {
+
+        if (isDigit(a[i]) && isDigit(b[j])) {
+
+            // Compare digit runs without their leading zeros, first by
+            // length and then digit by digit
+            size_t i_end = i, j_end = j;
+            while (i_end < a.size() && isDigit(a[i_end])) i_end++;
+            while (j_end < b.size() && isDigit(b[j_end])) j_end++;
+            while (i < i_end - 1 && a[i] == '0') i++;
+            while (j < j_end - 1 && b[j] == '0') j++;
+
+            if (i_end - i != j_end - j)
+                return i_end - i < j_end - j;
+
+            const int c = a.compare(i, i_end - i, b, j, j_end - j);
+            if (c != 0)
+                return c < 0;
+
+            i = i_end;
+            j = j_end;
+
+        } else {
+
+            if (a[i] != b[j])
+                return a[i] < b[j];
+            i++;
+            j++;
+        }
+    }
+
+    return a.size() - i < b.size() - j;
+}
+
+void readFile(const std::string &file_name, std::vector<uchar> &buffer) {
+
+    std::ifstream file(file_name, std::ios::binary | std::ios::ate);
+    if (!file)
+        throw (std::runtime_error(file_name + " could not be opened."));
+
+    // The buffer keeps its capacity between images of similar size
+    buffer.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char *>(buffer.data()), buffer.size()))
+        throw (std::runtime_error(file_name + " could not be read."));
+}
+
+}
+
+ImageReader::ImageReader(const std::string &frame_sink_address,
+                         const std::string &file_pattern,
+                         const double frames_per_second) :
+  FrameServer(frame_sink_address)
+, file_pattern_(file_pattern)
+, frames_per_second_(frames_per_second)
+{
+    // Default config
+    pacer_.set_rate_hz(frames_per_second_);
+}
+
+ImageReader::~ImageReader() {
+
+    stopDecoding();
+}
+
+void ImageReader::configure(void) { }
+
+void ImageReader::configure(const std::string &config_file,
+                            const std::string &config_key) {
+
+    // Available options
+    std::vector<std::string> options {"fps", "roi", "workers", "prefetch"};
+
+    // This will throw cpptoml::parse_exception if a file
+    // with invalid TOML is provided
+    auto config = cpptoml::parse_file(config_file);
+
+    // See if a configuration was provided
+    if (config->contains(config_key)) {
+
+        // Get this components configuration table
+        auto this_config = config->get_table(config_key);
+
+        // Check for unknown options and apply the options of all servers
+        configureNode(this_config, options);
+
+        // Set the frame rate
+        oat::config::getValue(this_config, "fps", frames_per_second_, 0.0);
+        pacer_.set_rate_hz(frames_per_second_);
+
+        // Set the number of decoding threads and how far they can run ahead
+        int64_t val;
+        if (oat::config::getValue(this_config, "workers", val, (int64_t)1))
+            workers_ = val;
+        if (oat::config::getValue(this_config, "prefetch", val, (int64_t)1))
+            prefetch_ = val;
+
+        // Set the ROI
+        oat::config::Table roi;
+        if (oat::config::getTable(this_config, "roi", roi)) {
+
+            oat::config::getValue(roi, "x_offset", val, (int64_t)0, true);
+            region_of_interest_.x = val;
+            oat::config::getValue(roi, "y_offset", val, (int64_t)0, true);
+            region_of_interest_.y = val;
+            oat::config::getValue(roi, "width", val, (int64_t)0, true);
+            region_of_interest_.width = val;
+            oat::config::getValue(roi, "height", val, (int64_t)0, true);
+            region_of_interest_.height = val;
+            use_roi_ = true;
+        }
+
+    } else {
+        throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
+    }
+}
+
+void ImageReader::connectToNode() {
+
+    expandPattern();
+
+    // The first image sets the size of all the others
+    const cv::Mat first = cv::imread(files_[0], cv::IMREAD_COLOR);
+    if (first.empty())
+        throw (std::runtime_error(files_[0] + " could not be decoded."));
+
+    rows_ = first.rows;
+    cols_ = first.cols;
+    const cv::Mat example_frame = use_roi_ ? first(region_of_interest_) : first;
+
+    frame_sink_.bind(frame_sink_address_,
+            example_frame.total() * example_frame.elemSize());
+
+    shared_frame_ = frame_sink_.retrieve(
+            example_frame.rows, example_frame.cols, example_frame.type());
+
+    // Tell the user if the SINK fell back to ordinary pages
+    checkPagePolicy();
+
+    // Put the sample rate in the shared frame
+    if (frames_per_second_ > 0)
+        shared_frame_.sample().set_rate_hz(frames_per_second_);
+
+    startDecoding();
+
+    pacer_.start();
+}
+
+bool ImageReader::serveFrame() {
+
+    if (next_serve_ == files_.size())
+        return true;
+
+    // Wait for the next image before readers are locked out
+    const size_t slot = next_serve_ % prefetch_;
+    {
+        std::unique_lock<std::mutex> lock(slot_mutex_);
+        decoded_cv_.wait(lock, [this, slot] {
+            return ready_[slot] || (decode_error_ && error_index_ == next_serve_);
+        });
+
+        if (!ready_[slot])
+            std::rethrow_exception(decode_error_);
+    }
+
+    // START CRITICAL SECTION //
+    ////////////////////////////
+
+    // Wait for sources to read
+    frame_sink_.wait();
+
+    // Get the ring slot that will be published next
+    shared_frame_ = frame_sink_.retrieve();
+
+    // The ROI is copied directly out of the decoded image
+    if (use_roi_)
+        slots_[slot](region_of_interest_).copyTo(shared_frame_);
+    else
+        slots_[slot].copyTo(shared_frame_);
+
+    // Increment sample count
+    incrementSampleCount();
+
+    // Tell sources there is new data
+    frame_sink_.post();
+
+    ////////////////////////////
+    //  END CRITICAL SECTION  //
+
+    // Hand the slot back to the decoders
+    {
+        std::lock_guard<std::mutex> lock(slot_mutex_);
+        ready_[slot] = false;
+        next_serve_++;
+    }
+    free_cv_.notify_all();
+
+    pace();
+
+    return false;
+}
+
+void ImageReader::expandPattern() {
+
+    glob_t matches;
+    const int rc = glob(file_pattern_.c_str(), 0, nullptr, &matches);
+    if (rc == 0)
+        files_.assign(matches.gl_pathv, matches.gl_pathv + matches.gl_pathc);
+    globfree(&matches);
+
+    if (rc != 0 && rc != GLOB_NOMATCH)
+        throw (std::runtime_error("Could not expand " + file_pattern_ + "."));
+    else if (files_.empty())
+        throw (std::runtime_error("No images match " + file_pattern_ + "."));
+
+    std::sort(files_.begin(), files_.end(), naturalLess);
+}
+
+void ImageReader::startDecoding() {
+
+    if (workers_ == 0)
+        workers_ = std::max(std::thread::hardware_concurrency(), 1u);
+    if (prefetch_ == 0)
+        prefetch_ = 2 * workers_;
+
+    // Preallocate the window of decoded images
+    slots_.resize(prefetch_);
+    for (auto &s : slots_)
+        s.create(rows_, cols_, CV_8UC3);
+    ready_.assign(prefetch_, false);
+
+    decoding_ = true;
+    for (size_t i = 0; i < workers_; i++)
+        decode_threads_.emplace_back(&ImageReader::decodeAhead, this);
+}
+
+void ImageReader::stopDecoding() {
+
+    {
+        std::lock_guard<std::mutex> lock(slot_mutex_);
+        decoding_ = false;
+    }
+    free_cv_.notify_all();
+
+    for (auto &t : decode_threads_)
+        t.join();
+    decode_threads_.clear();
+}
+
+void ImageReader::decodeAhead() {
+
+    // Encoded bytes of the current image
+    std::vector<uchar> buffer;
+
+    for (;;) {
+
+        // Claim the next image once its slot is free
+        std::unique_lock<std::mutex> lock(slot_mutex_);
+        free_cv_.wait(lock, [this] {
+            return !decoding_
+                   || next_decode_ >= files_.size()
+                   || next_decode_ < next_serve_ + prefetch_;
+        });
+        if (!decoding_ || next_decode_ >= files_.size())
+            return;
+
+        const size_t index = next_decode_++;
+        const size_t slot = index % prefetch_;
+        lock.unlock();
+
+        try {
+
+            // Decoding into the slot reuses its memory when the image has
+            // the expected size
+            readFile(files_[index], buffer);
+            cv::imdecode(buffer, cv::IMREAD_COLOR, &slots_[slot]);
+
+            if (slots_[slot].empty())
+                throw (std::runtime_error(files_[index] + " could not be decoded."));
+
+            if (slots_[slot].rows != rows_ || slots_[slot].cols != cols_)
+                throw (std::runtime_error(files_[index] + " is not the same "
+                                          "size as " + files_[0] + "."));
+
+        } catch (...) {
+            lock.lock();
+            if (!decode_error_ || index < error_index_) {
+                decode_error_ = std::current_exception();
+                error_index_ = index;
+            }
+            lock.unlock();
+            decoded_cv_.notify_one();
+            return;
+        }
+
+        lock.lock();
+        ready_[slot] = true;
+        lock.unlock();
+        decoded_cv_.notify_one();
+    }
+}
+
+} /* namespace oat */
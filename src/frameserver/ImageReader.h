@@ -0,0 +1,99 @@
+//******************************************************************************
+//* File:   ImageReader.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_IMAGEREADER_H
+#define	OAT_IMAGEREADER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "FrameServer.h"
+
+namespace oat {
+
+/**
+ * Serves a sequence of numbered image files (e.g. *.png or *.jpg) matching a
+ * glob pattern. Images are decoded ahead of the SINK on a pool of threads and
+ * served in numerical order.
+ */
+class ImageReader : public FrameServer {
+public:
+
+    /**
+     * @param frame_sink_address Address of node to publish shared frames to.
+     * @param file_pattern Glob pattern matching the image files.
+     * @param frames_per_second Playback rate. 0 serves frames as quickly as
+     * the node allows.
+     */
+    ImageReader(const std::string &frame_sink_address,
+                const std::string &file_pattern,
+                const double frames_per_second = 0.0);
+
+    ~ImageReader();
+
+    // Implement FrameServer interface
+    void configure(void) override;
+    void configure(const std::string &config_file,
+                   const std::string &config_key) override;
+    void connectToNode(void) override;
+    bool serveFrame(void) override;
+
+private:
+
+    // Image files, in the order they are served
+    std::string file_pattern_;
+    std::vector<std::string> files_;
+    void expandPattern(void);
+
+    // Image i is decoded by one of workers_ threads into slot i % prefetch_
+    // of a window of preallocated frames, at most prefetch_ images ahead of
+    // the one being served. Slots hold whole images. The ROI is a view that
+    // is copied straight into the shared frame.
+    size_t workers_ {0};
+    size_t prefetch_ {0};
+    bool decoding_ {false};
+    std::vector<cv::Mat> slots_;
+    std::vector<bool> ready_;
+    size_t next_decode_ {0};
+    size_t next_serve_ {0};
+    int rows_ {0}, cols_ {0};
+    std::mutex slot_mutex_;
+    std::condition_variable decoded_cv_, free_cv_;
+    std::vector<std::thread> decode_threads_;
+
+    // First image that failed to decode, and why. It is rethrown once the
+    // images before it have been served.
+    std::exception_ptr decode_error_;
+    size_t error_index_ {0};
+
+    void startDecoding(void);
+    void stopDecoding(void);
+    void decodeAhead(void);
+
+    // Playback speed. 0 is unthrottled.
+    double frames_per_second_;
+};
+
+}       /* namespace oat */
+#endif	/* OAT_IMAGEREADER_H */
@@ -0,0 +1,258 @@
+//******************************************************************************
+//* File:   MultiServer.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "OatConfig.h" // Generated by CMake
+
+#include <functional>
+#include <string>
+#include <thread>
+
+#include <cpptoml.h>
+#include "../../lib/utility/OatTOMLSanitize.h"
+#include "../../lib/utility/IOFormat.h"
+
+#include "FileReader.h"
+#include "ImageReader.h"
+#include "RawReader.h"
+#include "SynthFrame.h"
+#include "TestFrame.h"
+#include "WebCam.h"
+#ifdef USE_FLYCAP
+    #include "PGGigECam.h"
+#endif
+
+#include "MultiServer.h"
+
+namespace oat {
+
+namespace {
+
+/**
+ * Create the server described by a [[camera]] table. Servers are not
+ * paced, since the rate is set by the shared clock.
+ */
+std::shared_ptr<oat::FrameServer>
+makeServer(const oat::config::Table &camera, const std::string &sink) {
+
+    std::string type, file;
+    oat::config::getValue(camera, "type", type, true);
+    oat::config::getValue(camera, "file", file);
+
+    if (type == "wcam") {
+        return std::make_shared<oat::WebCam>(sink);
+    } else if (type == "synth") {
+        return std::make_shared<oat::SynthFrame>(sink, 0.0);
+    } else if (type == "gige") {
+#ifdef USE_FLYCAP
+        int64_t index = 0;
+        oat::config::getValue(camera, "index", index, (int64_t)0);
+        return std::make_shared<oat::PGGigECam>(sink, index, 1000000.0);
+#else
+        throw (std::runtime_error("Oat was not compiled with Point-Grey "
+                                  "flycapture support, so type 'gige' is not "
+                                  "available.\n"));
+#endif
+    }
+
+    if (file.empty())
+        throw (std::runtime_error("Camera type '" + type + "' requires a "
+                                  "'file'.\n"));
+
+    if (type == "file")
+        return std::make_shared<oat::FileReader>(sink, file);
+    else if (type == "raw")
+        return std::make_shared<oat::RawReader>(sink, file, 0.0);
+    else if (type == "images")
+        return std::make_shared<oat::ImageReader>(sink, file, 0.0);
+    else if (type == "test")
+        return std::make_shared<oat::TestFrame>(sink, file, 0.0);
+
+    throw (std::runtime_error("Unknown camera type '" + type + "'.\n"));
+}
+
+}
+
+MultiServer::MultiServer(const std::string &frame_sink_address,
+                         const double frames_per_second) :
+  FrameServer(frame_sink_address)
+, frames_per_second_(frames_per_second)
+{
+    // Default config
+    pacer_.set_rate_hz(frames_per_second_);
+}
+
+MultiServer::~MultiServer() {
+
+    stop();
+}
+
+void MultiServer::configure(void) {
+
+    throw (std::runtime_error("TYPE=multi requires a configuration that "
+                              "lists its cameras."));
+}
+
+void MultiServer::configure(const std::string &config_file,
+                            const std::string &config_key) {
+
+    // Available options
+    std::vector<std::string> options {"fps", "camera"};
+
+    // This will throw cpptoml::parse_exception if a file
+    // with invalid TOML is provided
+    auto config = cpptoml::parse_file(config_file);
+
+    // See if a configuration was provided
+    if (config->contains(config_key)) {
+
+        // Get this components configuration table
+        auto this_config = config->get_table(config_key);
+
+        // Check for unknown options and apply the options of all servers
+        configureNode(this_config, options);
+
+        // Set the rate of the shared clock
+        oat::config::getValue(this_config, "fps", frames_per_second_, 0.0);
+        pacer_.set_rate_hz(frames_per_second_);
+
+        auto cameras = this_config->get_table_array("camera");
+        if (!cameras)
+            throw (std::runtime_error("No [[" + config_key + ".camera]] "
+                                      "tables were found in " + config_file
+                                      + ".\n"));
+
+        for (auto &c : *cameras) {
+
+            oat::config::checkKeys({"type", "sink", "index", "file", "config"}, c);
+
+            // Cameras publish to the SINK address followed by their index,
+            // unless they name their own
+            std::string sink = frame_sink_address_ + std::to_string(servers_.size());
+            oat::config::getValue(c, "sink", sink);
+
+            auto server = makeServer(c, sink);
+
+            // Each camera can have its own file/key pair
+            oat::config::Array fk;
+            if (oat::config::getArray(c, "config", fk, 2)) {
+                auto fk_vec = fk->array_of<std::string>();
+                server->configure(fk_vec[0]->get(), fk_vec[1]->get());
+            } else {
+                server->configure();
+            }
+
+            // Only the shared clock paces the cameras, even if their own
+            // configuration sets a rate
+            server->set_shared_clock(&clock_usec_, frames_per_second_);
+            servers_.push_back(server);
+        }
+
+    } else {
+        throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
+    }
+}
+
+void MultiServer::connectToNode() {
+
+    for (auto &s : servers_)
+        s->connectToNode();
+
+    running_ = true;
+    for (auto &s : servers_)
+        threads_.emplace_back(&MultiServer::serve, this, std::ref(*s));
+
+    start_ = clock_.now();
+    pacer_.start();
+}
+
+bool MultiServer::serveFrame() {
+
+    // Start a round. Every server stamps its frame with the same time.
+    {
+        std::lock_guard<std::mutex> lock(round_mutex_);
+        clock_usec_ = std::chrono::duration_cast<oat::Sample::Microseconds>(
+            clock_.now() - start_);
+        pending_ = servers_.size();
+        round_++;
+    }
+    start_cv_.notify_all();
+
+    // Wait for every server to publish
+    {
+        std::unique_lock<std::mutex> lock(round_mutex_);
+        done_cv_.wait(lock, [this] { return pending_ == 0; });
+
+        if (serve_error_)
+            std::rethrow_exception(serve_error_);
+    }
+
+    // This server has no SINK of its own to record lateness in
+    pacer_.wait();
+
+    // Stop when any server runs out of frames
+    return eof_;
+}
+
+void MultiServer::serve(oat::FrameServer &server) {
+
+    uint64_t round = 0;
+
+    for (;;) {
+
+        {
+            std::unique_lock<std::mutex> lock(round_mutex_);
+            start_cv_.wait(lock, [this, round] { return round_ != round || !running_; });
+            if (!running_)
+                return;
+            round = round_;
+        }
+
+        bool eof = false;
+        std::exception_ptr error;
+        try {
+            eof = server.serveFrame();
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(round_mutex_);
+            eof_ = eof_ || eof;
+            if (error && !serve_error_)
+                serve_error_ = error;
+            if (--pending_ == 0)
+                done_cv_.notify_one();
+        }
+    }
+}
+
+void MultiServer::stop() {
+
+    {
+        std::lock_guard<std::mutex> lock(round_mutex_);
+        running_ = false;
+    }
+    start_cv_.notify_all();
+
+    for (auto &t : threads_)
+        t.join();
+    threads_.clear();
+}
+
+} /* namespace oat */
@@ -0,0 +1,96 @@
+//******************************************************************************
+//* File:   MultiServer.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_MULTISERVER_H
+#define	OAT_MULTISERVER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "FrameServer.h"
+
+namespace oat {
+
+/**
+ * Drives several FrameServers from one process in lockstep. Each server
+ * publishes to its own SINK and serves on its own thread. Every call to
+ * serveFrame() serves exactly one frame from each server, stamped with the
+ * same time, so their sample numbers and timestamps stay aligned.
+ */
+class MultiServer : public FrameServer {
+public:
+
+    /**
+     * @param frame_sink_address Prefix of the SINKs of servers that do not
+     * name their own.
+     * @param frames_per_second Rate of the shared sample clock. 0 serves
+     * frames as quickly as the slowest server allows.
+     */
+    MultiServer(const std::string &frame_sink_address,
+                const double frames_per_second = 0.0);
+
+    ~MultiServer();
+
+    // Implement FrameServer interface
+    void configure(void) override;
+    void configure(const std::string &config_file,
+                   const std::string &config_key) override;
+    void connectToNode(void) override;
+    bool serveFrame(void) override;
+
+private:
+
+    // Cameras bind their own SINKs
+    bool bindsSink(void) const override { return false; }
+
+    // Servers, one per device
+    std::vector<std::shared_ptr<oat::FrameServer>> servers_;
+
+    // Each server has a thread that serves one frame per round. round_ is
+    // incremented to start a round, and pending_ counts the servers that
+    // have not finished it.
+    bool running_ {false};
+    uint64_t round_ {0};
+    size_t pending_ {0};
+    bool eof_ {false};
+    std::mutex round_mutex_;
+    std::condition_variable start_cv_, done_cv_;
+    std::vector<std::thread> threads_;
+    std::exception_ptr serve_error_;
+
+    void serve(oat::FrameServer &server);
+    void stop(void);
+
+    // Shared sample clock, read by every server while a round is in progress
+    oat::Sample::Microseconds clock_usec_ {0};
+    std::chrono::steady_clock clock_;
+    std::chrono::steady_clock::time_point start_;
+
+    // Round rate. 0 is unthrottled.
+    double frames_per_second_;
+};
+
+}       /* namespace oat */
+#endif	/* OAT_MULTISERVER_H */
@@ -104,6 +104,7 @@ void PGGigECam::configure(const std::string& config_file, const std::string& con
                                        "trigger_pin",
                                        "enforce_fps",
                                        "strobe_pin",
+                                       "pixel_format",
                                        "calibration_file" };
 
     // This will throw cpptoml::parse_exception if a file
@@ -199,6 +200,28 @@ void PGGigECam::configure(const std::string& config_file, const std::string& con
         // TODO: Must come after setting up image?
         setupPixelBinning(x_bin_, y_bin_);
 
+        // Pixel format sent by the camera and published to the SINK
+        {
+            std::string val;
+            if (oat::config::getValue(this_config, "pixel_format", val)) {
+                if (val == "bgr")
+                    camera_format_ = pg::PIXEL_FORMAT_RAW12;
+                else if (val == "raw8")
+                    camera_format_ = pg::PIXEL_FORMAT_RAW8;
+                else if (val == "raw16")
+                    camera_format_ = pg::PIXEL_FORMAT_RAW16;
+                else if (val == "mono8")
+                    camera_format_ = pg::PIXEL_FORMAT_MONO8;
+                else if (val == "mono16")
+                    camera_format_ = pg::PIXEL_FORMAT_MONO16;
+                else
+                    throw (std::runtime_error("Unknown pixel_format '" + val
+                                              + "'. Use bgr, raw8, raw16, "
+                                              "mono8 or mono16."));
+                serve_bgr_ = val == "bgr";
+            }
+        }
+
         // Set the ROI
         // TODO: Use the base class's included region_of_interest_ property instead of frame_offset
         // and frame_size
@@ -602,7 +625,7 @@ int PGGigECam::setupDefaultImageFormat() {
     imageSettings.offsetY = region_of_interest_.y;
     imageSettings.height = region_of_interest_.height;
     imageSettings.width = region_of_interest_.width;
-    imageSettings.pixelFormat = pg::PIXEL_FORMAT_RAW12;
+    imageSettings.pixelFormat = camera_format_;
 
     std::cout << "Setting GigE image settings...\n";
 
@@ -647,7 +670,7 @@ int PGGigECam::setupImageFormat() {
     imageSettings.offsetY = region_of_interest_.y;
     imageSettings.height = region_of_interest_.height;
     imageSettings.width = region_of_interest_.width;
-    imageSettings.pixelFormat = pg::PIXEL_FORMAT_RAW12;
+    imageSettings.pixelFormat = camera_format_;
 
     std::cout << "Setting image settings...\n";
 
@@ -970,6 +993,12 @@ uint64_t PGGigECam::uncycle1394Timestamp(int ieee_1394_sec,
 
 void PGGigECam::connectToNode() {
 
+    // Retransmitted frames would put this camera's samples ahead of the
+    // other cameras on the clock
+    if (shared_clock_ && enforce_fps_)
+        throw (std::runtime_error("enforce_fps cannot be used with a shared "
+                                  "clock (TYPE=multi)."));
+
     pg::GigEImageSettings imageSettings;
 
     pg::Error error = camera_.GetGigEImageSettings(&imageSettings);
@@ -977,6 +1006,28 @@ void PGGigECam::connectToNode() {
         throw (std::runtime_error(error.GetDescription()));
     }
 
+    if (!serve_bgr_) {
+
+        // Publish the camera's samples without conversion
+        const bool wide = camera_format_ == pg::PIXEL_FORMAT_RAW16
+                          || camera_format_ == pg::PIXEL_FORMAT_MONO16;
+        const int type = wide ? CV_16UC1 : CV_8UC1;
+        const oat::PixelFormat format =
+            camera_format_ == pg::PIXEL_FORMAT_MONO8
+            || camera_format_ == pg::PIXEL_FORMAT_MONO16 ?
+            oat::PixelFormat::GREY : bayerFormat();
+
+        frame_sink_.bind(frame_sink_address_,
+                imageSettings.height * imageSettings.width * CV_ELEM_SIZE(type));
+        shared_frame_ = frame_sink_.retrieve(imageSettings.height,
+                                             imageSettings.width,
+                                             type,
+                                             format);
+        shared_frame_.sample().set_rate_hz(frames_per_second_);
+
+        return;
+    }
+
     pg::Image temp(imageSettings.height,
                    imageSettings.width,
                    pg::PIXEL_FORMAT_BGR);
@@ -1006,6 +1057,11 @@ bool PGGigECam::serveFrame() {
 
     int rc = grabImage();
 
+    // Servers on a shared clock must publish exactly one frame per sample,
+    // so they wait out grab timeouts instead of skipping the sample
+    while (rc == -1 && shared_clock_)
+        rc = grabImage();
+
     // There was a grab timeout.
     // Allow check to see if SIGINT occurred.
     if (rc == -1)
@@ -1028,8 +1084,15 @@ bool PGGigECam::serveFrame() {
         // Wait for sources to read
         frame_sink_.wait();
 
-        raw_image_.Convert(pg::PIXEL_FORMAT_BGR, rgb_image_.get());
-        shared_frame_.sample().incrementCount(tick_);
+        if (serve_bgr_) {
+            raw_image_.Convert(pg::PIXEL_FORMAT_BGR, rgb_image_.get());
+        } else {
+            shared_frame_ = frame_sink_.retrieve();
+            cv::Mat(shared_frame_.rows, shared_frame_.cols, shared_frame_.type(),
+                    raw_image_.GetData(), raw_image_.GetStride())
+                .copyTo(shared_frame_);
+        }
+        incrementSampleCount(tick_);
 
         // Tell sources there is new data
         frame_sink_.post();
@@ -1042,6 +1105,22 @@ bool PGGigECam::serveFrame() {
     return false;
 }
 
+oat::PixelFormat PGGigECam::bayerFormat(void) {
+
+    pg::CameraInfo camera_info;
+    pg::Error error = camera_.GetCameraInfo(&camera_info);
+    if (error != pg::PGRERROR_OK)
+        throw (std::runtime_error(error.GetDescription()));
+
+    switch (camera_info.bayerTileFormat) {
+        case pg::RGGB: return oat::PixelFormat::BAYER_RGGB;
+        case pg::GRBG: return oat::PixelFormat::BAYER_GRBG;
+        case pg::GBRG: return oat::PixelFormat::BAYER_GBRG;
+        case pg::BGGR: return oat::PixelFormat::BAYER_BGGR;
+        default: return oat::PixelFormat::GREY; // Monochrome sensor
+    }
+}
+
 int PGGigECam::findNumCameras(void) {
 
     pg::Error error;
@@ -88,6 +88,13 @@ private:
     //unsigned int num_transmit_retries_ {0};
     int64_t strobe_output_pin_ {1};
 
+    // Pixel format sent by the camera. RAW12 frames are converted to BGR on
+    // the host. Other formats are published as they are sent, and Bayer
+    // frames are demosaiced by the components that need colour.
+    pg::PixelFormat camera_format_ {pg::PIXEL_FORMAT_RAW12};
+    bool serve_bgr_ {true};
+    oat::PixelFormat bayerFormat(void);
+
     // GigE Camera interface
     pg::GigECamera camera_;
 
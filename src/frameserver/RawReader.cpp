@@ -0,0 +1,282 @@
+//******************************************************************************
+//* File:   RawReader.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <opencv2/imgproc.hpp>
+
+#include <cpptoml.h>
+#include "../../lib/utility/OatTOMLSanitize.h"
+#include "../../lib/utility/IOFormat.h"
+
+#include "RawReader.h"
+
+namespace oat {
+
+namespace bip = boost::interprocess;
+
+RawReader::RawReader(const std::string &frame_sink_address,
+                     const std::string &file_name,
+                     const double frames_per_second) :
+  FrameServer(frame_sink_address)
+, file_name_(file_name)
+, frames_per_second_(frames_per_second)
+{
+    // Default config
+    pacer_.set_rate_hz(frames_per_second_);
+}
+
+void RawReader::configure(void) { }
+
+void RawReader::configure(const std::string &config_file,
+                          const std::string &config_key) {
+
+    // Available options
+    std::vector<std::string> options {"fps", "width", "height", "format",
+                                      "bit-depth"};
+
+    // This will throw cpptoml::parse_exception if a file
+    // with invalid TOML is provided
+    auto config = cpptoml::parse_file(config_file);
+
+    // See if a configuration was provided
+    if (config->contains(config_key)) {
+
+        // Get this components configuration table
+        auto this_config = config->get_table(config_key);
+
+        // Check for unknown options and apply the options of all servers
+        configureNode(this_config, options);
+
+        // Set the frame rate
+        oat::config::getValue(this_config, "fps", frames_per_second_, 0.0);
+        pacer_.set_rate_hz(frames_per_second_);
+
+        // Set the frame layout of a raw file. A *.y4m file describes its
+        // own.
+        int64_t val;
+        if (oat::config::getValue(this_config, "width", val, (int64_t)1))
+            cols_ = val;
+        if (oat::config::getValue(this_config, "height", val, (int64_t)1))
+            rows_ = val;
+
+        std::string format;
+        if (oat::config::getValue(this_config, "format", format)) {
+            i420_ = format == "i420";
+            if (i420_)
+                format_ = oat::PixelFormat::BGR;
+            else if (format == "bgr" || format == "gray" || format == "grey"
+                     || format.compare(0, 6, "bayer_") == 0)
+                format_ = oat::pixelFormatFromName(format);
+            else
+                throw (std::runtime_error("Unknown pixel format '" + format
+                                          + "'. Use bgr, gray, i420, "
+                                          "bayer_rggb, bayer_grbg, "
+                                          "bayer_gbrg or bayer_bggr."));
+        }
+
+        // Bits per sample of raw frames. 16 bit samples are little endian.
+        int64_t bits;
+        if (oat::config::getValue(this_config, "bit-depth", bits, (int64_t)8, (int64_t)16)) {
+            if (bits != 8 && bits != 16)
+                throw (std::runtime_error("bit-depth must be 8 or 16."));
+            depth_ = bits == 16 ? CV_16U : CV_8U;
+        }
+
+    } else {
+        throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
+    }
+}
+
+void RawReader::connectToNode() {
+
+    // Map the whole file. Frames are read front to back, so the kernel is
+    // told to read ahead aggressively and drop pages behind.
+    file_ = bip::file_mapping(file_name_.c_str(), bip::read_only);
+    region_ = bip::mapped_region(file_, bip::read_only);
+    region_.advise(bip::mapped_region::advice_sequential);
+
+    data_ = static_cast<const uchar *>(region_.get_address());
+    size_ = region_.get_size();
+
+    // Y4M files describe their own frames
+    const std::string magic {"YUV4MPEG2 "};
+    y4m_ = size_ >= magic.size()
+           && std::memcmp(data_, magic.data(), magic.size()) == 0;
+    if (y4m_)
+        parseY4MHeader();
+
+    if (rows_ <= 0 || cols_ <= 0)
+        throw (std::runtime_error("The width and height of the frames in "
+                                  + file_name_ + " must be configured."));
+
+    // Bytes per frame in the file and the type of the shared frame
+    const size_t pixels = static_cast<size_t>(rows_) * cols_;
+    const int type = CV_MAKETYPE(depth_, format_ == oat::PixelFormat::BGR ? 3 : 1);
+    const size_t elem_size = CV_ELEM_SIZE(type);
+    if (i420_) {
+        if (rows_ % 2 || cols_ % 2)
+            throw (std::runtime_error("I420 frames must have an even "
+                                      "width and height."));
+        if (depth_ != CV_8U)
+            throw (std::runtime_error("I420 frames must be 8 bit."));
+        frame_bytes_ = pixels * 3 / 2;
+    } else {
+        frame_bytes_ = pixels * elem_size;
+    }
+
+    frame_sink_.bind(frame_sink_address_, pixels * elem_size);
+    shared_frame_ = frame_sink_.retrieve(rows_, cols_, type, format_);
+
+    // Tell the user if the SINK fell back to ordinary pages
+    checkPagePolicy();
+
+    // Put the sample rate in the shared frame
+    if (frames_per_second_ > 0)
+        shared_frame_.sample().set_rate_hz(frames_per_second_);
+    else if (file_rate_hz_ > 0)
+        shared_frame_.sample().set_rate_hz(file_rate_hz_);
+
+    pacer_.start();
+}
+
+bool RawReader::serveFrame() {
+
+    const uchar *frame = nextFrame();
+    if (frame == nullptr)
+        return true;
+
+    // START CRITICAL SECTION //
+    ////////////////////////////
+
+    // Wait for sources to read
+    frame_sink_.wait();
+
+    // Get the ring slot that will be published next
+    shared_frame_ = frame_sink_.retrieve();
+
+    // Packed frames are a single copy out of the mapping. Planar YUV is
+    // converted on its way in.
+    if (i420_) {
+        const cv::Mat yuv(rows_ * 3 / 2, cols_, CV_8UC1, const_cast<uchar *>(frame));
+        cv::cvtColor(yuv, shared_frame_, cv::COLOR_YUV2BGR_I420);
+    } else {
+        std::memcpy(shared_frame_.data, frame, frame_bytes_);
+    }
+
+    // Increment sample count
+    incrementSampleCount();
+
+    // Tell sources there is new data
+    frame_sink_.post();
+
+    ////////////////////////////
+    //  END CRITICAL SECTION  //
+
+    pace();
+
+    return false;
+}
+
+const uchar *RawReader::nextFrame() {
+
+    // Each Y4M frame starts with a 'FRAME' line, which may carry parameters
+    if (y4m_) {
+
+        const uchar *end = static_cast<const uchar *>(
+            std::memchr(data_ + offset_, '\n', size_ - offset_));
+        if (end == nullptr)
+            return nullptr;
+
+        if (end - (data_ + offset_) < 5
+            || std::memcmp(data_ + offset_, "FRAME", 5) != 0)
+            throw (std::runtime_error("Invalid frame header in " + file_name_ + "."));
+
+        offset_ = end + 1 - data_;
+    }
+
+    // A truncated last frame is not served
+    if (size_ - offset_ < frame_bytes_)
+        return nullptr;
+
+    const uchar *frame = data_ + offset_;
+    offset_ += frame_bytes_;
+    return frame;
+}
+
+void RawReader::parseY4MHeader() {
+
+    const uchar *end = static_cast<const uchar *>(std::memchr(data_, '\n', size_));
+    if (end == nullptr)
+        throw (std::runtime_error("Invalid header in " + file_name_ + "."));
+
+    // 'YUV4MPEG2' followed by space separated parameters whose first
+    // character is their tag
+    std::istringstream header(std::string(data_, end));
+    std::string param;
+    std::string colorspace {"420jpeg"};
+    header >> param;
+    while (header >> param) {
+        switch (param[0]) {
+            case 'W':
+                cols_ = std::stoi(param.substr(1));
+                break;
+            case 'H':
+                rows_ = std::stoi(param.substr(1));
+                break;
+            case 'F':
+            {
+                const size_t colon = param.find(':');
+                if (colon != std::string::npos) {
+                    const double den = std::stod(param.substr(colon + 1));
+                    if (den > 0)
+                        file_rate_hz_ = std::stod(param.substr(1, colon - 1)) / den;
+                }
+                break;
+            }
+            case 'C':
+                colorspace = param.substr(1);
+                break;
+        }
+    }
+
+    i420_ = false;
+    depth_ = CV_8U;
+    // Only 8 bit 4:2:0. Chroma siting does not change the plane layout.
+    if (colorspace == "420" || colorspace == "420jpeg"
+        || colorspace == "420paldv" || colorspace == "420mpeg2") {
+        i420_ = true;
+        format_ = oat::PixelFormat::BGR;
+    } else if (colorspace == "mono") {
+        format_ = oat::PixelFormat::GREY;
+    } else if (colorspace == "mono16") {
+        format_ = oat::PixelFormat::GREY;
+        depth_ = CV_16U;
+    } else {
+        throw (std::runtime_error("Y4M colorspace '" + colorspace + "' in "
+                                  + file_name_ + " is not supported. "
+                                  "Use 420, mono or mono16."));
+    }
+
+    offset_ = end + 1 - data_;
+}
+
+} /* namespace oat */
@@ -0,0 +1,93 @@
+//******************************************************************************
+//* File:   RawReader.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_RAWREADER_H
+#define	OAT_RAWREADER_H
+
+#include <chrono>
+#include <string>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "FrameServer.h"
+
+namespace oat {
+
+/**
+ * Serves uncompressed frames from a YUV4MPEG2 (*.y4m) file or from a file of
+ * headerless raw frames. The file is memory mapped, so each frame is copied
+ * from the page cache straight into the shared frame without a decoder or
+ * an intermediate buffer.
+ */
+class RawReader : public FrameServer {
+public:
+
+    /**
+     * @param frame_sink_address Address of node to publish shared frames to.
+     * @param file_name Path to a *.y4m file or a file of raw frames.
+     * @param frames_per_second Playback rate. 0 serves frames as quickly as
+     * the node allows.
+     */
+    RawReader(const std::string &frame_sink_address,
+              const std::string &file_name,
+              const double frames_per_second = 0.0);
+
+    // Implement FrameServer interface
+    void configure(void) override;
+    void configure(const std::string &config_file,
+                   const std::string &config_key) override;
+    void connectToNode(void) override;
+    bool serveFrame(void) override;
+
+private:
+
+    // Mapped file
+    std::string file_name_;
+    boost::interprocess::file_mapping file_;
+    boost::interprocess::mapped_region region_;
+    const uchar *data_ {nullptr};
+    size_t size_ {0};
+    size_t offset_ {0};
+
+    // Frame layout. Read from the header of a *.y4m file, otherwise
+    // configured.
+    bool y4m_ {false};
+    int rows_ {0};
+    int cols_ {0};
+    // Frames are served in format_ with depth_. Planar YUV 4:2:0 (I420)
+    // frames are converted to BGR. Others are served as they are stored.
+    bool i420_ {false};
+    oat::PixelFormat format_ {oat::PixelFormat::BGR};
+    int depth_ {CV_8U};
+    size_t frame_bytes_ {0};
+    double file_rate_hz_ {0.0};
+    void parseY4MHeader(void);
+
+    /**
+     * @return Pointer to the next frame in the mapped file, or nullptr at
+     * the end of the file.
+     */
+    const uchar *nextFrame(void);
+
+    // Playback speed. 0 is unthrottled.
+    double frames_per_second_;
+};
+
+}       /* namespace oat */
+#endif	/* OAT_RAWREADER_H */
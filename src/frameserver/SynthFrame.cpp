@@ -0,0 +1,321 @@
+//******************************************************************************
+//* File:   SynthFrame.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <opencv2/imgproc.hpp>
+
+#include <cpptoml.h>
+#include "../../lib/utility/OatTOMLSanitize.h"
+#include "../../lib/utility/IOFormat.h"
+#include "../../lib/utility/make_unique.h"
+
+#include "SynthFrame.h"
+
+namespace oat {
+
+namespace {
+
+// Sub-pixel bits used when drawing blobs
+constexpr int SHIFT {4};
+
+cv::Scalar getColor(const oat::config::Table table, const std::string &key,
+                    const cv::Scalar &default_color) {
+
+    oat::config::Array color_array;
+    if (!oat::config::getArray(table, key, color_array, 3))
+        return default_color;
+
+    auto bgr = color_array->array_of<int64_t>();
+    return cv::Scalar(bgr[0]->get(), bgr[1]->get(), bgr[2]->get());
+}
+
+}
+
+SynthFrame::SynthFrame(const std::string &frame_sink_address,
+                       const double frames_per_second) :
+  FrameServer(frame_sink_address)
+, frames_per_second_(frames_per_second)
+{
+    // Default config
+    pacer_.set_rate_hz(frames_per_second_);
+}
+
+void SynthFrame::configure(void) {
+
+    // A single red blob
+    blobs_.push_back(std::make_unique<Blob>());
+}
+
+void SynthFrame::configure(const std::string &config_file,
+                           const std::string &config_key) {
+
+    // Available options
+    std::vector<std::string> options {"fps", "num-samples", "width", "height",
+                                      "background", "noise", "seed", "blob",
+                                      "occluder"};
+
+    // This will throw cpptoml::parse_exception if a file
+    // with invalid TOML is provided
+    auto config = cpptoml::parse_file(config_file);
+
+    // See if a configuration was provided
+    if (config->contains(config_key)) {
+
+        // Get this components configuration table
+        auto this_config = config->get_table(config_key);
+
+        // Check for unknown options and apply the options of all servers
+        configureNode(this_config, options);
+
+        // Set the frame rate
+        oat::config::getValue(this_config, "fps", frames_per_second_, 0.0);
+        pacer_.set_rate_hz(frames_per_second_);
+
+        oat::config::getValue(this_config, "num-samples", num_samples_, (int64_t)0);
+
+        // Scene
+        int64_t val;
+        if (oat::config::getValue(this_config, "width", val, (int64_t)1))
+            cols_ = val;
+        if (oat::config::getValue(this_config, "height", val, (int64_t)1))
+            rows_ = val;
+        if (oat::config::getValue(this_config, "seed", val, (int64_t)0))
+            seed_ = val;
+
+        background_color_ = getColor(this_config, "background", background_color_);
+        oat::config::getValue(this_config, "noise", noise_sd_, 0.0);
+
+        // Moving blobs
+        auto blobs = this_config->get_table_array("blob");
+        if (blobs) {
+            for (auto &b : *blobs) {
+
+                oat::config::checkKeys({"radius", "speed", "accel", "color",
+                                        "sink"}, b);
+
+                auto blob = std::make_unique<Blob>();
+                oat::config::getValue(b, "radius", blob->radius, 0.5);
+                oat::config::getValue(b, "speed", blob->max_speed, 0.0);
+                oat::config::getValue(b, "accel", blob->accel, 0.0);
+                blob->color = getColor(b, "color", blob->color);
+                oat::config::getValue(b, "sink", blob->sink_address);
+                blobs_.push_back(std::move(blob));
+            }
+        } else {
+            blobs_.push_back(std::make_unique<Blob>());
+        }
+
+        // Occluding rectangles
+        auto occluders = this_config->get_table_array("occluder");
+        if (occluders) {
+            for (auto &o : *occluders) {
+
+                oat::config::checkKeys({"rect", "color"}, o);
+
+                oat::config::Array rect_array;
+                oat::config::getArray(o, "rect", rect_array, 4, true);
+                auto rect = rect_array->array_of<int64_t>();
+                occluders_.emplace_back(rect[0]->get(), rect[1]->get(),
+                                        rect[2]->get(), rect[3]->get());
+
+                // All occluders share a color
+                occluder_color_ = getColor(o, "color", occluder_color_);
+            }
+        }
+
+    } else {
+        throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
+    }
+}
+
+void SynthFrame::connectToNode() {
+
+    frame_sink_.bind(frame_sink_address_,
+                     static_cast<size_t>(rows_) * cols_ * 3);
+
+    shared_frame_ = frame_sink_.retrieve(rows_, cols_, CV_8UC3);
+
+    // Tell the user if the SINK fell back to ordinary pages
+    checkPagePolicy();
+
+    // Put the sample rate in the shared frame
+    if (frames_per_second_ > 0)
+        shared_frame_.sample().set_rate_hz(frames_per_second_);
+
+    // Preallocate the scene so that rendering does not allocate
+    scene_.create(rows_, cols_, CV_8UC3);
+    if (noise_sd_ > 0)
+        noise_.create(rows_, cols_, CV_16SC3);
+
+    // Scatter the blobs from the seed
+    motion_rng_.seed(seed_);
+    noise_rng_ = cv::RNG(seed_);
+    for (auto &b : blobs_) {
+
+        std::uniform_real_distribution<double>
+            x(b->radius, std::max(b->radius, cols_ - b->radius)),
+            y(b->radius, std::max(b->radius, rows_ - b->radius)),
+            v(-b->max_speed, b->max_speed);
+
+        b->position = {x(motion_rng_), y(motion_rng_)};
+        b->velocity = {v(motion_rng_), v(motion_rng_)};
+
+        // Ground truth SINKs
+        if (!b->sink_address.empty()) {
+            b->sink = std::make_unique<oat::Sink<oat::Position2D>>();
+            b->sink->bind(b->sink_address, b->sink_address);
+        }
+    }
+
+    pacer_.start();
+}
+
+bool SynthFrame::serveFrame() {
+
+    if (it_ >= num_samples_)
+        return true;
+
+    // Render the next scene before readers are locked out
+    moveBlobs();
+    render();
+
+    // START CRITICAL SECTION //
+    ////////////////////////////
+
+    // Wait for sources to read
+    frame_sink_.wait();
+
+    // Get the ring slot that will be published next
+    shared_frame_ = frame_sink_.retrieve();
+
+    // Noise is added on the way into shared memory
+    if (noise_sd_ > 0)
+        cv::add(scene_, noise_, shared_frame_, cv::noArray(), CV_8U);
+    else
+        scene_.copyTo(shared_frame_);
+
+    // Increment sample count
+    incrementSampleCount();
+    const oat::Sample sample = shared_frame_.sample();
+
+    // Tell sources there is new data
+    frame_sink_.post();
+
+    ////////////////////////////
+    //  END CRITICAL SECTION  //
+
+    // Publish the ground truth with the frame's sample number
+    for (auto &b : blobs_) {
+
+        if (!b->sink)
+            continue;
+
+        oat::Position2D &truth = b->truth;
+        truth.sample() = sample;
+        truth.position_valid = true;
+        truth.position = b->position;
+
+        // Velocity is only known in pixels per second with a frame rate
+        truth.velocity_valid = frames_per_second_ > 0;
+        truth.velocity = b->velocity * frames_per_second_;
+
+        // Mark blobs whose center is hidden
+        truth.region_valid = false;
+        for (const auto &o : occluders_) {
+            if (o.contains(cv::Point(cvFloor(b->position.x), cvFloor(b->position.y)))) {
+                truth.region_valid = true;
+                std::strncpy(truth.region, "occluded", sizeof(truth.region));
+                break;
+            }
+        }
+
+        b->sink->wait();
+        *b->sink->retrieve() = truth;
+        b->sink->post();
+    }
+
+    it_++;
+
+    pace();
+
+    return false;
+}
+
+void SynthFrame::moveBlobs() {
+
+    for (auto &b : blobs_) {
+
+        // Random acceleration, limited to the blob's maximum speed
+        if (b->accel > 0) {
+            std::normal_distribution<double> a(0.0, b->accel);
+            b->velocity.x += a(motion_rng_);
+            b->velocity.y += a(motion_rng_);
+        }
+
+        const double speed = std::hypot(b->velocity.x, b->velocity.y);
+        if (speed > b->max_speed)
+            b->velocity *= b->max_speed / speed;
+
+        b->position += b->velocity;
+
+        // Reflect off the edges of the frame
+        const double x_max = cols_ - b->radius, y_max = rows_ - b->radius;
+        if (b->position.x < b->radius) {
+            b->position.x = std::min(2 * b->radius - b->position.x, x_max);
+            b->velocity.x = -b->velocity.x;
+        } else if (b->position.x > x_max) {
+            b->position.x = std::max(2 * x_max - b->position.x, b->radius);
+            b->velocity.x = -b->velocity.x;
+        }
+
+        if (b->position.y < b->radius) {
+            b->position.y = std::min(2 * b->radius - b->position.y, y_max);
+            b->velocity.y = -b->velocity.y;
+        } else if (b->position.y > y_max) {
+            b->position.y = std::max(2 * y_max - b->position.y, b->radius);
+            b->velocity.y = -b->velocity.y;
+        }
+    }
+}
+
+void SynthFrame::render() {
+
+    scene_.setTo(background_color_);
+
+    // Blobs are drawn with sub-pixel centers so that the ground truth is
+    // not rounded to whole pixels
+    for (auto &b : blobs_)
+        cv::circle(scene_,
+                   cv::Point(cvRound(b->position.x * (1 << SHIFT)),
+                             cvRound(b->position.y * (1 << SHIFT))),
+                   cvRound(b->radius * (1 << SHIFT)),
+                   b->color, -1, cv::LINE_AA, SHIFT);
+
+    for (const auto &o : occluders_)
+        cv::rectangle(scene_, o, occluder_color_, -1);
+
+    if (noise_sd_ > 0)
+        noise_rng_.fill(noise_, cv::RNG::NORMAL, 0.0, noise_sd_);
+}
+
+} /* namespace oat */
@@ -0,0 +1,103 @@
+//******************************************************************************
+//* File:   SynthFrame.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_SYNTHFRAME_H
+#define	OAT_SYNTHFRAME_H
+
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../../lib/datatypes/Position2D.h"
+
+#include "FrameServer.h"
+
+namespace oat {
+
+/**
+ * Renders colored blobs that move randomly over a background, with optional
+ * sensor noise and occluding rectangles. The exact position of each blob can
+ * be published to its own position SINK as ground truth for the frames. The
+ * scene is generated from a seed, so runs are reproducible.
+ */
+class SynthFrame : public FrameServer {
+public:
+
+    /**
+     * @param frame_sink_address Address of node to publish shared frames to.
+     * @param frames_per_second Frame rate. 0 serves frames as quickly as the
+     * node allows.
+     */
+    SynthFrame(const std::string &frame_sink_address,
+               const double frames_per_second = 0.0);
+
+    // Implement FrameServer interface
+    void configure(void) override;
+    void configure(const std::string &config_file,
+                   const std::string &config_key) override;
+    void connectToNode(void) override;
+    bool serveFrame(void) override;
+
+private:
+
+    // Scene
+    int rows_ {480};
+    int cols_ {640};
+    cv::Scalar background_color_ {32, 32, 32};
+    double noise_sd_ {0.0};
+    cv::Mat scene_, noise_;
+    cv::RNG noise_rng_;
+
+    // Blobs move with random, but smooth, motion in pixels per frame and
+    // bounce off the edges of the frame
+    struct Blob {
+        double radius {10.0};
+        double max_speed {4.0};
+        double accel {0.5};
+        cv::Scalar color {0, 0, 255};
+        cv::Point2d position;
+        cv::Point2d velocity;
+        std::string sink_address;
+        std::unique_ptr<oat::Sink<oat::Position2D>> sink;
+        oat::Position2D truth {"truth"};
+    };
+    std::vector<std::unique_ptr<Blob>> blobs_;
+
+    // Rectangles drawn over the blobs
+    std::vector<cv::Rect> occluders_;
+    cv::Scalar occluder_color_ {0, 0, 0};
+
+    uint64_t seed_ {1};
+    std::mt19937_64 motion_rng_;
+    void moveBlobs(void);
+    void render(void);
+
+    // Sample count specification
+    int64_t num_samples_ {std::numeric_limits<int64_t>::max()};
+    int64_t it_ {0};
+
+    // Frame rate. 0 is unthrottled.
+    double frames_per_second_;
+};
+
+}       /* namespace oat */
+#endif	/* OAT_SYNTHFRAME_H */
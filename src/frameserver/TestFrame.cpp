@@ -37,8 +37,7 @@ TestFrame::TestFrame(const std::string &image_sink_address,
 , frames_per_second_(frames_per_second)
 {
     // Default config
-    calculateFramePeriod();
-    tick_ = clock_.now();
+    pacer_.set_rate_hz(frames_per_second_);
 }
 
 void TestFrame::configure(void) { }
@@ -60,14 +59,14 @@ void TestFrame::configure(const std::string &config_file,
         // Get this components configuration table
         auto this_config = config->get_table(config_key);
 
-        // Check for unknown options in the table and throw if you find them
-        oat::config::checkKeys(options, this_config);
+        // Check for unknown options and apply the options of all servers
+        configureNode(this_config, options);
 
         oat::config::getValue(this_config, "num-samples", num_samples_, 0);
 
         // Set the frame rate
         oat::config::getValue(this_config, "fps", frames_per_second_, 0.0);
-        calculateFramePeriod();
+        pacer_.set_rate_hz(frames_per_second_);
 
     } else {
         throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
@@ -76,21 +75,24 @@ void TestFrame::configure(const std::string &config_file,
 
 void TestFrame::connectToNode() {
 
-    cv::Mat example_frame = cv::imread(file_name_);
-    if (example_frame.empty())
+    test_frame_ = cv::imread(file_name_);
+    if (test_frame_.empty())
         throw std::runtime_error(file_name_ + " could not be opened.");
 
     frame_sink_.bind(frame_sink_address_,
-            example_frame.total() * example_frame.elemSize());
+            test_frame_.total() * test_frame_.elemSize());
 
     shared_frame_ = frame_sink_.retrieve(
-            example_frame.rows, example_frame.cols, example_frame.type());
+            test_frame_.rows, test_frame_.cols, test_frame_.type());
 
-    // Static image, never changes
-    example_frame.copyTo(shared_frame_);
+    // Tell the user if the SINK fell back to ordinary pages
+    checkPagePolicy();
 
     // Put the sample rate in the shared frame
-    shared_frame_.sample().set_rate_hz(1.0 / frame_period_in_sec_.count());
+    shared_frame_.sample().set_rate_hz(
+        frames_per_second_ > 0 ? frames_per_second_ : 1000000.0); // Need something
+
+    pacer_.start();
 }
 
 bool TestFrame::serveFrame() {
@@ -103,8 +105,14 @@ bool TestFrame::serveFrame() {
         // Wait for sources to read
         frame_sink_.wait();
 
+        // Static image, never changes. Only needs to be written once to each
+        // ring slot.
+        shared_frame_ = frame_sink_.retrieve();
+        if (it_ < static_cast<int64_t>(frame_sink_.ring_size()))
+            test_frame_.copyTo(shared_frame_);
+
         // Increment sample count
-        shared_frame_.sample().incrementCount();
+        incrementSampleCount();
 
         // Tell sources there is new data
         frame_sink_.post();
@@ -114,8 +122,7 @@ bool TestFrame::serveFrame() {
 
         it_++;
 
-        std::this_thread::sleep_for(frame_period_in_sec_ - (clock_.now() - tick_));
-        tick_ = clock_.now();
+        pace();
 
         return false;
     }
@@ -123,12 +130,4 @@ bool TestFrame::serveFrame() {
     return true;
 }
 
-void TestFrame::calculateFramePeriod() {
-
-    std::chrono::duration<double> frame_period {1.0 / frames_per_second_};
-
-    // Automatic conversion
-    frame_period_in_sec_ = frame_period;
-}
-
 } /* namespace oat */
@@ -45,15 +45,10 @@ private:
 
     // Image file
     std::string file_name_;
+    cv::Mat test_frame_;
 
-    // Frame speed
+    // Frame speed. 0 is unthrottled.
     double frames_per_second_;
-    void calculateFramePeriod(void);
-
-    // frame generation clock
-    std::chrono::high_resolution_clock clock_;
-    std::chrono::duration<double> frame_period_in_sec_;
-    std::chrono::high_resolution_clock::time_point tick_;
 
     // Sample count specification
     int64_t num_samples_ {std::numeric_limits<int64_t>::max()};
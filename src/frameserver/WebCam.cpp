@@ -19,6 +19,7 @@
 
 #include "WebCam.h"
 
+#include <mutex>
 #include <string>
 #include <opencv2/core/mat.hpp>
 #include <opencv2/videoio.hpp>
@@ -38,6 +39,11 @@ WebCam::WebCam(const std::string &frame_sink_name) :
     // Nothing
 }
 
+WebCam::~WebCam() {
+
+    stopCapture();
+}
+
 void WebCam::connectToNode() {
 
     cv_camera_ = std::make_unique<cv::VideoCapture>(index_);
@@ -45,61 +51,193 @@ void WebCam::connectToNode() {
     cv::Mat example_frame;
     *cv_camera_ >> example_frame;
 
-    if (use_roi_)
-        example_frame = example_frame(region_of_interest_);
+    // Whole frames are copied into shared memory, and only the region of
+    // interest is published
+    bindFrameSink(example_frame);
 
-    frame_sink_.bind(frame_sink_address_,
-            example_frame.total() * example_frame.elemSize());
+    // Tell the user if the SINK fell back to ordinary pages
+    checkPagePolicy();
 
-    shared_frame_ = frame_sink_.retrieve(
-            example_frame.rows, example_frame.cols, example_frame.type());
+    startCapture(example_frame);
 }
 
 bool WebCam::serveFrame() {
 
+    // Get a grabbed frame before readers are locked out
+    size_t index = 0;
+    frame_empty_ = !takeGrabbed(index);
+
     // START CRITICAL SECTION //
     ////////////////////////////
 
     // Wait for sources to read
     frame_sink_.wait();
 
-    if (!use_roi_) {
-            
-        *cv_camera_ >> shared_frame_;
-        frame_empty_ = shared_frame_.empty();
+    // Get the ring slot that will be published next
+    shared_frame_ = frame_sink_.retrieve();
 
+    // Increment sample count, using the time the frame was grabbed
+    if (!frame_empty_) {
+        copyToSharedFrame(pool_[index]);
+        incrementSampleCount(grab_time_[index]);
     } else {
-
-        oat::Frame to_crop;
-        *cv_camera_ >> to_crop;
-        if (!(frame_empty_ = to_crop.empty()))
-            to_crop = to_crop(region_of_interest_);
-        to_crop.copyTo(shared_frame_);
+        incrementSampleCount();
     }
 
-    // Increment sample count
-    if (shared_frame_.sample().count() == 0)
-        start_ = clock_.now();
-
-    auto period = 
-        std::chrono::duration_cast<Sample::Microseconds>(clock_.now() - start_);
-    shared_frame_.sample().incrementCount(period);
-
     // Tell sources there is new data
     frame_sink_.post();
 
     ////////////////////////////
     //  END CRITICAL SECTION  //
 
+    if (!frame_empty_)
+        giveBack(index);
+
     return frame_empty_;
 }
 
+void WebCam::startCapture(const cv::Mat &example_frame) {
+
+    // One frame for each buffered frame, plus the frames being grabbed and
+    // published
+    const size_t n = buffer_size_ + 2;
+    pool_.resize(n);
+    grab_time_.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        pool_[i].create(example_frame.rows, example_frame.cols, example_frame.type());
+        free_.push_back(i);
+    }
+
+    capturing_ = true;
+    capture_thread_ = std::thread(&WebCam::capture, this);
+}
+
+void WebCam::stopCapture() {
+
+    if (!capture_thread_.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        capturing_ = false;
+    }
+    capture_thread_.join();
+}
+
+void WebCam::capture() {
+
+    std::unique_lock<std::mutex> lock(pool_mutex_);
+
+    while (capturing_) {
+
+        // Find a frame to grab into. When the buffer is full, either the
+        // oldest grabbed frame or the one about to be grabbed is dropped.
+        bool room = true;
+        size_t index = 0;
+        if (!free_.empty()) {
+            index = free_.back();
+            free_.pop_back();
+        } else if (drop_policy_ == DROP_OLDEST) {
+            index = grabbed_.front();
+            grabbed_.pop_front();
+            dropped_++;
+        } else {
+            room = false;
+        }
+        lock.unlock();
+
+        // Grab outside the lock so that the camera is read while frames are
+        // being published
+        bool grabbed = false;
+        try {
+
+            grabbed = cv_camera_->grab();
+            const auto now = clock_.now();
+
+            if (grabbed) {
+
+                if (captured_++ == 0)
+                    start_ = now;
+
+                if (!room) {
+                    dropped_++;
+                } else {
+
+                    grab_time_[index] =
+                        std::chrono::duration_cast<Sample::Microseconds>(now - start_);
+
+                    cv_camera_->retrieve(pool_[index]);
+                }
+            }
+
+        } catch (...) {
+            lock.lock();
+            capture_error_ = std::current_exception();
+            grabbed_cv_.notify_one();
+            return;
+        }
+
+        lock.lock();
+
+        if (!grabbed) {
+
+            // The camera stopped. Frames already grabbed are still published.
+            if (room)
+                free_.push_back(index);
+            capture_ended_ = true;
+            grabbed_cv_.notify_one();
+            return;
+        }
+
+        if (room) {
+            grabbed_.push_back(index);
+            grabbed_cv_.notify_one();
+        }
+    }
+}
+
+bool WebCam::takeGrabbed(size_t &index) {
+
+    std::unique_lock<std::mutex> lock(pool_mutex_);
+    grabbed_cv_.wait(lock, [this] {
+        return !grabbed_.empty() || capture_ended_ || capture_error_;
+    });
+
+    if (capture_error_)
+        std::rethrow_exception(capture_error_);
+
+    if (grabbed_.empty())
+        return false;
+
+    // Publish the newest frame and drop the rest, or publish in order
+    if (drop_policy_ == DROP_OLDEST) {
+        index = grabbed_.back();
+        grabbed_.pop_back();
+        while (!grabbed_.empty()) {
+            free_.push_back(grabbed_.front());
+            grabbed_.pop_front();
+            dropped_++;
+        }
+    } else {
+        index = grabbed_.front();
+        grabbed_.pop_front();
+    }
+
+    return true;
+}
+
+void WebCam::giveBack(const size_t index) {
+
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    free_.push_back(index);
+}
+
 void WebCam::configure() { }
 
 void WebCam::configure(const std::string& config_file, const std::string& config_key) {
 
     // Available options
-    std::vector<std::string> options {"index", "roi"};
+    std::vector<std::string> options {"index", "roi", "buffer", "drop"};
 
     // This will throw cpptoml::parse_exception if a file
     // with invalid TOML is provided
@@ -111,13 +249,30 @@ void WebCam::configure(const std::string& config_file, const std::string& config
         // Get this components configuration table
         auto this_config = config->get_table(config_key);
 
-        // Check for unknown options in the table and throw if you find them
-        oat::config::checkKeys(options, this_config);
+        // Check for unknown options and apply the options of all servers
+        configureNode(this_config, options);
 
         // Set the camera index
         oat::config::getValue(this_config, "index", index_, MIN_INDEX);
         //cv_camera_ = std::make_unique<cv::VideoCapture>(index_);
 
+        // Set the number of grabbed frames that can wait to be published
+        int64_t buffer_size;
+        if (oat::config::getValue(this_config, "buffer", buffer_size, (int64_t)1))
+            buffer_size_ = buffer_size;
+
+        // Set which frames are dropped when the node falls behind
+        std::string drop;
+        if (oat::config::getValue(this_config, "drop", drop)) {
+            if (drop == "oldest")
+                drop_policy_ = DROP_OLDEST;
+            else if (drop == "newest")
+                drop_policy_ = DROP_NEWEST;
+            else
+                throw (std::runtime_error("Unknown drop policy '" + drop
+                                          + "'. Use oldest or newest."));
+        }
+
         // Set the ROI
         oat::config::Table roi;
         if (oat::config::getTable(this_config, "roi", roi)) {
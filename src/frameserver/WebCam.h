@@ -20,7 +20,17 @@
 #ifndef OAT_WEBCAM_H
 #define OAT_WEBCAM_H
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
+
 #include "FrameServer.h"
 
 // Forward declaration
@@ -35,6 +45,7 @@ class WebCam : public FrameServer {
 public:
 
     explicit WebCam(const std::string &frame_sink_address_);
+    ~WebCam();
 
     // Implement FrameServer interface
     void configure(void) override;
@@ -46,6 +57,18 @@ public:
     // Constants
     static constexpr int64_t MIN_INDEX {0};
 
+    /**
+     * Which frames are dropped when the node cannot keep up with the camera.
+     * DROP_OLDEST publishes the newest captured frame, dropping any older
+     * frames that were not published. DROP_NEWEST publishes captured frames
+     * in order, dropping newly grabbed frames while the buffer is full.
+     */
+    enum DropPolicy {DROP_OLDEST, DROP_NEWEST};
+
+    // Frames grabbed from the camera and frames that were not published
+    uint64_t captured(void) const { return captured_; }
+    uint64_t dropped(void) const { return dropped_; }
+
 private:
 
     // The webcam object
@@ -55,6 +78,30 @@ private:
     // frame generation clock
     std::chrono::steady_clock clock_;
     std::chrono::steady_clock::time_point start_;
+
+    // Frames are grabbed continuously on a separate thread into a pool of
+    // preallocated frames, so camera latency never holds up the node. Each
+    // frame is timestamped when it is grabbed.
+    size_t buffer_size_ {2};
+    DropPolicy drop_policy_ {DROP_OLDEST};
+    bool capturing_ {false};
+    bool capture_ended_ {false};
+    std::vector<cv::Mat> pool_;
+    std::vector<Sample::Microseconds> grab_time_;
+    std::deque<size_t> grabbed_;
+    std::vector<size_t> free_;
+    std::mutex pool_mutex_;
+    std::condition_variable grabbed_cv_;
+    std::thread capture_thread_;
+    std::exception_ptr capture_error_;
+    std::atomic<uint64_t> captured_ {0};
+    std::atomic<uint64_t> dropped_ {0};
+
+    void startCapture(const cv::Mat &example_frame);
+    void stopCapture(void);
+    void capture(void);
+    bool takeGrabbed(size_t &index);
+    void giveBack(const size_t index);
 };
 
 }      /* namespace oat */
@@ -33,6 +33,10 @@
 
 #include "TestFrame.h"
 #include "FileReader.h"
+#include "RawReader.h"
+#include "ImageReader.h"
+#include "SynthFrame.h"
+#include "MultiServer.h"
 #include "WebCam.h"
 #ifdef USE_FLYCAP
     #include "PGGigECam.h"
@@ -51,7 +55,11 @@ void printUsage(po::options_description options) {
               << "  wcam: Onboard or USB webcam.\n"
               << "  gige: Point Grey GigE camera.\n"
               << "  file: Video from file (*.mpg, *.avi, etc.).\n"
-              << "  test: Write-free static image server for performance testing.\n\n"
+              << "  raw: Uncompressed video from file (*.y4m or raw frames).\n"
+              << "  images: Sequence of numbered image files (*.png, *.jpg, etc.).\n"
+              << "  test: Write-free static image server for performance testing.\n"
+              << "  synth: Synthetic moving targets with ground-truth positions.\n"
+              << "  multi: Several of the above in lockstep, one SINK each.\n\n"
               << "SINK:\n"
               << "  User-supplied name of the memory segment to publish frames "
               << "to (e.g. raw).\n\n"
@@ -90,6 +98,7 @@ int main(int argc, char *argv[]) {
     std::string type;
     std::string file_path;
     double frames_per_second = 1000000.0; // High number
+    bool fps_used = false;
     size_t index = 0;
     std::vector<std::string> config_fk;
     bool config_used = false;
@@ -100,6 +109,10 @@ int main(int argc, char *argv[]) {
     type_hash["gige"] = 'b';
     type_hash["file"] = 'c';
     type_hash["test"] = 'd';
+    type_hash["raw"] = 'e';
+    type_hash["images"] = 'f';
+    type_hash["synth"] = 'g';
+    type_hash["multi"] = 'h';
 
     try {
 
@@ -114,7 +127,8 @@ int main(int argc, char *argv[]) {
                 ("index,i", po::value<size_t>(&index),
                 "Index of camera to capture images from.")
                 ("file,f", po::value<std::string>(&file_path),
-                "Path to video file if \'file\' is selected as the server TYPE.\n"
+                "Path to video file if \'file\' or \'raw\' is selected as the server TYPE.\n"
+                "Glob pattern matching image files if \'images\' is selected as the server TYPE.\n"
                 "Path to image file if \'test\' is selected as the server TYPE.")
                 ("fps,r", po::value<double>(&frames_per_second),
                 "Frames per second. Overriden by information in configuration file if provided.")
@@ -188,13 +202,16 @@ int main(int argc, char *argv[]) {
             }
         }
 
-        if ((type.compare("file") == 0 || type.compare("test") == 0 )
+        if ((type.compare("file") == 0 || type.compare("test") == 0
+             || type.compare("raw") == 0 || type.compare("images") == 0)
             && !variable_map.count("file")) {
             printUsage(visible_options);
-            std::cout << oat::Error("When TYPE=file or test, a file path must be specified. Exiting.\n");
+            std::cout << oat::Error("When TYPE=file, raw, images or test, a file path must be specified. Exiting.\n");
             return -1;
         }
 
+        fps_used = variable_map.count("fps") > 0;
+
     } catch (std::exception& e) {
         std::cerr << oat::Error(e.what()) << "\n";
         return 1;
@@ -205,6 +222,10 @@ int main(int argc, char *argv[]) {
     // Create the specified TYPE of detector
     std::shared_ptr<oat::FrameServer> server;
 
+    // Servers that are not clocked by hardware are unthrottled unless a rate
+    // is given
+    const double fps = fps_used ? frames_per_second : 0.0;
+
     switch (type_hash[type]) {
         case 'a':
         {
@@ -226,13 +247,32 @@ int main(int argc, char *argv[]) {
         }
         case 'c':
         {
-            server = 
-                std::make_shared<oat::FileReader>(sink, file_path, frames_per_second);
+            server = std::make_shared<oat::FileReader>(sink, file_path, fps);
             break;
         }
         case 'd':
         {
-            server = std::make_shared<oat::TestFrame>(sink, file_path, frames_per_second);
+            server = std::make_shared<oat::TestFrame>(sink, file_path, fps);
+            break;
+        }
+        case 'e':
+        {
+            server = std::make_shared<oat::RawReader>(sink, file_path, fps);
+            break;
+        }
+        case 'f':
+        {
+            server = std::make_shared<oat::ImageReader>(sink, file_path, fps);
+            break;
+        }
+        case 'g':
+        {
+            server = std::make_shared<oat::SynthFrame>(sink, fps);
+            break;
+        }
+        case 'h':
+        {
+            server = std::make_shared<oat::MultiServer>(sink, fps);
             break;
         }
         default:
@@ -264,6 +304,13 @@ int main(int argc, char *argv[]) {
         run(server);
 
         // Tell user
+        if (auto cam = std::dynamic_pointer_cast<oat::WebCam>(server)) {
+            if (cam->dropped() > 0)
+                std::cout << oat::whoMessage(server->name(),
+                          std::to_string(cam->dropped()) + " of "
+                          + std::to_string(cam->captured())
+                          + " captured frames were dropped.\n");
+        }
         std::cout << oat::whoMessage(server->name(), "Exiting.\n");
 
         // Exit
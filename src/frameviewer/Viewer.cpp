@@ -74,7 +74,7 @@ Viewer::~Viewer() {
 void Viewer::connectToNode() {
 
     // Establish our a slot in the node
-    frame_source_.touch(frame_source_address_);
+    frame_source_.touch(frame_source_address_, source_mode_);
 
     // Wait for synchronous start with sink when it binds the node
     frame_source_.connect();
@@ -90,16 +90,6 @@ bool Viewer::showImage() {
     if (node_state_ == oat::NodeState::END)
         return true;
 
-    // Clone the shared frame
-    //internal_frame_ = frame_source_.clone();
-    frame_source_.copyTo(internal_frame_);
-
-    // Tell sink it can continue
-    frame_source_.post();
-
-    ////////////////////////////
-    //  END CRITICAL SECTION  //
-
     // Get current time
     tick_ = Clock::now();
 
@@ -109,10 +99,22 @@ bool Viewer::showImage() {
 
     // If the minimum update period has passed, and display thread is not busy,
     // show frame on the display thread. This prevents frame display from
-    // holding up more important upstream processing.
-    if (duration > MIN_UPDATE_PERIOD_MS && display_complete_) 
-        display_cv_.notify_one();
+    // holding up more important upstream processing. Frames that will not be
+    // shown are not copied.
+    const bool show = duration > MIN_UPDATE_PERIOD_MS && display_complete_;
 
+    // The display thread needs its own copy of the frame
+    if (show)
+        frame_source_.copyTo(internal_frame_);
+
+    // Tell sink it can continue
+    frame_source_.post();
+
+    ////////////////////////////
+    //  END CRITICAL SECTION  //
+
+    if (show)
+        display_cv_.notify_one();
 
     // Sink was not at END state
     return false;
@@ -141,7 +143,10 @@ void Viewer::display() {
         if (internal_frame_.rows == 0 || internal_frame_.cols == 0)
             continue;
         
-        cv::imshow(name_, internal_frame_);
+        const cv::Mat shown = converter_.convert(
+            internal_frame_, demosaiced(internal_frame_.format()), CV_8U);
+
+        cv::imshow(name_, shown);
         tock_ = Clock::now();
 
         char command = cv::waitKey(1);
@@ -159,7 +164,7 @@ void Viewer::display() {
                     true);
 
             if (!err) {
-                cv::imwrite(fid, internal_frame_, compression_params_);
+                cv::imwrite(fid, shown, compression_params_);
                 std::cout << "Snapshot saved to " << fid << "\n";
             } else {
                 std::cerr << oat::Error("Snapshop file creation exited "
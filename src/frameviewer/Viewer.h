@@ -30,6 +30,7 @@
 
 #include "../../lib/datatypes/Frame.h"
 #include "../../lib/shmemdf/Source.h"
+#include "../../lib/utility/FrameConverter.h"
 
 namespace oat {
 
@@ -57,6 +58,13 @@ public:
     bool showImage(void);
     void storeSnapshotPath(const std::string &snapshot_path);
 
+    /**
+     * Set how frames are read from the SOURCE. Must be called before
+     * connectToNode(). In SourceMode::LATEST, the viewer shows the newest
+     * frame and never holds up the SINK.
+     */
+    void set_source_mode(const oat::SourceMode mode) { source_mode_ = mode; }
+
     // Accessors
     inline std::string name() const { return name_; }
 
@@ -72,9 +80,14 @@ private:
     // Image data
     oat::Frame internal_frame_;
 
+    // Demosaics raw Bayer frames and reduces 16 bit frames to 8 bits for
+    // display
+    oat::FrameConverter converter_;
+
     // Frame SOURCE to get frames to display
     const std::string frame_source_address_;
     oat::NodeState node_state_ {oat::NodeState::UNDEFINED};
+    oat::SourceMode source_mode_ {oat::SourceMode::SYNCHRONOUS};
     oat::Source<oat::SharedFrameHeader> frame_source_;
 
     // Minimum viewer refresh period
@@ -77,6 +77,7 @@ int main(int argc, char *argv[]) {
 
     std::string source;
     std::string snapshot_path;
+    bool latest {false};
     po::options_description visible_options("OPTIONS");
 
     try {
@@ -94,6 +95,10 @@ int main(int argc, char *argv[]) {
                 "If a folder is designated, the base file name will be SOURCE. "
                 "The timestamp of the snapshot will be prepended to the file name. "
                 "Defaults to the current directory.")
+                ("latest,l",
+                "Only display the newest frame. The viewer will not hold up "
+                "the SOURCE's other readers or its SINK, but frames may be "
+                "skipped.")
                 ;
 
         po::options_description hidden("HIDDEN OPTIONS");
@@ -145,6 +150,8 @@ int main(int argc, char *argv[]) {
             snapshot_path = bfs::current_path().string();
         }
 
+        latest = variable_map.count("latest") > 0;
+
     } catch (std::exception& e) {
         std::cerr << oat::Error(e.what()) << "\n";
         return -1;
@@ -162,6 +169,9 @@ int main(int argc, char *argv[]) {
         // Create a path to save snapshots
         viewer->storeSnapshotPath(snapshot_path);
 
+        if (latest)
+            viewer->set_source_mode(oat::SourceMode::LATEST);
+
         // Tell user
         std::cout << oat::whoMessage(viewer->name(),
                   "Listening to source " + oat::sourceText(source) + ".\n")
@@ -0,0 +1,482 @@
+//******************************************************************************
+//* File:   Pipeline.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "OatConfig.h" // Generated by CMake
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <pthread.h>
+#include <signal.h>
+#include <boost/interprocess/exceptions.hpp>
+#include <opencv2/core.hpp>
+
+#include "../../lib/shmemdf/Segment.h"
+#include "../../lib/utility/IOFormat.h"
+#include "../../lib/utility/OatTOMLSanitize.h"
+
+#include "../frameserver/FileReader.h"
+#include "../frameserver/TestFrame.h"
+#include "../frameserver/WebCam.h"
+#ifdef USE_FLYCAP
+    #include "../frameserver/PGGigECam.h"
+#endif
+#include "../framefilter/BackgroundSubtractor.h"
+#include "../framefilter/BackgroundSubtractorMOG.h"
+#include "../framefilter/FilterChain.h"
+#include "../framefilter/FrameMasker.h"
+#include "../framefilter/Undistorter.h"
+#include "../positiondetector/DifferenceDetector.h"
+#include "../positiondetector/HSVDetector.h"
+#include "../positionfilter/HomographyTransform2D.h"
+#include "../positionfilter/KalmanFilter2D.h"
+#include "../positionfilter/RegionFilter2D.h"
+#include "../positiongenerator/RandomAccel2D.h"
+#include "../positioncombiner/MeanPosition.h"
+#include "../decorator/Decorator.h"
+#include "../recorder/Recorder.h"
+
+#include "Pipeline.h"
+
+namespace oat {
+
+namespace {
+
+using Table = oat::config::Table;
+
+std::vector<std::string> getAddresses(const Table &table,
+                                      const std::string &key) {
+
+    std::vector<std::string> addresses;
+    oat::config::Array array;
+    if (oat::config::getArray(table, key, array)) {
+        for (auto &a : array->array_of<std::string>())
+            addresses.push_back(a->get());
+    }
+
+    return addresses;
+}
+
+std::string getAddress(const Table &table, const std::string &key) {
+
+    std::string address;
+    oat::config::getValue(table, key, address, true);
+    return address;
+}
+
+// Component types and the keys that each accepts besides 'type', 'model'
+// and 'config'
+const std::vector<std::pair<std::string, std::vector<std::string>>> types {
+    {"frameserve",  {"sink", "file", "fps", "index"}},
+    {"framefilt",   {"source", "sink"}},
+    {"posidet",     {"source", "sink"}},
+    {"posifilt",    {"source", "sink"}},
+    {"posigen",     {"sink", "rate", "num-samples"}},
+    {"posicom",     {"sources", "sink"}},
+    {"decorate",    {"positions", "source", "sink", "timestamp", "sample",
+                     "sample-code", "region"}},
+    {"record",      {"positions", "frames", "folder", "filename", "date",
+                     "overwrite", "concise"}},
+};
+
+void checkComponentKeys(const Table &table, const std::string &type) {
+
+    for (auto &t : types) {
+        if (t.first == type) {
+            std::vector<std::string> options {"type", "model", "config"};
+            options.insert(options.end(), t.second.begin(), t.second.end());
+            oat::config::checkKeys(options, table);
+            return;
+        }
+    }
+
+    throw (std::runtime_error("Invalid component type '" + type + "'.\n"));
+}
+
+// Apply the component's optional configuration file/key pair
+template <typename C>
+void configure(C &component, const Table &table) {
+
+    auto fk = getAddresses(table, "config");
+    if (fk.empty())
+        return;
+
+    if (fk.size() != 2)
+        throw (std::runtime_error("'config' must be a file/key pair.\n"));
+
+    component.configure(fk[0], fk[1]);
+}
+
+}
+
+Pipeline::Pipeline(const std::string &config_file) {
+
+    // This will throw cpptoml::parse_exception if a file with invalid TOML
+    // is provided
+    auto config = cpptoml::parse_file(config_file);
+
+    oat::config::checkKeys({"component", "export"}, config);
+
+    auto components = config->get_table_array("component");
+    if (components == nullptr)
+        throw (std::runtime_error("No [[component]] tables were found in "
+                                  + config_file + ".\n"));
+
+    // Nodes whose SINK and at least one SOURCE both belong to the pipeline
+    // are in-process, unless they must remain visible to other processes
+    std::set<std::string> sinks, sources;
+    for (auto &c : *components) {
+
+        std::string type;
+        oat::config::getValue(c, "type", type, true);
+        checkComponentKeys(c, type);
+
+        if (c->contains("sink"))
+            sinks.insert(getAddress(c, "sink"));
+        if (c->contains("source"))
+            sources.insert(getAddress(c, "source"));
+        for (auto key : {"sources", "positions", "frames"})
+            for (auto &a : getAddresses(c, key))
+                sources.insert(a);
+    }
+
+    auto exports = getAddresses(config, "export");
+    for (auto &s : sinks) {
+        if (sources.count(s) && std::find(exports.begin(), exports.end(), s)
+                                == exports.end()) {
+            oat::useInProcessTransport(s);
+            in_process_nodes_.insert(s);
+        }
+    }
+
+    for (auto &c : *components)
+        stages_.push_back(makeStage(c));
+}
+
+Pipeline::Stage Pipeline::makeStage(const std::shared_ptr<cpptoml::table> &c) {
+
+    std::string type, model;
+    oat::config::getValue(c, "type", type, true);
+    oat::config::getValue(c, "model", model);
+
+    Stage stage;
+
+    if (type == "frameserve") {
+
+        auto sink = getAddress(c, "sink");
+        std::string file;
+        double fps = 1000000.0; // High number
+        int64_t index = 0;
+        oat::config::getValue(c, "file", file);
+        oat::config::getValue(c, "fps", fps, 0.0);
+        oat::config::getValue(c, "index", index, (int64_t)0);
+
+        std::shared_ptr<oat::FrameServer> server;
+        if (model == "wcam")
+            server = std::make_shared<oat::WebCam>(sink);
+#ifdef USE_FLYCAP
+        else if (model == "gige")
+            server = std::make_shared<oat::PGGigECam>(sink, index, fps);
+#endif
+        else if (model == "file")
+            server = std::make_shared<oat::FileReader>(sink, file,
+                                                       c->contains("fps") ? fps : 0.0);
+        else if (model == "test")
+            server = std::make_shared<oat::TestFrame>(sink, file,
+                                                      c->contains("fps") ? fps : 0.0);
+
+        if (server) {
+            if (c->contains("config"))
+                configure(*server, c);
+            else
+                server->configure();
+
+            auto s = server.get();
+            stage.connect = [s] { s->connectToNode(); };
+            stage.process = [s] { return s->serveFrame(); };
+            stage.name = server->name();
+            stage.component = server;
+        }
+
+    } else if (type == "framefilt") {
+
+        auto source = getAddress(c, "source");
+        auto sink = getAddress(c, "sink");
+
+        std::shared_ptr<oat::FrameFilter> filter;
+        if (model == "bsub")
+            filter = std::make_shared<oat::BackgroundSubtractor>(source, sink);
+        else if (model == "mask")
+            filter = std::make_shared<oat::FrameMasker>(source, sink);
+        else if (model == "mog")
+            filter = std::make_shared<oat::BackgroundSubtractorMOG>(source, sink);
+        else if (model == "undistort")
+            filter = std::make_shared<oat::Undistorter>(source, sink);
+        else if (model == "chain")
+            filter = std::make_shared<oat::FilterChain>(source, sink);
+
+        if (filter) {
+            configure(*filter, c);
+
+            auto f = filter.get();
+            stage.connect = [f] { f->connectToNode(); };
+            stage.process = [f] { return f->processFrame(); };
+            stage.name = filter->name();
+            stage.component = filter;
+        }
+
+    } else if (type == "posidet") {
+
+        auto source = getAddress(c, "source");
+        auto sink = getAddress(c, "sink");
+
+        std::shared_ptr<oat::PositionDetector> detector;
+        if (model == "diff")
+            detector = std::make_shared<oat::DifferenceDetector>(source, sink);
+        else if (model == "hsv")
+            detector = std::make_shared<oat::HSVDetector>(source, sink);
+
+        if (detector) {
+            configure(*detector, c);
+
+            // Tuning GUIs must run on the main thread
+            detector->tuning_on(false);
+
+            auto d = detector.get();
+            stage.connect = [d] { d->connectToNode(); };
+            stage.process = [d] { return d->process(); };
+            stage.name = detector->name();
+            stage.component = detector;
+        }
+
+    } else if (type == "posifilt") {
+
+        auto source = getAddress(c, "source");
+        auto sink = getAddress(c, "sink");
+
+        std::shared_ptr<oat::PositionFilter> filter;
+        if (model == "kalman")
+            filter = std::make_shared<oat::KalmanFilter2D>(source, sink);
+        else if (model == "homography")
+            filter = std::make_shared<oat::HomographyTransform2D>(source, sink);
+        else if (model == "region")
+            filter = std::make_shared<oat::RegionFilter2D>(source, sink);
+
+        if (filter) {
+            configure(*filter, c);
+
+            auto f = filter.get();
+            stage.connect = [f] { f->connectToNode(); };
+            stage.process = [f] { return f->process(); };
+            stage.name = filter->name();
+            stage.component = filter;
+        }
+
+    } else if (type == "posigen") {
+
+        auto sink = getAddress(c, "sink");
+        double rate = -1.0; // Don't enforce sample rate
+        int64_t num_samples = std::numeric_limits<int64_t>::max();
+        oat::config::getValue(c, "rate", rate, 0.0);
+        oat::config::getValue(c, "num-samples", num_samples, (int64_t)0);
+
+        std::shared_ptr<oat::PositionGenerator<oat::Position2D>> posigen;
+        if (model == "rand2D")
+            posigen = std::make_shared<oat::RandomAccel2D>(sink, rate, num_samples);
+
+        if (posigen) {
+            configure(*posigen, c);
+
+            auto p = posigen.get();
+            stage.connect = [p] { p->connectToNode(); };
+            stage.process = [p] { return p->process(); };
+            stage.name = posigen->name();
+            stage.component = posigen;
+        }
+
+    } else if (type == "posicom") {
+
+        auto sources = getAddresses(c, "sources");
+        auto sink = getAddress(c, "sink");
+
+        std::shared_ptr<oat::PositionCombiner> combiner;
+        if (model == "mean")
+            combiner = std::make_shared<oat::MeanPosition>(sources, sink);
+
+        if (combiner) {
+            configure(*combiner, c);
+
+            auto p = combiner.get();
+            stage.connect = [p] { p->connectToNodes(); };
+            stage.process = [p] { return p->process(); };
+            stage.name = combiner->name();
+            stage.component = combiner;
+        }
+
+    } else if (type == "decorate") {
+
+        auto decorator =
+            std::make_shared<oat::Decorator>(getAddresses(c, "positions"),
+                                             getAddress(c, "source"),
+                                             getAddress(c, "sink"));
+
+        bool value = false;
+        if (oat::config::getValue(c, "timestamp", value))
+            decorator->set_print_timestamp(value);
+        if (oat::config::getValue(c, "sample", value))
+            decorator->set_print_sample_number(value);
+        if (oat::config::getValue(c, "sample-code", value))
+            decorator->set_encode_sample_number(value);
+        if (oat::config::getValue(c, "region", value))
+            decorator->set_print_region(value);
+
+        auto d = decorator.get();
+        stage.connect = [d] { d->connectToNodes(); };
+        stage.process = [d] { return d->decorateFrame(); };
+        stage.name = decorator->name();
+        stage.component = decorator;
+
+    } else if (type == "record") {
+
+        auto recorder =
+            std::make_shared<oat::Recorder>(getAddresses(c, "positions"),
+                                            getAddresses(c, "frames"));
+
+        std::string save_path = ".", file_name;
+        bool prepend_timestamp = false, allow_overwrite = false, concise = false;
+        oat::config::getValue(c, "folder", save_path);
+        oat::config::getValue(c, "filename", file_name);
+        oat::config::getValue(c, "date", prepend_timestamp);
+        oat::config::getValue(c, "overwrite", allow_overwrite);
+        oat::config::getValue(c, "concise", concise);
+
+        recorder->set_save_path(save_path);
+        recorder->set_file_name(file_name);
+        recorder->set_prepend_timestamp(prepend_timestamp);
+        recorder->set_allow_overwrite(allow_overwrite);
+        recorder->set_verbose_file(!concise);
+
+        auto r = recorder.get();
+        stage.connect = [r] { r->initializeRecording(); r->connectToNodes(); };
+        stage.process = [r] { return r->writeStreams(); };
+        stage.name = recorder->name();
+        stage.component = recorder;
+    }
+
+    if (!stage.component)
+        throw (std::runtime_error("Invalid model '" + model
+                                  + "' for component type '" + type + "'.\n"));
+
+    return stage;
+}
+
+bool Pipeline::run(const volatile sig_atomic_t &quit) {
+
+    // Stops every stage. The quit flag is only shared with the signal
+    // handler, so it is forwarded to the stages through this flag.
+    std::atomic<bool> stop {false};
+    std::atomic<bool> failed {false};
+
+    // Stages that have not exited yet
+    size_t running = stages_.size();
+    std::mutex running_mutex;
+    std::condition_variable exited_cv;
+
+    // Block SIGINT in the stage threads, which inherit this thread's signal
+    // mask, so that the handler only ever runs on this thread
+    sigset_t sigint, old_mask;
+    sigemptyset(&sigint);
+    sigaddset(&sigint, SIGINT);
+    pthread_sigmask(SIG_BLOCK, &sigint, &old_mask);
+
+    std::vector<std::thread> threads;
+
+    for (auto &stage : stages_) {
+
+        threads.emplace_back([&](Stage s) {
+
+            try {
+
+                s.connect();
+
+                while (!stop && !s.process()) { }
+
+            } catch (const boost::interprocess::interprocess_exception &ex) {
+
+                // Error code 1 indicates a SIGNINT during a call to wait(),
+                // which is normal behavior
+                if (ex.get_error_code() != 1) {
+                    std::cerr << oat::whoError(s.name, ex.what()) << "\n";
+                    failed = true;
+                }
+            } catch (const std::runtime_error &ex) {
+                std::cerr << oat::whoError(s.name, ex.what()) << "\n";
+                failed = true;
+            } catch (const cv::Exception &ex) {
+                std::cerr << oat::whoError(s.name, ex.what()) << "\n";
+                failed = true;
+            } catch (...) {
+                std::cerr << oat::whoError(s.name, "Unknown exception.\n");
+                failed = true;
+            }
+
+            // Stop the components upstream of a failed one. Those downstream
+            // see the end of its streams when it is destroyed.
+            if (failed)
+                stop = true;
+
+            std::cout << oat::whoMessage(s.name, "Exiting.\n");
+            s.component.reset();
+
+            {
+                std::lock_guard<std::mutex> lock(running_mutex);
+                running--;
+            }
+            exited_cv.notify_one();
+
+        }, std::move(stage));
+    }
+
+    pthread_sigmask(SIG_SETMASK, &old_mask, nullptr);
+
+    stages_.clear();
+
+    // Pass on ctrl-c until every stage has exited
+    {
+        std::unique_lock<std::mutex> lock(running_mutex);
+        while (running > 0) {
+            if (quit)
+                stop = true;
+            exited_cv.wait_for(lock, std::chrono::milliseconds(10));
+        }
+    }
+
+    for (auto &t : threads)
+        t.join();
+
+    return !failed;
+}
+
+}       /* namespace oat */
@@ -0,0 +1,92 @@
+//******************************************************************************
+//* File:   Pipeline.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_PIPELINE_H
+#define	OAT_PIPELINE_H
+
+#include <csignal>
+#include <functional>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+#include <cpptoml.h>
+
+namespace oat {
+
+/**
+ * A set of components that run as threads of a single process. Nodes whose
+ * SINK and SOURCEs all belong to the pipeline use the in-process transport,
+ * so frames and positions never leave the process's heap.
+ */
+class Pipeline {
+
+public:
+
+    /**
+     * Build the pipeline described by a TOML file. Each [[component]] table
+     * names a component type, its model, and its node addresses.
+     * @param config_file Configuration file path.
+     */
+    explicit Pipeline(const std::string &config_file);
+
+    /**
+     * Run each component in its own thread until the quit flag is set,
+     * a component fails, or every component has reached the end of its
+     * input streams. SIGINT is blocked in the component threads.
+     * @param quit Flag that stops the pipeline. Set by a signal handler,
+     * which then runs on the calling thread.
+     * @return True if every component exited normally.
+     */
+    bool run(const volatile sig_atomic_t &quit);
+
+    /**
+     * @return Addresses of the nodes that use the in-process transport.
+     */
+    const std::set<std::string> & in_process_nodes(void) const {
+        return in_process_nodes_;
+    }
+
+    /**
+     * @return Number of components.
+     */
+    size_t size(void) const { return stages_.size(); }
+
+private:
+
+    /**
+     * A component and the calls that drive it. The component is destroyed
+     * in its own thread so that its SINKs signal the end of their streams
+     * to the rest of the pipeline as soon as it exits.
+     */
+    struct Stage {
+        std::string name;
+        std::shared_ptr<void> component;
+        std::function<void(void)> connect;
+        std::function<bool(void)> process;
+    };
+
+    std::vector<Stage> stages_;
+    std::set<std::string> in_process_nodes_;
+
+    Stage makeStage(const std::shared_ptr<cpptoml::table> &config);
+};
+
+}       /* namespace oat */
+#endif	/* OAT_PIPELINE_H */
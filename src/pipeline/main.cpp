@@ -0,0 +1,154 @@
+//******************************************************************************
+//* File:   oat pipeline main.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//****************************************************************************
+
+#include "OatConfig.h" // Generated by CMake
+
+#include <csignal>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <boost/program_options.hpp>
+#include <cpptoml.h>
+
+#include "../../lib/utility/IOFormat.h"
+
+#include "Pipeline.h"
+
+namespace po = boost::program_options;
+
+volatile sig_atomic_t quit = 0;
+
+void printUsage(po::options_description options) {
+    std::cout << "Usage: pipeline [INFO]\n"
+              << "   or: pipeline CONFIG\n"
+              << "Run the components described by the TOML file CONFIG as threads of\n"
+              << "a single process. Nodes that connect two components of the pipeline\n"
+              << "are kept in process memory unless they are exported.\n\n"
+              << "CONFIG:\n"
+              << "  Path to a TOML file containing a [[component]] table for each\n"
+              << "  component (e.g. pipeline.toml).\n\n"
+              << options << "\n";
+}
+
+// Signal handler to ensure shared resources are cleaned on exit due to ctrl-c
+void sigHandler(int) {
+    quit = 1;
+}
+
+int main(int argc, char *argv[]) {
+
+    std::signal(SIGINT, sigHandler);
+
+    std::string config_file;
+
+    try {
+
+        po::options_description options("INFO");
+        options.add_options()
+                ("help", "Produce help message.")
+                ("version,v", "Print version information.")
+                ;
+
+        po::options_description hidden("HIDDEN OPTIONS");
+        hidden.add_options()
+                ("config", po::value<std::string>(&config_file),
+                "Pipeline configuration file.")
+                ;
+
+        po::positional_options_description positional_options;
+        positional_options.add("config", 1);
+
+        po::options_description visible_options("OPTIONS");
+        visible_options.add(options);
+
+        po::options_description all_options("ALL OPTIONS");
+        all_options.add(options).add(hidden);
+
+        po::variables_map variable_map;
+        po::store(po::command_line_parser(argc, argv)
+                .options(all_options)
+                .positional(positional_options)
+                .run(),
+                variable_map);
+        po::notify(variable_map);
+
+        // Use the parsed options
+        if (variable_map.count("help")) {
+            printUsage(visible_options);
+            return 0;
+        }
+
+        if (variable_map.count("version")) {
+            std::cout << "Oat Pipeline version "
+                      << Oat_VERSION_MAJOR
+                      << "."
+                      << Oat_VERSION_MINOR
+                      << "\n";
+            std::cout << "Written by Jonathan P. Newman in the MWL@MIT.\n";
+            std::cout << "Licensed under the GPL3.0.\n";
+            return 0;
+        }
+
+        if (!variable_map.count("config")) {
+            printUsage(visible_options);
+            std::cerr << oat::Error("A CONFIG file must be specified.\n");
+            return -1;
+        }
+
+    } catch (std::exception& e) {
+        std::cerr << oat::Error(e.what()) << "\n";
+        return -1;
+    } catch (...) {
+        std::cerr << oat::Error("Exception of unknown type.\n");
+        return -1;
+    }
+
+    // The business
+    try {
+
+        oat::Pipeline pipeline(config_file);
+
+        // Tell user
+        std::cout << oat::whoMessage("pipeline",
+                "Running " + std::to_string(pipeline.size()) + " components.\n");
+        for (auto &n : pipeline.in_process_nodes())
+            std::cout << oat::whoMessage("pipeline",
+                    "Node " + oat::sinkText(n) + " is in-process.\n");
+        std::cout << oat::whoMessage("pipeline", "Press CTRL+C to exit.\n");
+
+        // Run until ctrl-c or until every component reaches the end of
+        // its streams
+        if (pipeline.run(quit))
+            return 0;
+
+    } catch (const cpptoml::parse_exception &ex) {
+        std::cerr << oat::whoError("pipeline",
+                     "Failed to parse configuration file " + config_file + "\n")
+                  << oat::whoError("pipeline", ex.what())
+                  << "\n";
+    } catch (const std::runtime_error &ex) {
+        std::cerr << oat::whoError("pipeline", ex.what())
+                  << "\n";
+    } catch (...) {
+        std::cerr << oat::whoError("pipeline", "Unknown exception.\n");
+    }
+
+    // Exit failure
+    return -1;
+}
@@ -38,15 +38,19 @@ DifferenceDetector::DifferenceDetector(const std::string &frame_source_address,
   PositionDetector(frame_source_address, position_sink_address)
 , tuning_image_title_(position_sink_address + "_tuning")
 {
+    // Only intensity is used, so colour and Bayer frames are converted
+    // before they get here
+    input_format_ = PixelFormat::GREY;
+
     // Cannot use initializer because if this is set to 0, blur_on
     // must be set to false
     set_blur_size(2);
 }
 
-void DifferenceDetector::detectPosition(cv::Mat &frame, oat::Position2D &position) {
+void DifferenceDetector::detectPosition(const cv::Mat &frame, oat::Position2D &position) {
 
     if (tuning_on_)
-        tune_frame_ = frame.clone();
+        cv::cvtColor(frame, tune_frame_, cv::COLOR_GRAY2BGR);
 
     applyThreshold(frame);
 
@@ -150,22 +154,19 @@ void DifferenceDetector::tune(cv::Mat &frame, const oat::Position2D &position) {
     cv::waitKey(1);
 }
 
-void DifferenceDetector::applyThreshold(cv::Mat &frame) {
+void DifferenceDetector::applyThreshold(const cv::Mat &frame) {
 
     if (last_image_set_) {
-        cv::cvtColor(frame, frame, cv::COLOR_BGR2GRAY);
         cv::absdiff(frame, last_image_, threshold_frame_);
         cv::threshold(threshold_frame_, threshold_frame_, difference_intensity_threshold_, 255, cv::THRESH_BINARY);
         if (blur_on_) {
             cv::blur(threshold_frame_, threshold_frame_, blur_size_);
         }
         cv::threshold(threshold_frame_, threshold_frame_, difference_intensity_threshold_, 255, cv::THRESH_BINARY);
-        last_image_ = frame.clone(); // Get a copy of the last image
+        frame.copyTo(last_image_); // Keep the last image
     } else {
-        threshold_frame_ = frame.clone();
-        cv::cvtColor(threshold_frame_, threshold_frame_, cv::COLOR_BGR2GRAY);
-        last_image_ = frame.clone();
-        cv::cvtColor(last_image_, last_image_, cv::COLOR_BGR2GRAY);
+        frame.copyTo(last_image_);
+        threshold_frame_ = last_image_.clone();
         last_image_set_ = true;
     }
 }
@@ -50,7 +50,7 @@ public:
      * @param frame frame to look for object in.
      * @return  detected object position.
      */
-    void detectPosition(cv::Mat &frame, oat::Position2D &position) override;
+    void detectPosition(const cv::Mat &frame, oat::Position2D &position) override;
 
     void configure(const std::string &config_file,
                    const std::string &config_key) override;
@@ -63,7 +63,7 @@ public:
 private:
 
     // Intermediate variables
-    cv::Mat this_image_, last_image_;
+    cv::Mat last_image_;
     cv::Mat threshold_frame_;
     bool last_image_set_ {false};
 
@@ -85,7 +85,7 @@ private:
     // Processing functions
     void createTuningWindows(void);
     void tune(cv::Mat &frame, const oat::Position2D &position);
-    void applyThreshold(cv::Mat &frame);
+    void applyThreshold(const cv::Mat &frame);
 };
 
 // Tuning GUI callbacks
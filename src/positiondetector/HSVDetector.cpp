@@ -45,15 +45,15 @@ HSVDetector::HSVDetector(const std::string &frame_source_address,
     set_dilate_size(10);
 }
 
-void HSVDetector::detectPosition(cv::Mat &frame, oat::Position2D &position) {
+void HSVDetector::detectPosition(const cv::Mat &frame, oat::Position2D &position) {
 
     // Transform frame to HSV
     // (Extremely expensive operation)
-    cv::cvtColor(frame, frame, cv::COLOR_BGR2HSV);
+    cv::cvtColor(frame, hsv_frame_, cv::COLOR_BGR2HSV);
 
     // Threshold HSV channels
     // (Very expensive operation)
-    cv::inRange(frame,
+    cv::inRange(hsv_frame_,
                 cv::Scalar(h_min_, s_min_, v_min_),
                 cv::Scalar(h_max_, s_max_, v_max_),
                 threshold_frame_);
@@ -68,7 +68,7 @@ void HSVDetector::detectPosition(cv::Mat &frame, oat::Position2D &position) {
     // Threshold frame will be destroyed by the transform below, so we need to use
     // it to form the frame that will be shown in the tuning window here
     if (tuning_on_)
-        frame.setTo(0, threshold_frame_ == 0).clone();
+        hsv_frame_.setTo(0, threshold_frame_ == 0);
 
     // Find the largest contour in the threshold image
     siftContours(threshold_frame_,
@@ -79,7 +79,7 @@ void HSVDetector::detectPosition(cv::Mat &frame, oat::Position2D &position) {
 
     // Use the GUI tuner if requested
     if (tuning_on_)
-        tune(frame, position);
+        tune(hsv_frame_, position);
 }
 
 void HSVDetector::configure(const std::string &config_file,
@@ -56,7 +56,7 @@ public:
      * @param Frame to look for object within.
      * @param position Detected object position.
      */
-    void detectPosition(cv::Mat &frame, oat::Position2D &position) override;
+    void detectPosition(const cv::Mat &frame, oat::Position2D &position) override;
 
     void configure(const std::string &config_file,
                    const std::string &config_key) override;
@@ -74,7 +74,7 @@ private:
     bool erode_on_ {false}, dilate_on_ {false};
 
     // Internal matricies
-    cv::Mat threshold_frame_, erode_element_, dilate_element_;
+    cv::Mat hsv_frame_, threshold_frame_, erode_element_, dilate_element_;
 
     // HSV threshold values
     int h_min_ {0}, h_max_ {256};
@@ -34,6 +34,7 @@ PositionDetector::PositionDetector(const std::string &frame_source_address,
   name_("posidet[" + frame_source_address + "->" + position_sink_address + "]")
 , frame_source_address_(frame_source_address)
 , position_sink_address_(position_sink_address)
+, converter_(frame_source_address)
 {
   // Nothing
 }
@@ -60,18 +61,26 @@ bool PositionDetector::process() {
     if (frame_source_.wait() == oat::NodeState::END)
         return true;
 
-    // Clone the shared frame
-    frame_source_.copyTo(internal_frame_);
+    // Read the shared frame in place
+    auto lease = frame_source_.lease();
+    internal_position_.sample() = lease.frame().sample_copy();
+
+    // Conversions are private already. Otherwise, take a private copy so
+    // that the upstream SINK is not held up during detection.
+    cv::Mat frame = converter_.convert(lease.frame(), input_format_, CV_8U);
+    if (frame.data == lease.frame().data) {
+        frame.copyTo(internal_frame_);
+        frame = internal_frame_;
+    }
 
     // Tell sink it can continue
-    frame_source_.post();
+    lease.release();
 
     ////////////////////////////
     //  END CRITICAL SECTION  //
 
-    // Propagate sample info and detect position
-    internal_position_.sample() = internal_frame_.sample_copy();
-    detectPosition(internal_frame_, internal_position_);
+    // Detect position
+    detectPosition(frame, internal_position_);
 
     // START CRITICAL SECTION //
     ////////////////////////////
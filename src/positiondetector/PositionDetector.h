@@ -26,6 +26,7 @@
 #include "../../lib/datatypes/Position2D.h"
 #include "../../lib/shmemdf/Source.h"
 #include "../../lib/shmemdf/Sink.h"
+#include "../../lib/utility/FrameConverter.h"
 
 namespace oat {
 
@@ -79,28 +80,35 @@ protected:
 
     /**
      * Perform object position detection.
-     * @param Frame to look for object within.
+     * @param Frame to look for object within, in input_format_ with 8 bit
+     * depth. May be shared with other readers and must not be modified.
      * @param position Detected object position.
      */
-    virtual void detectPosition(cv::Mat &frame, oat::Position2D &position) = 0;
+    virtual void detectPosition(const cv::Mat &frame, oat::Position2D &position) = 0;
     
     // Detector name
     const std::string name_;
 
+    // Pixel format that detectPosition() works with. Frames in other formats
+    // (e.g. raw Bayer) are converted before detection.
+    PixelFormat input_format_ {PixelFormat::BGR};
+
     // Use GUI to tune detection parameters
     bool tuning_on_ {false};
     bool tuning_windows_created_ {false};
 
 private:
 
-    // Current frame
-    oat::Frame internal_frame_;
     oat::Position2D internal_position_ {"internal"};
+
+    // Private copy of frames that need no conversion
+    cv::Mat internal_frame_;
     oat::Position2D * shared_position_;
 
     // Frame source
     const std::string frame_source_address_;
     oat::Source<oat::SharedFrameHeader> frame_source_;
+    oat::FrameConverter converter_;
 
     // Position sink
     const std::string position_sink_address_;
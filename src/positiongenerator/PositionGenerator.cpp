@@ -45,8 +45,6 @@ PositionGenerator<T>::PositionGenerator(const std::string &position_sink_address
         // Need something so that positions are not nonsense
         generateSamplePeriod(10000.0);
     }
-
-    tick_ = clock_.now();
 }
 
 template <typename T>
@@ -59,7 +57,8 @@ void PositionGenerator<T>::configure(const std::string &config_file,
     // Available options
     std::vector<std::string> options {"rate-hz",
                                       "num-samples",
-                                      "room"};
+                                      "room",
+                                      "spin-us"};
 
     // This will throw cpptoml::parse_exception if a file
     // with invalid TOML is provided
@@ -76,8 +75,16 @@ void PositionGenerator<T>::configure(const std::string &config_file,
 
         // Sample generation period
         double rate_hz;
-        if (oat::config::getValue(this_config, "rate-hz", rate_hz, 0))
-             generateSamplePeriod(rate_hz);
+        if (oat::config::getValue(this_config, "rate-hz", rate_hz, 0.0)
+            && rate_hz > 0) {
+            enforce_sample_clock_ = true;
+            generateSamplePeriod(rate_hz);
+        }
+
+        // Spend the end of each sample period spinning instead of sleeping
+        int64_t spin_us;
+        if (oat::config::getValue(this_config, "spin-us", spin_us, (int64_t)0))
+            pacer_.set_spin(std::chrono::microseconds(spin_us));
 
         // Number of position samples
         oat::config::getValue(this_config, "num-samples", num_samples_, 0);
@@ -105,6 +112,8 @@ void PositionGenerator<T>::connectToNode() {
     position_sink_.bind(position_sink_address_, position_sink_address_);
     shared_position_ = position_sink_.retrieve();
     shared_position_->sample().set_rate_hz(1.0 / sample_period_in_sec_.count());
+
+    pacer_.start();
 }
 
 template<typename T>
@@ -113,11 +122,9 @@ bool PositionGenerator<T>::process() {
     // Generate internal position
     bool eof = generatePosition(internal_position_);
 
-    if (enforce_sample_clock_) {
-        auto tock = clock_.now();
-        std::this_thread::sleep_for(sample_period_in_sec_ - (tock - tick_));
-        tick_ = clock_.now();
-    }
+    // Wait for the deadline of this sample
+    if (pacer_.enabled())
+        position_sink_.recordLateness(pacer_.wait());
 
     // This is a pure SINK so it increments the sample count
     internal_position_.sample().incrementCount();
@@ -146,6 +153,9 @@ void PositionGenerator<T>::generateSamplePeriod(const double samples_per_second)
 
     // Automatic conversion
     sample_period_in_sec_ = period;
+
+    if (enforce_sample_clock_)
+        pacer_.set_rate_hz(samples_per_second);
 }
 
 // Explicit declaration to get around link errors due to this being in its own
@@ -28,6 +28,7 @@
 
 #include "../../lib/datatypes/Position2D.h"
 #include "../../lib/shmemdf/Sink.h"
+#include "../../lib/utility/Pacer.h"
 
 namespace oat {
 
@@ -98,9 +99,8 @@ protected:
 
     // Test position sample clock
     bool enforce_sample_clock_ {false};
-    std::chrono::high_resolution_clock clock_;
     std::chrono::duration<double> sample_period_in_sec_;
-    std::chrono::high_resolution_clock::time_point tick_;
+    oat::Pacer pacer_;
 
     // Periodic boundaries in which simulated particle resides.
     cv::Rect_<double> room_ {0, 0, 100, 100};
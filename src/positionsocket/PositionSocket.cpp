@@ -37,7 +37,7 @@ PositionSocket::PositionSocket(const std::string &position_source_address) :
 void PositionSocket::connectToNode() {
 
     // Establish our a slot in the node 
-    position_source_.touch(position_source_address_);
+    position_source_.touch(position_source_address_, source_mode_);
 
     // Wait for sychronous start with sink when it binds the node
     position_source_.connect();
@@ -54,6 +54,13 @@ public:
      */
     bool process(void);
 
+    /**
+     * Set how positions are read from the SOURCE. Must be called before
+     * connectToNode(). In SourceMode::LATEST, the socket sends the newest
+     * position and never holds up the SINK.
+     */
+    void set_source_mode(const oat::SourceMode mode) { source_mode_ = mode; }
+
     // Accessors
     std::string name(void) const { return name_; }
 
@@ -73,6 +80,7 @@ private:
     // The position SOURCE
     std::string position_source_address_;
     oat::NodeState node_state_ {oat::NodeState::UNDEFINED};
+    oat::SourceMode source_mode_ {oat::SourceMode::SYNCHRONOUS};
     oat::Source<oat::Position2D> position_source_;
 
     // The current, internally allocated position
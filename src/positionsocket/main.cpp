@@ -95,6 +95,7 @@ int main(int argc, char *argv[]) {
     std::string type;
     std::string source;
     std::vector<std::string> endpoint;
+    bool latest {false};
     po::options_description visible_options("OPTIONS");
 
     std::unordered_map<std::string, char> type_hash;
@@ -112,6 +113,14 @@ int main(int argc, char *argv[]) {
                 //TODO: Serialization protocol (JSON, CBOR, etc)
                 ;
 
+        po::options_description config("CONFIGURATION");
+        config.add_options()
+                ("latest,l",
+                "Only send the newest position. The socket will not hold up "
+                "the SOURCE's other readers or its SINK, but positions may be "
+                "skipped.")
+                ;
+
         po::options_description hidden("HIDDEN OPTIONS");
         hidden.add_options()
                 ("type", po::value<std::string>(&type), "Filter TYPE.")
@@ -127,10 +136,10 @@ int main(int argc, char *argv[]) {
         positional_options.add("positionsource", 1);
         positional_options.add("endpoint", -1);
 
-        visible_options.add(options);
+        visible_options.add(options).add(config);
 
         po::options_description all_options("ALL OPTIONS");
-        all_options.add(options).add(hidden);
+        all_options.add(options).add(config).add(hidden);
 
         po::variables_map variable_map;
         po::store(po::command_line_parser(argc, argv)
@@ -169,6 +178,8 @@ int main(int argc, char *argv[]) {
             return -1;
         }
 
+        latest = variable_map.count("latest") > 0;
+
         if (!variable_map["endpoint"].empty()) {
 
             endpoint = variable_map["endpoint"].as<std::vector<std::string> >();
@@ -234,6 +245,9 @@ int main(int argc, char *argv[]) {
 
         name = socket->name();
 
+        if (latest)
+            socket->set_source_mode(oat::SourceMode::LATEST);
+
         // Tell user
         std::cout << oat::whoMessage(socket->name(),
                 "Listening to source " + oat::sourceText(source) + ".\n")
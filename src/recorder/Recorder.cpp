@@ -33,6 +33,7 @@
 #include <boost/dynamic_bitset.hpp>
 
 #include "../../lib/utility/FileFormat.h"
+#include "../../lib/utility/FrameConverter.h"
 #include "../../lib/utility/IOFormat.h"
 #include "../../lib/utility/make_unique.h"
 #include "../../lib/shmemdf/SharedFrameHeader.h"
@@ -218,7 +219,10 @@ bool Recorder::writeStreams() {
 
 void Recorder::writeFramesToFileFromBuffer(uint32_t writer_idx) {
 
-    cv::Mat m;
+    // Videos are written in 8 bit BGR. Other frames (e.g. grey or raw Bayer)
+    // are converted here, off the thread that reads the SOURCEs.
+    oat::Frame m;
+    cv::Mat bgr, scratch;
     while (running_) {
 
         std::unique_lock<std::mutex> lk(*frame_write_mutexes_[writer_idx]);
@@ -232,7 +236,12 @@ void Recorder::writeFramesToFileFromBuffer(uint32_t writer_idx) {
                                       m);
             }
 
-            video_writers_[writer_idx]->write(m);
+            if (m.type() == CV_8UC3) {
+                video_writers_[writer_idx]->write(m);
+            } else {
+                oat::convertFrame(m, m.format(), bgr, PixelFormat::BGR, CV_8U, scratch);
+                video_writers_[writer_idx]->write(bgr);
+            }
         }
     }
 }
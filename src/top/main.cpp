@@ -0,0 +1,363 @@
+//******************************************************************************
+//* File:   oat top main.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//****************************************************************************
+
+#include "OatConfig.h" // Generated by CMake
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/program_options.hpp>
+#include <boost/interprocess/exceptions.hpp>
+
+#include "../../lib/shmemdf/Node.h"
+#include "../../lib/shmemdf/Registry.h"
+#include "../../lib/utility/IOFormat.h"
+
+namespace po = boost::program_options;
+
+volatile sig_atomic_t quit = 0;
+
+void printUsage(po::options_description options) {
+    std::cout << "Usage: top [INFO]\n"
+              << "   or: top [NAMES] [CONFIGURATION]\n"
+              << "Display live throughput and blocking statistics for the nodes\n"
+              << "specified by NAMES, or for every node in the node registry if\n"
+              << "none are specified.\n\n"
+              << options << "\n";
+}
+
+// Signal handler to exit cleanly on ctrl-c
+void sigHandler(int) {
+    quit = 1;
+}
+
+// Counters of a node at one point in time
+struct Snapshot {
+
+    struct Source {
+        pid_t pid;
+        uint64_t lag;
+        int64_t wait_ns;
+        std::array<uint64_t, oat::LatencyHistogram::NUM_BINS> latency;
+    };
+
+    int64_t time;
+    oat::NodeState state;
+    size_t ring_size;
+    uint64_t writes;
+    int64_t last_write_time;
+    int64_t sink_wait_ns;
+    std::array<uint64_t, oat::LatencyHistogram::NUM_BINS> lateness;
+    std::map<size_t, Source> sources;
+};
+
+// An open node segment
+struct Monitored {
+    oat::shmem_t segment;
+    oat::Node *node;
+    Snapshot last;
+};
+
+Snapshot snapshot(const oat::Node &node) {
+
+    Snapshot s;
+    s.time = oat::statsClock();
+    s.state = node.sink_state();
+    s.ring_size = node.ring_size();
+    s.writes = node.write_number();
+    s.last_write_time = node.stats.last_write_time();
+    s.sink_wait_ns = node.stats.sink_wait_ns();
+    for (size_t b = 0; b < s.lateness.size(); b++)
+        s.lateness[b] = node.stats.lateness.bins[b].load(oat::STATS_ORDER);
+
+    for (size_t i = 0; i < node.high_water(); i++) {
+
+        const oat::SourceSlot &slot = node.slot(i);
+        if (slot.state == oat::SourceSlot::FREE)
+            continue;
+
+        Snapshot::Source src;
+        src.pid = slot.pid;
+        const uint64_t c = slot.read_cursor;
+        src.lag = c == oat::SourceSlot::NOT_STARTED || c > s.writes ? 0 : s.writes - c;
+        src.wait_ns = slot.wait_ns.load(oat::STATS_ORDER);
+        for (size_t b = 0; b < src.latency.size(); b++)
+            src.latency[b] = slot.read_latency.bins[b].load(oat::STATS_ORDER);
+
+        s.sources[i] = src;
+    }
+
+    return s;
+}
+
+// Upper edge, in microseconds, of the histogram bin holding the given
+// quantile of the latencies recorded between two snapshots
+uint64_t quantile(const std::array<uint64_t, oat::LatencyHistogram::NUM_BINS> &now,
+                  const std::array<uint64_t, oat::LatencyHistogram::NUM_BINS> &then,
+                  const double q) {
+
+    // A slot's histogram is reset when a new SOURCE acquires it
+    for (size_t b = 0; b < now.size(); b++)
+        if (now[b] < then[b])
+            return quantile(now, {}, q);
+
+    uint64_t total = 0;
+    for (size_t b = 0; b < now.size(); b++)
+        total += now[b] - then[b];
+
+    if (total == 0)
+        return 0;
+
+    uint64_t count = 0;
+    for (size_t b = 0; b < now.size(); b++) {
+        count += now[b] - then[b];
+        if (count >= q * total)
+            return oat::LatencyHistogram::upperEdge(b);
+    }
+
+    return oat::LatencyHistogram::upperEdge(now.size() - 1);
+}
+
+std::string stateText(const oat::NodeState state) {
+
+    switch (state) {
+        case oat::NodeState::SINK_BOUND: return "BOUND";
+        case oat::NodeState::END: return "END";
+        case oat::NodeState::ERROR: return "ERROR";
+        default: return "WAIT";
+    }
+}
+
+std::string latencyText(const uint64_t us) {
+
+    if (us == 0)
+        return "-";
+    if (us < 1000)
+        return "<" + std::to_string(us) + "us";
+    return "<" + std::to_string(us / 1000) + "ms";
+}
+
+// Names of the nodes in shared memory, from the node registry. Nodes using
+// the in-process transport of oat-pipeline are not registered.
+std::vector<std::string> discoverNodes(void) {
+
+    oat::shmem_t segment;
+    oat::Registry *registry = oat::openRegistry(segment);
+    auto addresses = registry->addresses();
+
+    return std::vector<std::string>(addresses.begin(), addresses.end());
+}
+
+void print(const std::string &name, const Snapshot &now, const Snapshot &then) {
+
+    const double dt = (now.time - then.time) / 1e9;
+    const double rate = dt > 0 ? (now.writes - then.writes) / dt : 0;
+    const double sink_blocked = dt > 0 ? std::min(100.0, (now.sink_wait_ns - then.sink_wait_ns) / (1e7 * dt)) : 0;
+    const double idle = now.last_write_time > 0 ? (now.time - now.last_write_time) / 1e6 : -1;
+
+    std::printf("%-16s %-6s %7zu %4zu %12llu %10.1f %10.1f %12s %9s\n",
+                name.c_str(),
+                stateText(now.state).c_str(),
+                now.sources.size(),
+                now.ring_size,
+                static_cast<unsigned long long>(now.writes),
+                rate,
+                sink_blocked,
+                idle < 0 ? "-" : (std::to_string(static_cast<long long>(idle)) + "ms").c_str(),
+                latencyText(quantile(now.lateness, then.lateness, 0.99)).c_str());
+
+    // The SOURCE whose reads take longest holds up the SINK when the SINK
+    // spends time blocked
+    size_t slowest = now.sources.size() ? now.sources.begin()->first : 0;
+    uint64_t slowest_p99 = 0;
+
+    for (auto &kv : now.sources) {
+
+        auto t = then.sources.find(kv.first);
+        Snapshot::Source prev = t != then.sources.end() && t->second.pid == kv.second.pid
+                                ? t->second : Snapshot::Source {0, 0, 0, {}};
+
+        const uint64_t p99 = quantile(kv.second.latency, prev.latency, 0.99);
+        if (p99 > slowest_p99) {
+            slowest_p99 = p99;
+            slowest = kv.first;
+        }
+    }
+
+    for (auto &kv : now.sources) {
+
+        auto t = then.sources.find(kv.first);
+        Snapshot::Source prev = t != then.sources.end() && t->second.pid == kv.second.pid
+                                ? t->second : Snapshot::Source {0, 0, 0, {}};
+
+        const double blocked = dt > 0 ? std::min(100.0, (kv.second.wait_ns - prev.wait_ns) / (1e7 * dt)) : 0;
+        const bool bottleneck = sink_blocked > 50.0 && kv.first == slowest;
+
+        std::printf("  source %-4zu pid %-8d lag %-4llu read p50 %-8s p99 %-8s blocked %5.1f %%%s\n",
+                    kv.first,
+                    static_cast<int>(kv.second.pid),
+                    static_cast<unsigned long long>(kv.second.lag),
+                    latencyText(quantile(kv.second.latency, prev.latency, 0.5)).c_str(),
+                    latencyText(quantile(kv.second.latency, prev.latency, 0.99)).c_str(),
+                    blocked,
+                    bottleneck ? "  <-- bottleneck" : "");
+    }
+}
+
+int main(int argc, char *argv[]) {
+
+    std::signal(SIGINT, sigHandler);
+
+    std::vector<std::string> names;
+    double period = 1.0;
+    size_t count = 0;
+
+    try {
+
+        po::options_description options("INFO");
+        options.add_options()
+                ("help", "Produce help message.")
+                ("version,v", "Print version information.")
+                ;
+
+        po::options_description config("CONFIGURATION");
+        config.add_options()
+                ("period,p", po::value<double>(&period),
+                "Seconds between updates. Defaults to 1.")
+                ("count,n", po::value<size_t>(&count),
+                "Number of updates to display before exiting. Defaults to 0, "
+                "which runs until interrupted.")
+                ;
+
+        po::options_description hidden("HIDDEN OPTIONS");
+        hidden.add_options()
+                ("names", po::value< std::vector<std::string> >(),
+                "The names of the nodes to monitor.")
+                ;
+
+        po::positional_options_description positional_options;
+        positional_options.add("names", -1);
+
+        po::options_description all_options("ALL");
+        all_options.add(options).add(config).add(hidden);
+
+        po::options_description visible_options("OPTIONS");
+        visible_options.add(options).add(config);
+
+        po::variables_map variable_map;
+        po::store(po::command_line_parser(argc, argv)
+                .options(all_options)
+                .positional(positional_options)
+                .run(),
+                variable_map);
+        po::notify(variable_map);
+
+        // Use the parsed options
+        if (variable_map.count("help")) {
+            printUsage(visible_options);
+            return 0;
+        }
+
+        if (variable_map.count("version")) {
+            std::cout << "Oat Top version "
+                      << Oat_VERSION_MAJOR
+                      << "."
+                      << Oat_VERSION_MINOR
+                      << "\n";
+            std::cout << "Written by Jonathan P. Newman in the MWL@MIT.\n";
+            std::cout << "Licensed under the GPL3.0.\n";
+            return 0;
+        }
+
+        if (period <= 0) {
+            printUsage(visible_options);
+            std::cerr << oat::Error("Period must be positive.\n");
+            return -1;
+        }
+
+        if (variable_map.count("names"))
+            names = variable_map["names"].as< std::vector<std::string> >();
+
+    } catch (std::exception& e) {
+        std::cerr << oat::Error(e.what()) << "\n";
+        return -1;
+    } catch (...) {
+        std::cerr << oat::Error("Exception of unknown type.\n");
+        return -1;
+    }
+
+    std::map<std::string, Monitored> nodes;
+    const bool discover = names.empty();
+
+    for (size_t n = 0; !quit && (count == 0 || n < count); n++) {
+
+        if (discover)
+            names = discoverNodes();
+
+        // Open nodes that have appeared and forget those that have gone
+        std::map<std::string, Monitored> open;
+        for (auto &name : names) {
+
+            auto it = nodes.find(name);
+            if (it != nodes.end()) {
+                open[name] = it->second;
+                continue;
+            }
+
+            try {
+                Monitored m;
+                m.segment = oat::shmem_t(oat::bip::open_only, (name + "_node").c_str());
+                m.node = m.segment.find<oat::Node>(typeid(oat::Node).name()).first;
+                if (m.node == nullptr)
+                    continue;
+                m.last = snapshot(*m.node);
+                open[name] = m;
+            } catch (const boost::interprocess::interprocess_exception &) {
+                // Node is not (or no longer) in shared memory
+            }
+        }
+        nodes.swap(open);
+
+        std::this_thread::sleep_for(std::chrono::duration<double>(period));
+        if (quit)
+            break;
+
+        // Clear screen and home the cursor
+        std::printf("\033[2J\033[H");
+        std::printf("%-16s %-6s %7s %4s %12s %10s %10s %12s %9s\n",
+                    "NODE", "STATE", "SOURCES", "RING", "WRITES", "WRITES/S",
+                    "SINK BLK %", "LAST WRITE", "LATE p99");
+
+        for (auto &kv : nodes) {
+            Snapshot now = snapshot(*kv.second.node);
+            print(kv.first, now, kv.second.last);
+            kv.second.last = now;
+        }
+
+        std::fflush(stdout);
+    }
+
+    return 0;
+}
@@ -0,0 +1,336 @@
+//******************************************************************************
+//* File:   Bridge_test.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../lib/shmemdf/Node.h"
+#include "../../lib/shmemdf/Sink.h"
+#include "../../lib/shmemdf/Source.h"
+#include "../../src/bridge/BridgeReceiver.h"
+#include "../../src/bridge/BridgeSender.h"
+
+const std::string in_addr = "bridge_test_in";
+const std::string out_addr = "bridge_test_out";
+
+// Block until a SOURCE has a slot in the node at address, so that a SINK
+// does not publish before the bridge is reading
+void waitForSource(const std::string &address) {
+
+    oat::shmem_t segment;
+    oat::Node *node = nullptr;
+    while (node == nullptr || node->high_water() == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        try {
+            segment = oat::shmem_t(oat::bip::open_only, (address + "_node").c_str());
+            node = segment.find<oat::Node>(typeid(oat::Node).name()).first;
+        } catch (const oat::bip::interprocess_exception &) {
+            node = nullptr;
+        }
+    }
+}
+
+// Publish n frames whose pixels all equal the frame index. The stream is
+// not ended until done is set, so that the last frame is read downstream
+// before the end of the stream reaches it.
+void publishFrames(const size_t n, const int rows, const int cols,
+                   std::atomic<bool> &published, std::atomic<bool> &done) {
+
+    oat::Sink<oat::SharedFrameHeader> sink;
+    sink.bind(in_addr, rows * cols * 3);
+    oat::Frame frame = sink.retrieve(rows, cols, CV_8UC3);
+    waitForSource(in_addr);
+
+    for (size_t i = 0; i < n; i++) {
+        sink.wait();
+        frame = sink.retrieve();
+        std::memset(frame.data, static_cast<int>(i), frame.total() * frame.elemSize());
+        frame.sample().incrementCount();
+        sink.post();
+    }
+
+    published = true;
+    while (!done)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+// Run a bridge half until the end of its stream
+void runBridge(oat::Bridge *bridge) {
+    bridge->connectToNode();
+    while (!bridge->process()) { }
+}
+
+// Run the receiving half, then destroy it so that its SINK ends the stream
+// downstream
+void runReceiver(std::unique_ptr<oat::BridgeReceiver> &receiver, uint64_t &missed) {
+    runBridge(receiver.get());
+    missed = receiver->missed();
+    receiver.reset();
+}
+
+SCENARIO ("Frames sent over a TCP bridge shall be published by the receiving "
+          "half in order", "[Bridge]") {
+
+    GIVEN ("A receiver listening on loopback and a sender connected to it") {
+
+        const size_t n = 20;
+
+        oat::Source<oat::SharedFrameHeader> out;
+        out.touch(out_addr);
+
+        uint64_t missed = 0;
+        std::unique_ptr<oat::BridgeReceiver> receiver(
+            new oat::BridgeReceiver("tcp://127.0.0.1:0", out_addr));
+        oat::BridgeSender<oat::SharedFrameHeader> sender(
+            in_addr, "tcp://127.0.0.1:" + std::to_string(receiver->port()));
+
+        std::thread r(runReceiver, std::ref(receiver), std::ref(missed));
+        std::thread s(runBridge, &sender);
+        std::atomic<bool> published {false}, done {false};
+        std::thread p(publishFrames, n, 48, 64, std::ref(published), std::ref(done));
+
+        WHEN ("The sending node publishes frames") {
+
+            out.connect();
+            auto param = out.parameters();
+
+            THEN ("Every frame arrives intact with the sending node's "
+                  "geometry, followed by the end of the stream") {
+
+                REQUIRE (param.rows == 48);
+                REQUIRE (param.cols == 64);
+                REQUIRE (param.type == CV_8UC3);
+
+                for (size_t i = 0; i < n; i++) {
+                    REQUIRE (out.wait() == oat::NodeState::SINK_BOUND);
+                    auto lease = out.lease();
+                    const oat::Frame &f = lease.frame();
+                    const size_t bytes = f.total() * f.elemSize();
+                    REQUIRE (f.data[0] == i);
+                    REQUIRE (f.data[bytes - 1] == i);
+                    REQUIRE (f.sample().count() == i + 1);
+                }
+
+                done = true;
+                REQUIRE (out.wait() == oat::NodeState::END);
+                REQUIRE (missed == 0);
+                REQUIRE (sender.dropped() == 0);
+            }
+        }
+
+        p.join();
+        s.join();
+        r.join();
+    }
+}
+
+SCENARIO ("Positions sent over a UDP bridge shall be published by the "
+          "receiving half", "[Bridge]") {
+
+    GIVEN ("A receiver listening on loopback and a sender connected to it") {
+
+        const size_t n = 10;
+
+        oat::Source<oat::Position2D> out;
+        out.touch(out_addr);
+
+        uint64_t missed = 0;
+        std::unique_ptr<oat::BridgeReceiver> receiver(
+            new oat::BridgeReceiver("udp://127.0.0.1:0", out_addr));
+        oat::BridgeSender<oat::Position2D> sender(
+            in_addr, "udp://127.0.0.1:" + std::to_string(receiver->port()));
+
+        std::thread r(runReceiver, std::ref(receiver), std::ref(missed));
+        std::thread s(runBridge, &sender);
+
+        std::atomic<bool> done {false};
+        std::thread p([n, &done] {
+            oat::Sink<oat::Position2D> sink;
+            sink.bind(in_addr, in_addr);
+            waitForSource(in_addr);
+            for (size_t i = 0; i < n; i++) {
+                sink.wait();
+                oat::Position2D *pos = sink.retrieve();
+                pos->position = oat::Point2D(i, 2.0 * i);
+                pos->position_valid = true;
+                std::strcpy(pos->region, "north");
+                pos->region_valid = true;
+                pos->sample().incrementCount();
+                sink.post();
+            }
+            while (!done)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        });
+
+        WHEN ("The sending node publishes positions") {
+
+            out.connect();
+
+            THEN ("Every position arrives with its fields intact") {
+
+                for (size_t i = 0; i < n; i++) {
+                    REQUIRE (out.wait() == oat::NodeState::SINK_BOUND);
+                    oat::Position2D pos = out.clone();
+                    out.post();
+                    REQUIRE (pos.position_valid);
+                    REQUIRE (pos.position.x == Approx(i));
+                    REQUIRE (pos.position.y == Approx(2.0 * i));
+                    REQUIRE (pos.region_valid);
+                    REQUIRE (std::string(pos.region) == "north");
+                }
+
+                done = true;
+                REQUIRE (out.wait() == oat::NodeState::END);
+            }
+        }
+
+        p.join();
+        s.join();
+        r.join();
+    }
+}
+
+SCENARIO ("A queued sender shall drop its oldest frames rather than hold up "
+          "its node", "[Bridge]") {
+
+    GIVEN ("A sender with a queue depth of 1 and a receiver whose node is not "
+           "being read") {
+
+        const size_t n = 30;
+        const int rows = 1000, cols = 1000;
+
+        oat::Source<oat::SharedFrameHeader> out;
+        out.touch(out_addr);
+
+        uint64_t missed = 0;
+        std::unique_ptr<oat::BridgeReceiver> receiver(
+            new oat::BridgeReceiver("tcp://127.0.0.1:0", out_addr));
+        oat::BridgeSender<oat::SharedFrameHeader> sender(
+            in_addr, "tcp://127.0.0.1:" + std::to_string(receiver->port()));
+        sender.set_queue_depth(1);
+
+        std::thread r(runReceiver, std::ref(receiver), std::ref(missed));
+        std::thread s(runBridge, &sender);
+
+        WHEN ("The sending node publishes frames faster than they are read") {
+
+            // Publishing only finishes if the sending node never waits on
+            // the network
+            std::atomic<bool> published {false}, done {false};
+            std::thread p(publishFrames, n, rows, cols, std::ref(published), std::ref(done));
+            for (int t = 0; t < 10000 && !published; t++)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            REQUIRE (published);
+
+            out.connect();
+
+            THEN ("Some frames are dropped but the newest arrives last") {
+
+                size_t received = 0;
+                int first = -1, last = -1;
+                while (last != static_cast<int>(n - 1)) {
+                    REQUIRE (out.wait() == oat::NodeState::SINK_BOUND);
+                    auto lease = out.lease();
+                    const int value = lease.frame().data[0];
+                    REQUIRE (value > last);
+                    if (first < 0)
+                        first = value;
+                    last = value;
+                    received++;
+                }
+
+                done = true;
+                REQUIRE (out.wait() == oat::NodeState::END);
+                REQUIRE (received < n);
+                REQUIRE (sender.dropped() > 0);
+
+                // Gaps in the sample count are reported by the receiver
+                REQUIRE (missed == static_cast<uint64_t>(last - first + 1) - received);
+            }
+
+            p.join();
+        }
+
+        s.join();
+        r.join();
+    }
+}
+
+SCENARIO ("A receiver shall reject frame headers that are malformed or too "
+          "large to receive", "[Bridge]") {
+
+    GIVEN ("A valid frame header") {
+
+        oat::bridge::MessageHeader h;
+        h.kind = oat::bridge::FRAME;
+        h.rows = 480;
+        h.cols = 640;
+        h.type = CV_8UC3;
+        h.payload_bytes = h.frame_bytes();
+
+        REQUIRE_NOTHROW (h.check());
+
+        WHEN ("Its dimensions are not positive") {
+            h.rows = 0;
+            THEN ("It is rejected") {
+                REQUIRE_THROWS (h.check());
+            }
+        }
+
+        WHEN ("Its type has an invalid depth or channel count") {
+            h.type = CV_MAKETYPE(CV_8U, 5);
+            THEN ("It is rejected") {
+                REQUIRE_THROWS (h.check());
+            }
+        }
+
+        WHEN ("Its frame is too large to allocate") {
+            h.rows = 1 << 30;
+            h.cols = 1 << 30;
+            THEN ("It is rejected") {
+                REQUIRE_THROWS (h.check());
+            }
+        }
+
+        WHEN ("Its compressed payload is much larger than the frame") {
+            h.encoding = oat::bridge::JPEG;
+            h.payload_bytes = 2 * h.frame_bytes();
+            THEN ("It is rejected") {
+                REQUIRE_THROWS (h.check());
+            }
+        }
+
+        WHEN ("Its address fills the array without a terminator") {
+            std::memset(h.address, 'a', sizeof(h.address));
+            THEN ("The address is read within the array") {
+                REQUIRE (h.address_string()
+                         == std::string(oat::bridge::MessageHeader::MAX_ADDRESS_LENGTH, 'a'));
+            }
+        }
+    }
+}
@@ -0,0 +1,216 @@
+//******************************************************************************
+//* File:   shmemdf_latency.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+// Measures cross-process wake-up latency of the semaphores used to
+// synchronize SINKs and SOURCEs. Two processes ping-pong over a pair of
+// semaphores in shared memory and the round trip time is recorded.
+//
+//   - boost: bip::interprocess_semaphore waited on with the 10 ms
+//            timed_wait() polling loop formerly used by SinkBase/SourceBase
+//   - oat:   oat::Semaphore waited on with LIVENESS_PERIOD timed_wait()
+//   - node:  a full Sink<int>/Source<int> write/read cycle
+//
+// Usage: shmemdf_latency [iterations]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <boost/interprocess/sync/interprocess_semaphore.hpp>
+#include <boost/thread/thread_time.hpp>
+
+#include "../../lib/shmemdf/Semaphore.h"
+#include "../../lib/shmemdf/Sink.h"
+#include "../../lib/shmemdf/Source.h"
+
+namespace bip = boost::interprocess;
+using Clock = std::chrono::steady_clock;
+
+struct BoostPair {
+    bip::interprocess_semaphore ping {0}, pong {0};
+    static void wait(bip::interprocess_semaphore &s) {
+        boost::system_time timeout = boost::get_system_time()
+                                     + boost::posix_time::milliseconds(10);
+        while (!s.timed_wait(timeout))
+            timeout = boost::get_system_time()
+                      + boost::posix_time::milliseconds(10);
+    }
+    static void post(bip::interprocess_semaphore &s) { s.post(); }
+};
+
+struct OatPair {
+    oat::Semaphore ping {0}, pong {0};
+    static void wait(oat::Semaphore &s) {
+        while (!s.timed_wait(oat::LIVENESS_PERIOD)) { }
+    }
+    static void post(oat::Semaphore &s) { s.post(); }
+};
+
+void report(const std::string &name, std::vector<double> &rtt_us) {
+
+    std::sort(rtt_us.begin(), rtt_us.end());
+    auto pct = [&rtt_us](double p) {
+        return rtt_us[static_cast<size_t>(p * (rtt_us.size() - 1))];
+    };
+
+    std::cout << name << ": round trip (us) "
+              << "median " << pct(0.5)
+              << ", p99 " << pct(0.99)
+              << ", max " << rtt_us.back() << std::endl;
+}
+
+template <typename Pair>
+std::vector<double> pingPong(const int iterations) {
+
+    void *mem = mmap(nullptr, sizeof(Pair), PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED)
+        throw std::runtime_error("mmap failed.");
+
+    auto pair = new (mem) Pair();
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        for (int i = 0; i < iterations; i++) {
+            Pair::wait(pair->ping);
+            Pair::post(pair->pong);
+        }
+        _exit(0);
+    }
+
+    std::vector<double> rtt_us;
+    rtt_us.reserve(iterations);
+
+    for (int i = 0; i < iterations; i++) {
+        auto t0 = Clock::now();
+        Pair::post(pair->ping);
+        Pair::wait(pair->pong);
+        rtt_us.push_back(std::chrono::duration<double, std::micro>
+                         (Clock::now() - t0).count());
+    }
+
+    waitpid(pid, nullptr, 0);
+    pair->~Pair();
+    munmap(mem, sizeof(Pair));
+
+    return rtt_us;
+}
+
+std::vector<double> nodeCycle(const int iterations) {
+
+    const std::string fwd = "shmemdf_latency_fwd";
+    const std::string bck = "shmemdf_latency_bck";
+
+    // SOURCEs only receive writes made after they touch a node, so the
+    // parent must not write until the child is attached
+    int ready[2];
+    if (pipe(ready) != 0)
+        throw std::runtime_error("pipe failed.");
+
+    oat::Sink<int> sink;
+    sink.bind(fwd);
+
+    pid_t pid = fork();
+    if (pid == 0) {
+
+        // Echo each sample back to the parent
+        oat::Sink<int> echo_sink;
+        oat::Source<int> echo_source;
+        echo_sink.bind(bck);
+        echo_source.touch(fwd);
+        echo_source.connect();
+
+        char c = 0;
+        if (write(ready[1], &c, 1) != 1)
+            _exit(1);
+
+        for (int i = 0; i < iterations; i++) {
+            echo_source.wait();
+            int val = echo_source.clone();
+            echo_source.post();
+
+            echo_sink.wait();
+            *echo_sink.retrieve() = val;
+            echo_sink.post();
+        }
+
+        // Skip destructors of objects inherited from the parent
+        _exit(0);
+    }
+
+    char c;
+    if (read(ready[0], &c, 1) != 1)
+        throw std::runtime_error("Echo process failed to start.");
+
+    oat::Source<int> source;
+    source.touch(bck);
+    source.connect();
+
+    std::vector<double> rtt_us;
+    rtt_us.reserve(iterations);
+
+    for (int i = 0; i < iterations; i++) {
+
+        auto t0 = Clock::now();
+
+        sink.wait();
+        *sink.retrieve() = i;
+        sink.post();
+
+        source.wait();
+        source.post();
+
+        rtt_us.push_back(std::chrono::duration<double, std::micro>
+                         (Clock::now() - t0).count());
+    }
+
+    waitpid(pid, nullptr, 0);
+    close(ready[0]);
+    close(ready[1]);
+
+    // The child exits without running destructors
+    for (auto &a : {fwd, bck}) {
+        bip::shared_memory_object::remove((a + "_node").c_str());
+        bip::shared_memory_object::remove((a + "_obj").c_str());
+    }
+
+    return rtt_us;
+}
+
+int main(int argc, char *argv[]) {
+
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 100000;
+
+    auto boost_rtt = pingPong<BoostPair>(iterations);
+    report("boost", boost_rtt);
+
+    auto oat_rtt = pingPong<OatPair>(iterations);
+    report("oat  ", oat_rtt);
+
+    auto node_rtt = nodeCycle(iterations);
+    report("node ", node_rtt);
+
+    return 0;
+}
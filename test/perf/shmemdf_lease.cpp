@@ -0,0 +1,259 @@
+//******************************************************************************
+//* File:   shmemdf_lease.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+// Measures the cost of moving frames through a frame processing stage that
+// reads from one node and publishes to another, as oat-framefilt does.
+//
+//   - copy:  copyTo() a private frame, post(), filter it, then copyTo() the
+//            SINK frame
+//   - lease: lease() the SOURCE frame and filter it straight into the SINK
+//            frame, as FrameFilter does for filters that read in place
+//   - lease, copy: lease() the SOURCE frame, copyTo() a private frame,
+//            release the lease, then filter it into the SINK frame, as
+//            FrameFilter does for all other filters
+//
+// Each stage is run with an identity filter, so that only data movement is
+// measured, and with a 9x9 Gaussian blur, so that the time the upstream
+// SINK spends blocked in wait() while the SOURCE frame is held shows up.
+//
+// A server thread publishes frames and a client thread consumes the stage's
+// output, so every frame passes through a full node on each side.
+//
+// The lease stage is then repeated with the nodes' segments backed by huge
+// and/or locked pages (see Pages.h). The first frame, which takes the page
+// faults when pages are not pre-faulted, is reported separately.
+//
+// Usage: shmemdf_lease [frames]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <opencv2/imgproc.hpp>
+
+#include "../../lib/datatypes/Frame.h"
+#include "../../lib/shmemdf/Sink.h"
+#include "../../lib/shmemdf/Source.h"
+
+using Clock = std::chrono::steady_clock;
+
+using Filter = void (*)(const cv::Mat &frame, cv::Mat &filtered);
+
+void identity(const cv::Mat &frame, cv::Mat &filtered) {
+    frame.copyTo(filtered);
+}
+
+void blur(const cv::Mat &frame, cv::Mat &filtered) {
+    cv::GaussianBlur(frame, filtered, cv::Size(9, 9), 0);
+}
+
+struct Result {
+    double us_per_frame;
+    double us_first_frame;
+    double us_sink_blocked;
+    size_t bytes_per_frame;
+    uint32_t page_policy;
+};
+
+template <typename Stage>
+Result runStage(const int frames, const size_t rows, const size_t cols,
+                Stage stage, Filter filter = identity,
+                const uint32_t policy = oat::PAGES_DEFAULT) {
+
+    const std::string raw = "shmemdf_lease_raw";
+    const std::string out = "shmemdf_lease_out";
+    const int type = 16; // CV_8UC3
+    const size_t bytes = rows * cols * 3;
+
+    // SOURCEs only receive writes made after they touch a node, so both
+    // touch before either SINK can write
+    oat::Source<oat::SharedFrameHeader> source, client_source;
+    oat::Sink<oat::SharedFrameHeader> sink;
+    source.touch(raw);
+    client_source.touch(out);
+
+    // Time the upstream SINK spends waiting for the stage to release its
+    // frame
+    Clock::duration sink_blocked {0};
+
+    std::thread server([&] {
+        oat::Sink<oat::SharedFrameHeader> s;
+        s.set_page_policy(policy);
+        s.bind(raw, bytes);
+        oat::Frame f = s.retrieve(rows, cols, type);
+        cv::randu(f, 0, 255);
+        for (int i = 0; i < frames; i++) {
+            auto t = Clock::now();
+            s.wait();
+            sink_blocked += Clock::now() - t;
+            f.data[0] = static_cast<unsigned char>(i);
+            s.post();
+        }
+    });
+
+    source.connect();
+    sink.set_page_policy(policy);
+    sink.bind(out, bytes);
+    oat::Frame shared_frame = sink.retrieve(rows, cols, type);
+
+    std::thread client([&] {
+        client_source.connect();
+        for (int i = 0; i < frames; i++) {
+            client_source.wait();
+            client_source.post();
+        }
+    });
+
+    oat::Frame internal_frame;
+    size_t copied = 0;
+
+    auto t0 = Clock::now();
+    copied += stage(source, sink, shared_frame, internal_frame, filter);
+    auto t1 = Clock::now();
+    for (int i = 1; i < frames; i++)
+        copied += stage(source, sink, shared_frame, internal_frame, filter);
+    auto t2 = Clock::now();
+
+    server.join();
+    client.join();
+
+    return {std::chrono::duration<double, std::micro>(t2 - t1).count() / (frames - 1),
+            std::chrono::duration<double, std::micro>(t1 - t0).count(),
+            std::chrono::duration<double, std::micro>(sink_blocked).count() / frames,
+            copied / frames,
+            sink.applied_page_policy()};
+}
+
+size_t copyStage(oat::Source<oat::SharedFrameHeader> &source,
+                 oat::Sink<oat::SharedFrameHeader> &sink,
+                 oat::Frame &shared_frame,
+                 oat::Frame &internal_frame,
+                 Filter filter) {
+
+    source.wait();
+    source.copyTo(internal_frame);
+    source.post();
+
+    filter(internal_frame, internal_frame);
+
+    sink.wait();
+    internal_frame.copyTo(shared_frame);
+    sink.post();
+
+    return 2 * shared_frame.total() * shared_frame.elemSize();
+}
+
+size_t leaseStage(oat::Source<oat::SharedFrameHeader> &source,
+                  oat::Sink<oat::SharedFrameHeader> &sink,
+                  oat::Frame &shared_frame,
+                  oat::Frame &,
+                  Filter filter) {
+
+    // The SINK slot is taken first, so the lease only covers the filter
+    sink.wait();
+
+    source.wait();
+    auto lease = source.lease();
+    cv::Mat filtered = shared_frame;
+    filter(lease.frame(), filtered);
+    lease.release();
+
+    sink.post();
+
+    return filter == identity ? shared_frame.total() * shared_frame.elemSize()
+                              : 0;
+}
+
+size_t leaseCopyStage(oat::Source<oat::SharedFrameHeader> &source,
+                      oat::Sink<oat::SharedFrameHeader> &sink,
+                      oat::Frame &shared_frame,
+                      oat::Frame &internal_frame,
+                      Filter filter) {
+
+    sink.wait();
+
+    // The lease only covers the copy
+    source.wait();
+    auto lease = source.lease();
+    static_cast<const cv::Mat &>(lease.frame()).copyTo(internal_frame);
+    lease.release();
+
+    cv::Mat filtered = shared_frame;
+    filter(internal_frame, filtered);
+
+    sink.post();
+
+    return (filter == identity ? 2 : 1)
+           * shared_frame.total() * shared_frame.elemSize();
+}
+
+int main(int argc, char *argv[]) {
+
+    int frames = argc > 1 ? std::atoi(argv[1]) : 2000;
+
+    const size_t sizes[][2] = {{480, 640}, {1080, 1920}};
+
+    const struct { const char *name; Filter filter; } filters[] =
+        {{"identity", identity}, {"blur", blur}};
+
+    for (auto &f : filters) {
+        for (auto &sz : sizes) {
+
+            auto copy = runStage(frames, sz[0], sz[1], copyStage, f.filter);
+            auto lease = runStage(frames, sz[0], sz[1], leaseStage, f.filter);
+            auto lease_copy = runStage(frames, sz[0], sz[1], leaseCopyStage,
+                                       f.filter);
+
+            std::cout << sz[1] << "x" << sz[0] << "x3 " << f.name << ": "
+                      << "copy " << copy.us_per_frame << " us/frame, "
+                      << copy.bytes_per_frame << " B/frame, "
+                      << copy.us_sink_blocked << " us SINK blocked; "
+                      << "lease " << lease.us_per_frame << " us/frame, "
+                      << lease.bytes_per_frame << " B/frame, "
+                      << lease.us_sink_blocked << " us SINK blocked; "
+                      << "lease, copy " << lease_copy.us_per_frame
+                      << " us/frame, " << lease_copy.bytes_per_frame
+                      << " B/frame, " << lease_copy.us_sink_blocked
+                      << " us SINK blocked" << std::endl;
+        }
+    }
+
+    const uint32_t policies[] = {oat::PAGES_DEFAULT,
+                                 oat::PAGES_LOCKED,
+                                 oat::PAGES_HUGE | oat::PAGES_LOCKED};
+
+    for (auto &sz : sizes) {
+        for (auto policy : policies) {
+
+            auto lease = runStage(frames, sz[0], sz[1], leaseStage,
+                                  identity, policy);
+
+            std::cout << sz[1] << "x" << sz[0] << "x3 lease, pages "
+                      << (policy & oat::PAGES_HUGE ? "huge " : "")
+                      << (policy & oat::PAGES_LOCKED ? "locked " : "")
+                      << "(applied " << lease.page_policy << "): "
+                      << "first frame " << lease.us_first_frame << " us, "
+                      << lease.us_per_frame << " us/frame" << std::endl;
+        }
+    }
+
+    return 0;
+}
@@ -22,40 +22,56 @@
 
 #include "../../lib/shmemdf/Node.h"
 
-SCENARIO ("Nodes can accept up to Node::NUM_SLOTS sources.", "[Node]") {
+const std::string node_addr = "node_test";
 
-    GIVEN ("A fresh Node") {
+SCENARIO ("Nodes can accept as many sources as the slots they are created "
+          "with.", "[Node]") {
 
-        oat::Node node;
+    GIVEN ("A fresh Node with 16 slots") {
+
+        oat::shmem_t segment;
+        oat::Node *node_ptr = oat::openNode(segment, node_addr, 16);
+        oat::Node &node = *node_ptr;
+
+        REQUIRE (node.num_slots() == 16);
         REQUIRE (node.source_ref_count() == 0);
         REQUIRE (node.sink_state() == oat::NodeState::UNDEFINED);
 
-        WHEN ("Node::NUM_SLOTS+1 sources are added") {
+        WHEN ("17 sources are added") {
 
-            THEN ("The Node shall return normal exit codes until the 11th") {
-                for (size_t i = 0; i <= oat::Node::NUM_SLOTS; i++) {
-                    if (i < oat::Node::NUM_SLOTS)
-                        REQUIRE (node.acquireSlot(i) == 0);
+            THEN ("The Node shall return normal exit codes until the 17th") {
+                for (size_t i = 0; i <= 16; i++) {
+                    size_t idx;
+                    if (i < 16)
+                        REQUIRE (node.acquireSlot(idx) == 0);
                     else
-                        REQUIRE (node.acquireSlot(i) < 0);
+                        REQUIRE (node.acquireSlot(idx) < 0);
                 }
             }
         }
 
         WHEN ("a source is removed") {
 
-            node.releaseSlot(0);
+            size_t idx;
+            node.acquireSlot(idx);
+            node.releaseSlot(idx);
 
-            THEN ("the source ref count remains 0") {
+            THEN ("the source ref count returns to 0") {
                 REQUIRE(node.source_ref_count() == 0);
             }
+
+            THEN ("the slot can be acquired again") {
+                size_t idx2;
+                REQUIRE(node.acquireSlot(idx2) == 0);
+                REQUIRE(idx2 == idx);
+            }
         }
 
         WHEN ("a negatively indexed read-barrier is read") {
 
             THEN ("The Node shall throw") {
                 REQUIRE_THROWS(
-                    boost::interprocess::interprocess_semaphore &s = node.read_barrier(-1);
+                    oat::Node::semaphore &s = node.read_barrier(-1);
                 );
             }
         }
@@ -67,9 +83,25 @@ SCENARIO ("Nodes can accept up to Node::NUM_SLOTS sources.", "[Node]") {
 
             THEN ("reading a greater indexed read-barrier shall throw") {
                 REQUIRE_THROWS(
-                boost::interprocess::interprocess_semaphore &s = node.read_barrier(idx+1);
+                oat::Node::semaphore &s = node.read_barrier(idx+1);
                 );
             }
         }
+
+        WHEN ("The node is opened again with a different number of slots") {
+
+            oat::shmem_t other_segment;
+            oat::Node *other = oat::openNode(other_segment, node_addr, 32);
+
+            THEN ("The existing node and its slots shall be shared") {
+                REQUIRE(other->num_slots() == 16);
+
+                size_t idx;
+                node.acquireSlot(idx);
+                REQUIRE(other->source_ref_count() == 1);
+            }
+        }
+
+        oat::bip::shared_memory_object::remove(node_addr.c_str());
     }
 }
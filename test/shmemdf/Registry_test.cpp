@@ -0,0 +1,118 @@
+//******************************************************************************
+//* File:   Registry_test.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../../lib/shmemdf/Registry.h"
+#include "../../lib/shmemdf/Sink.h"
+#include "../../lib/shmemdf/Source.h"
+
+const std::string node_addr = "registry_test";
+
+// Number of live registry entries for an address with the given role
+size_t countEntries(const std::string &address, oat::RegistryEntry::Role role) {
+
+    oat::shmem_t segment;
+    oat::Registry *registry = oat::openRegistry(segment);
+
+    size_t n = 0;
+    for (size_t i = 0; i < oat::Registry::MAX_ENTRIES; i++) {
+        const oat::RegistryEntry &e = registry->entry(i);
+        if (e.state == oat::RegistryEntry::ACTIVE
+            && e.role == role
+            && address == e.address)
+            n++;
+    }
+
+    return n;
+}
+
+SCENARIO ("Sinks and sources shall record themselves in the registry while "
+          "they use a node", "[Registry]") {
+
+    GIVEN ("A sink and a source") {
+
+        auto sink = new oat::Sink<int>();
+        auto source = new oat::Source<int>();
+
+        WHEN ("The sink binds and the source touches the node") {
+
+            sink->bind(node_addr);
+            source->touch(node_addr);
+
+            THEN ("Each shall have a registry entry for the node") {
+
+                REQUIRE(countEntries(node_addr, oat::RegistryEntry::SINK) == 1);
+                REQUIRE(countEntries(node_addr, oat::RegistryEntry::SOURCE) == 1);
+
+                oat::shmem_t segment;
+                REQUIRE(oat::openRegistry(segment)->addresses().count(node_addr) == 1);
+            }
+
+            THEN ("Their entries shall be removed when they are destroyed") {
+
+                delete source;
+                source = nullptr;
+                REQUIRE(countEntries(node_addr, oat::RegistryEntry::SOURCE) == 0);
+
+                delete sink;
+                sink = nullptr;
+                REQUIRE(countEntries(node_addr, oat::RegistryEntry::SINK) == 0);
+            }
+        }
+
+        delete source;
+        delete sink;
+    }
+}
+
+SCENARIO ("A node left behind by a process that died shall be reclaimed",
+          "[Registry]") {
+
+    GIVEN ("A node whose sink's process died without cleaning up") {
+
+        pid_t pid = fork();
+        if (pid == 0) {
+            oat::Sink<int> sink;
+            sink.bind(node_addr);
+            _exit(0);
+        }
+
+        int status;
+        REQUIRE(waitpid(pid, &status, 0) == pid);
+        REQUIRE(access(("/dev/shm/" + node_addr + "_node").c_str(), F_OK) == 0);
+
+        WHEN ("A new sink binds to the same address") {
+
+            oat::Sink<int> sink;
+
+            THEN ("The stale node shall be replaced instead of refusing the "
+                  "sink") {
+
+                REQUIRE_NOTHROW(sink.bind(node_addr));
+                REQUIRE(countEntries(node_addr, oat::RegistryEntry::SINK) == 1);
+            }
+        }
+    }
+}
@@ -99,6 +99,19 @@ SCENARIO ("Sinks must bind() before waiting or posting.", "[Sink]") {
                 REQUIRE_NOTHROW( sink.post(); );
             }
         }
+
+        WHEN ("When the sink calls cancel() after calling wait()") {
+
+            sink.bind(node_addr);
+            sink.wait();
+            sink.cancel();
+
+            THEN ("The sink shall require wait() before posting again") {
+                REQUIRE_THROWS( sink.post(); );
+                REQUIRE_NOTHROW( sink.wait(); );
+                REQUIRE_NOTHROW( sink.post(); );
+            }
+        }
     }
 }
 
@@ -180,3 +193,115 @@ SCENARIO ("Sink<SharedFrameHeader> must bind() before waiting, posting, or alloc
         }
     }
 }
+
+SCENARIO ("Sink ring size must be set before bind().", "[Sink]") {
+
+    GIVEN ("A single Sink<int>") {
+
+        oat::Sink<int> sink;
+
+        WHEN ("The ring size is out of range") {
+            THEN ("The sink shall throw") {
+                REQUIRE_THROWS( sink.set_ring_size(0); );
+                REQUIRE_THROWS( sink.set_ring_size(oat::Node::MAX_RING_SIZE + 1); );
+            }
+        }
+
+        WHEN ("The ring size is set after binding a segment") {
+
+            sink.bind(node_addr);
+
+            THEN ("The sink shall throw") {
+                REQUIRE_THROWS( sink.set_ring_size(2); );
+            }
+        }
+    }
+}
+
+SCENARIO ("Sink page policy must be set before bind() and falls back when "
+          "unavailable.", "[Sink]") {
+
+    GIVEN ("A single Sink<SharedFrameHeader>") {
+
+        oat::Sink<oat::SharedFrameHeader> sink;
+
+        WHEN ("The page policy has unknown flags") {
+            THEN ("The sink shall throw") {
+                REQUIRE_THROWS( sink.set_page_policy(1u << 7); );
+            }
+        }
+
+        WHEN ("The page policy is set after binding a segment") {
+
+            sink.bind(node_addr, 100);
+
+            THEN ("The sink shall throw") {
+                REQUIRE_THROWS( sink.set_page_policy(oat::PAGES_LOCKED); );
+            }
+        }
+
+        WHEN ("The sink binds with huge and locked pages") {
+
+            const uint32_t policy = oat::PAGES_HUGE | oat::PAGES_LOCKED;
+            sink.set_page_policy(policy);
+            sink.bind(node_addr, 100 * 100);
+
+            THEN ("Only requested flags shall take effect and the frame "
+                  "shall be usable") {
+                REQUIRE( (sink.applied_page_policy() & ~policy) == 0 );
+                REQUIRE( sink.page_policy() == policy );
+
+                oat::Frame frame;
+                REQUIRE_NOTHROW( frame = sink.retrieve(100, 100, 0); );
+                frame.data[100 * 100 - 1] = 42;
+                REQUIRE( frame.data[100 * 100 - 1] == 42 );
+            }
+        }
+    }
+}
+
+SCENARIO ("Sink<SharedFrameHeader> can only publish a region within its "
+          "frames.", "[Sink, SharedFrameHeader]") {
+
+    GIVEN ("A bound Sink<SharedFrameHeader>") {
+
+        const size_t rows {10}, cols {20};
+        const int type {CV_8UC3};
+
+        oat::Sink<oat::SharedFrameHeader> sink;
+        sink.bind(node_addr, rows * cols * 3);
+
+        WHEN ("The region extends past the frame") {
+            THEN ("The sink shall throw") {
+                REQUIRE_THROWS( sink.retrieve(rows, cols, type,
+                                              oat::PixelFormat::BGR,
+                                              cv::Rect(15, 2, 6, 4)); );
+                REQUIRE_THROWS( sink.retrieve(rows, cols, type,
+                                              oat::PixelFormat::BGR,
+                                              cv::Rect(-1, 0, 4, 4)); );
+            }
+        }
+
+        WHEN ("The region is empty") {
+            THEN ("The sink shall throw") {
+                REQUIRE_THROWS( sink.retrieve(rows, cols, type,
+                                              oat::PixelFormat::BGR,
+                                              cv::Rect(2, 3, 0, 4)); );
+            }
+        }
+
+        WHEN ("The region lies within the frame") {
+
+            oat::Frame frame;
+            REQUIRE_NOTHROW( frame = sink.retrieve(rows, cols, type,
+                                                   oat::PixelFormat::BGR,
+                                                   cv::Rect(2, 3, 8, 4)); );
+
+            THEN ("The sink shall be given the full frame to write") {
+                REQUIRE( frame.rows == static_cast<int>(rows) );
+                REQUIRE( frame.cols == static_cast<int>(cols) );
+                REQUIRE( frame.isContinuous() );
+            }
+        }
+    }
+}
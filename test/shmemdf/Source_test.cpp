@@ -20,7 +20,9 @@
 #define CATCH_CONFIG_MAIN
 #include <catch.hpp>
 
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "../../lib/shmemdf/Source.h"
 #include "../../lib/shmemdf/Sink.h"
@@ -28,17 +30,18 @@
 
 const std::string node_addr = "test";
 
-SCENARIO ("Up to 10 sources can connect a single Node.", "[Source]") {
+SCENARIO ("A node accepts as many sources as its sink allows.", "[Source]") {
 
-    GIVEN ("11 sources and a bound sink with common node address") {
+    GIVEN ("A sink allowing 10 sources and 11 sources with common node address") {
 
         oat::Sink<int> sink;
 
         INFO ("The sink binds a node");
+        sink.set_max_sources(10);
         sink.bind(node_addr);
         oat::Source<int> s0, s1, s2, s3, s4, s5, s6, s7, s8, s9, s10;
 
-        WHEN ("sources 0 to Oat::Node:NUM_SLOTS connect a node") {
+        WHEN ("sources 0 to 9 connect a node") {
 
             THEN ("The first 10 connections will succeed") {
                 REQUIRE_NOTHROW(
@@ -66,7 +69,7 @@ SCENARIO ("Up to 10 sources can connect a single Node.", "[Source]") {
                 );
             }
 
-            AND_THEN ("The oat::Node:NUM_SLOTS+1 connection shall throw") {
+            AND_THEN ("The 11th connection shall throw") {
                 REQUIRE_THROWS(
                     s0.touch(node_addr);
                     s1.touch(node_addr);
@@ -95,6 +98,47 @@ SCENARIO ("Up to 10 sources can connect a single Node.", "[Source]") {
             }
         }
     }
+
+    GIVEN ("A sink with the default number of source slots") {
+
+        oat::Sink<int> sink;
+        sink.bind(node_addr);
+
+        WHEN ("Node::DEFAULT_NUM_SLOTS sources connect") {
+
+            std::vector<std::unique_ptr<oat::Source<int>>> sources;
+
+            THEN ("All connections will succeed") {
+                REQUIRE_NOTHROW(
+                    for (size_t i = 0; i < oat::Node::DEFAULT_NUM_SLOTS; i++) {
+                        sources.emplace_back(new oat::Source<int>());
+                        sources.back()->touch(node_addr);
+                        sources.back()->connect();
+                    }
+                );
+            }
+        }
+    }
+}
+
+SCENARIO ("The number of source slots is fixed when a node is created.",
+          "[Source]") {
+
+    GIVEN ("A source that touches a node before its sink binds") {
+
+        oat::Source<int> source;
+        source.touch(node_addr);
+
+        WHEN ("The sink asks for more than the default number of slots") {
+
+            oat::Sink<int> sink;
+            sink.set_max_sources(oat::Node::DEFAULT_NUM_SLOTS + 1);
+
+            THEN ("The sink shall throw on bind()") {
+                REQUIRE_THROWS( sink.bind(node_addr); );
+            }
+        }
+    }
 }
 
 SCENARIO ("Sources must connect() before waiting or posting.", "[Source]") {
@@ -211,5 +255,163 @@ SCENARIO ("Connected sources can retrieve shared objects to mutate them.", "[Sou
     }
 }
 
+SCENARIO ("Sources in LATEST mode do not occupy node slots.", "[Source]") {
+
+    GIVEN ("A sink allowing 10 sources, 10 connected sources, and a LATEST source") {
+
+        oat::Sink<int> sink;
+        sink.set_max_sources(10);
+        sink.bind(node_addr);
+
+        std::vector<std::unique_ptr<oat::Source<int>>> sources;
+        for (size_t i = 0; i < 10; i++) {
+            sources.emplace_back(new oat::Source<int>());
+            sources.back()->touch(node_addr);
+            sources.back()->connect();
+        }
+
+        oat::Source<int> latest;
+
+        WHEN ("The LATEST source connects to the full node") {
+            THEN ("The connection shall succeed") {
+                REQUIRE_NOTHROW(
+                    latest.touch(node_addr, oat::SourceMode::LATEST);
+                    latest.connect();
+                );
+            }
+        }
+
+        WHEN ("The LATEST source calls retrieve()") {
+
+            latest.touch(node_addr, oat::SourceMode::LATEST);
+            latest.connect();
+
+            THEN ("The source shall throw because the object may be "
+                  "overwritten while in use") {
+                REQUIRE_THROWS( latest.retrieve(); );
+                REQUIRE_NOTHROW( latest.clone(); );
+            }
+        }
+    }
+}
+
+SCENARIO ("Source<SharedFrameHeader> can lease the shared frame instead of "
+           "copying it.", "[Source, SharedFrameHeader]") {
+
+    GIVEN ("A bound Sink<SharedFrameHeader> and a connected "
+           "Source<SharedFrameHeader> with common node address") {
+
+        const size_t rows {10}, cols {20};
+        const int type {0};
+
+        oat::Sink<oat::SharedFrameHeader> sink;
+        sink.bind(node_addr, rows * cols);
+        oat::Frame shared_frame = sink.retrieve(rows, cols, type);
+
+        oat::Source<oat::SharedFrameHeader> source;
+        source.touch(node_addr);
+        source.connect();
+
+        WHEN ("The source calls lease() before wait()") {
+            THEN ("The source shall throw") {
+                REQUIRE_THROWS( source.lease(); );
+            }
+        }
+
+        WHEN ("The sink publishes a frame and the source leases it") {
+
+            sink.wait();
+            shared_frame.data[0] = 42;
+            sink.post();
+
+            source.wait();
+            auto lease = source.lease();
+
+            THEN ("The leased frame shall refer to the sink's shared memory") {
+                REQUIRE( lease.held() );
+                REQUIRE( lease.frame().data[0] == 42 );
+
+                INFO ("The sink mutates the frame behind the source's back");
+                shared_frame.data[0] = 43;
+                REQUIRE( lease.frame().data[0] == 43 );
+            }
+
+            THEN ("The frame shall only be leased once per wait()") {
+                REQUIRE_THROWS( source.lease(); );
+            }
+
+            THEN ("Releasing the lease shall post() for the source") {
+                lease.release();
+                REQUIRE_FALSE( lease.held() );
+                REQUIRE_THROWS( source.post(); );
+                REQUIRE_NOTHROW( sink.wait(); );
+            }
+
+            THEN ("Moving the lease shall transfer the post()") {
+                auto moved = std::move(lease);
+                REQUIRE_FALSE( lease.held() );
+                REQUIRE( moved.held() );
+                moved.release();
+                REQUIRE_THROWS( source.post(); );
+            }
+        }
+    }
+}
+
+
+SCENARIO ("Source<SharedFrameHeader> views the region published by its sink "
+          "in place.", "[Source, SharedFrameHeader]") {
+
+    GIVEN ("A sink publishing a region of its frames and a connected source") {
+
+        const size_t rows {10}, cols {20};
+        const int type {CV_8UC3};
+        const cv::Rect roi(2, 3, 8, 4);
+
+        oat::Sink<oat::SharedFrameHeader> sink;
+        sink.bind(node_addr, rows * cols * 3);
+        oat::Frame shared_frame =
+            sink.retrieve(rows, cols, type, oat::PixelFormat::BGR, roi);
+
+        oat::Source<oat::SharedFrameHeader> source;
+        source.touch(node_addr);
+        source.connect();
+
+        WHEN ("The source connects") {
+            THEN ("Its parameters shall describe the region") {
+                REQUIRE( source.parameters().rows == static_cast<size_t>(roi.height) );
+                REQUIRE( source.parameters().cols == static_cast<size_t>(roi.width) );
+                REQUIRE( source.parameters().bytes == roi.area() * 3u );
+            }
+        }
+
+        WHEN ("The sink publishes a frame and the source leases it") {
+
+            sink.wait();
+            shared_frame.at<cv::Vec3b>(roi.y, roi.x)[0] = 42;
+            shared_frame.at<cv::Vec3b>(roi.y + roi.height - 1,
+                                       roi.x + roi.width - 1)[2] = 43;
+            sink.post();
+
+            source.wait();
+            auto lease = source.lease();
+            const oat::Frame &view = lease.frame();
+
+            THEN ("The leased frame shall be a region-sized view into the "
+                  "sink's full frame") {
+                REQUIRE( view.rows == roi.height );
+                REQUIRE( view.cols == roi.width );
+                REQUIRE( view.step[0] == cols * 3 );
+                REQUIRE_FALSE( view.isContinuous() );
+            }
+
+            THEN ("The view shall start at the region's first pixel") {
+                REQUIRE( view.at<cv::Vec3b>(0, 0)[0] == 42 );
+                REQUIRE( view.at<cv::Vec3b>(roi.height - 1,
+                                            roi.width - 1)[2] == 43 );
+            }
+        }
+    }
+}
 
 // TODO: specialization tests
@@ -22,7 +22,10 @@
 
 #include <chrono>
 #include <future>
+#include <memory>
 #include <thread>
+#include <vector>
+#include <unistd.h>
 
 #include "../../lib/shmemdf/Sink.h"
 #include "../../lib/shmemdf/Source.h"
@@ -522,3 +525,382 @@ SCENARIO ("Sources attaching or detaching during source or sink wait() periods "
         }
     }
 }
+
+SCENARIO ("A sink bound with a ring of N slots may run N writes ahead of "
+          "its slowest source", "[Sink, Source, Concurrency]") {
+
+    GIVEN ("A sink with a ring of 3 slots and two connected sources") {
+
+        oat::Sink<int> sink;
+        oat::Source<int> fast;
+        auto slow = new oat::Source<int>();
+
+        REQUIRE_NOTHROW(sink.set_ring_size(3));
+        REQUIRE_NOTHROW(sink.bind(node_addr));
+        fast.touch(node_addr);
+        fast.connect();
+        slow->touch(node_addr);
+        slow->connect();
+
+        WHEN ("The sink writes 3 samples without the sources reading") {
+
+            for (int i = 0; i < 3; i++) {
+                REQUIRE_NOTHROW(sink.wait());
+                *sink.retrieve() = i;
+                REQUIRE_NOTHROW(sink.post());
+            }
+
+            THEN ("The sink shall block on its 4th write until the slowest "
+                  "source reads the oldest sample") {
+
+                auto fut = std::async(std::launch::async, [&sink]{ sink.wait(); });
+
+                // The fast source reads all three samples in order
+                for (int i = 0; i < 3; i++) {
+                    REQUIRE_NOTHROW(fast.wait());
+                    REQUIRE(*fast.retrieve() == i);
+                    REQUIRE_NOTHROW(fast.post());
+                }
+
+                std::this_thread::sleep_for(msec(5));
+                auto status = fut.wait_for(msec(0));
+                REQUIRE(status != std::future_status::ready);
+
+                // The slow source finally reads the oldest sample
+                REQUIRE_NOTHROW(slow->wait());
+                REQUIRE(slow->clone() == 0);
+                REQUIRE_NOTHROW(slow->post());
+
+                std::this_thread::sleep_for(msec(1));
+                status = fut.wait_for(msec(0));
+                REQUIRE(status == std::future_status::ready);
+
+                // The new sample lands in the slot that was just freed,
+                // without disturbing unread samples
+                *sink.retrieve() = 3;
+                REQUIRE_NOTHROW(sink.post());
+
+                for (int i = 1; i < 4; i++) {
+                    REQUIRE_NOTHROW(slow->wait());
+                    REQUIRE(*slow->retrieve() == i);
+                    REQUIRE_NOTHROW(slow->post());
+                }
+
+                delete slow;
+            }
+        }
+
+        WHEN ("The slow source detaches while it owes reads") {
+
+            for (int i = 0; i < 3; i++) {
+                REQUIRE_NOTHROW(sink.wait());
+                REQUIRE_NOTHROW(sink.post());
+            }
+
+            for (int i = 0; i < 3; i++) {
+                REQUIRE_NOTHROW(fast.wait());
+                REQUIRE_NOTHROW(fast.post());
+            }
+
+            THEN ("The sink shall not block") {
+
+                auto fut = std::async(std::launch::async, [&sink]{ sink.wait(); });
+
+                // Slow source destructs
+                delete slow;
+
+                std::this_thread::sleep_for(msec(1));
+                auto status = fut.wait_for(msec(0));
+                REQUIRE(status == std::future_status::ready);
+                REQUIRE_NOTHROW(sink.post());
+            }
+        }
+    }
+}
+
+SCENARIO ("A source blocked in wait() shall be released as soon as its sink "
+          "leaves the node", "[Sink, Source, Concurrency]") {
+
+    GIVEN ("A sink and a connected source") {
+
+        auto sink = new oat::Sink<int>();
+        oat::Source<int> source;
+
+        REQUIRE_NOTHROW(sink->bind(node_addr));
+        source.touch(node_addr);
+        source.connect();
+
+        WHEN ("The source blocks in wait() and the sink is destructed") {
+
+            auto fut = std::async(std::launch::async,
+                                  [&source]{ return source.wait(); });
+
+            std::this_thread::sleep_for(msec(5));
+            REQUIRE(fut.wait_for(msec(0)) != std::future_status::ready);
+
+            delete sink;
+
+            THEN ("The source shall return END without waiting for the "
+                  "liveness period") {
+
+                REQUIRE(fut.wait_for(oat::LIVENESS_PERIOD / 5)
+                        == std::future_status::ready);
+                REQUIRE(fut.get() == oat::NodeState::END);
+            }
+        }
+    }
+}
+
+SCENARIO ("A source in LATEST mode shall never block its sink",
+          "[Sink, Source, Concurrency]") {
+
+    GIVEN ("A sink with a ring of 2 slots and a LATEST source") {
+
+        oat::Sink<int> sink;
+        oat::Source<int> source;
+
+        REQUIRE_NOTHROW(sink.set_ring_size(2));
+        REQUIRE_NOTHROW(sink.bind(node_addr));
+        source.touch(node_addr, oat::SourceMode::LATEST);
+        source.connect();
+
+        WHEN ("The sink writes many samples without the source reading") {
+
+            auto fut = std::async(std::launch::async, [&sink]{
+                for (int i = 0; i < 100; i++) {
+                    sink.wait();
+                    *sink.retrieve() = i;
+                    sink.post();
+                }
+            });
+
+            THEN ("The sink shall not block and the source shall read the "
+                  "newest sample") {
+
+                REQUIRE(fut.wait_for(msec(100)) == std::future_status::ready);
+
+                REQUIRE(source.wait() == oat::NodeState::SINK_BOUND);
+                REQUIRE(source.clone() == 99);
+                REQUIRE_NOTHROW(source.post());
+            }
+        }
+
+        WHEN ("The source waits before the sink writes") {
+
+            auto fut = std::async(std::launch::async, [&source]{
+                source.wait();
+                int val = source.clone();
+                source.post();
+                return val;
+            });
+
+            THEN ("The source shall block until the sink post()'s") {
+
+                std::this_thread::sleep_for(msec(5));
+                REQUIRE(fut.wait_for(msec(0)) != std::future_status::ready);
+
+                sink.wait();
+                *sink.retrieve() = 7;
+                sink.post();
+
+                REQUIRE(fut.wait_for(msec(100)) == std::future_status::ready);
+                REQUIRE(fut.get() == 7);
+            }
+        }
+
+        WHEN ("The source has read the newest sample") {
+
+            sink.wait();
+            *sink.retrieve() = 1;
+            sink.post();
+
+            source.wait();
+            source.clone();
+            source.post();
+
+            THEN ("The next wait() shall block until a newer sample is "
+                  "written") {
+
+                auto fut = std::async(std::launch::async, [&source]{
+                    source.wait();
+                    source.post();
+                });
+
+                std::this_thread::sleep_for(msec(5));
+                REQUIRE(fut.wait_for(msec(0)) != std::future_status::ready);
+
+                sink.wait();
+                sink.post();
+
+                REQUIRE(fut.wait_for(msec(100)) == std::future_status::ready);
+            }
+        }
+    }
+}
+
+SCENARIO ("Hundreds of sources may read from one sink in lockstep and "
+          "detach at any time", "[Sink, Source, Concurrency]") {
+
+    GIVEN ("A sink with a ring of 2 slots and 200 connected sources") {
+
+        const int num_sources = 200;
+        const int num_samples = 100;
+
+        oat::Sink<int> sink;
+        REQUIRE_NOTHROW(sink.set_ring_size(2));
+        REQUIRE_NOTHROW(sink.bind(node_addr));
+
+        std::vector<std::unique_ptr<oat::Source<int>>> sources;
+        for (int i = 0; i < num_sources; i++) {
+            sources.emplace_back(new oat::Source<int>());
+            sources.back()->touch(node_addr);
+            sources.back()->connect();
+        }
+
+        WHEN ("Each source reads in its own thread and odd sources detach "
+              "half way through") {
+
+            std::vector<std::future<bool>> readers;
+            for (int i = 0; i < num_sources; i++) {
+                readers.push_back(std::async(std::launch::async, [&, i] {
+                    bool in_order = true;
+                    int reads = (i % 2) ? num_samples / 2 : num_samples;
+                    for (int j = 0; j < reads; j++) {
+                        sources[i]->wait();
+                        in_order &= (sources[i]->clone() == j);
+                        sources[i]->post();
+                    }
+                    if (i % 2)
+                        sources[i].reset();
+                    return in_order;
+                }));
+            }
+
+            auto writer = std::async(std::launch::async, [&sink, num_samples] {
+                for (int j = 0; j < num_samples; j++) {
+                    sink.wait();
+                    *sink.retrieve() = j;
+                    sink.post();
+                }
+            });
+
+            THEN ("The sink shall complete every write and each source shall "
+                  "read every sample in order") {
+
+                REQUIRE(writer.wait_for(std::chrono::seconds(20))
+                        == std::future_status::ready);
+
+                for (auto &r : readers)
+                    REQUIRE(r.get());
+            }
+        }
+    }
+}
+
+SCENARIO ("A sink and sources in one process may exchange samples through "
+          "an in-process node", "[Sink, Source, Concurrency]") {
+
+    GIVEN ("A node address that uses the in-process transport, a sink with a "
+           "ring of 2 slots and a connected source") {
+
+        const std::string addr = "test_in_process";
+        oat::useInProcessTransport(addr);
+
+        oat::Sink<int> sink;
+        oat::Source<int> source;
+
+        REQUIRE_NOTHROW(sink.set_ring_size(2));
+        REQUIRE_NOTHROW(sink.bind(addr));
+        source.touch(addr);
+        source.connect();
+
+        THEN ("No shared memory shall be created") {
+
+            REQUIRE(access(("/dev/shm/" + addr + "_node").c_str(), F_OK) != 0);
+            REQUIRE(access(("/dev/shm/" + addr + "_obj").c_str(), F_OK) != 0);
+        }
+
+        THEN ("A second sink shall not be able to bind the node") {
+
+            oat::Sink<int> sink2;
+            REQUIRE_THROWS(sink2.bind(addr));
+        }
+
+        WHEN ("The sink writes 3 samples without the source reading") {
+
+            auto writer = std::async(std::launch::async, [&sink]{
+                for (int i = 0; i < 3; i++) {
+                    sink.wait();
+                    *sink.retrieve() = i;
+                    sink.post();
+                }
+            });
+
+            THEN ("The sink shall block on its 3rd write until the source "
+                  "reads, and the source shall read every sample in order") {
+
+                std::this_thread::sleep_for(msec(5));
+                REQUIRE(writer.wait_for(msec(0)) != std::future_status::ready);
+
+                for (int i = 0; i < 3; i++) {
+                    REQUIRE(source.wait() == oat::NodeState::SINK_BOUND);
+                    REQUIRE(source.clone() == i);
+                    source.post();
+                }
+
+                REQUIRE(writer.wait_for(msec(100)) == std::future_status::ready);
+            }
+        }
+    }
+}
+
+SCENARIO ("A node shall keep statistics of the writes, reads and blocking "
+          "of its sink and sources", "[Sink, Source, Concurrency]") {
+
+    GIVEN ("A sink with a ring of 1 slot and a connected source") {
+
+        oat::Sink<int> sink;
+        oat::Source<int> source;
+
+        REQUIRE_NOTHROW(sink.bind(node_addr));
+        source.touch(node_addr);
+        source.connect();
+
+        oat::shmem_t segment;
+        oat::Node *node = oat::openNode(segment, node_addr + "_node", 1);
+        REQUIRE(node->stats.sink_waits() == 0);
+
+        WHEN ("The sink writes twice and blocks until the source reads") {
+
+            sink.wait();
+            sink.post();
+
+            auto writer = std::async(std::launch::async, [&sink]{
+                sink.wait();
+                sink.post();
+            });
+
+            std::this_thread::sleep_for(msec(20));
+
+            for (int i = 0; i < 2; i++) {
+                source.wait();
+                source.post();
+            }
+
+            REQUIRE(writer.wait_for(msec(100)) == std::future_status::ready);
+
+            THEN ("The sink's blocked time and the source's reads shall be "
+                  "recorded") {
+
+                REQUIRE(node->stats.sink_waits() == 1);
+                REQUIRE(node->stats.sink_wait_ns() >= 10000000);
+                REQUIRE(node->stats.last_write_time() > 0);
+
+                uint64_t reads = 0;
+                for (auto &b : node->slot(0).read_latency.bins)
+                    reads += b;
+                REQUIRE(reads == 2);
+            }
+        }
+    }
+}